@@ -0,0 +1,180 @@
+#ifndef artdaq_core_Core_LogLinearHistogram_hh
+#define artdaq_core_Core_LogLinearHistogram_hh
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace artdaq {
+/**
+ * \brief A fixed-size, mergeable histogram with logarithmically-spaced, linearly-subdivided buckets
+ *
+ * Each power of two between 2^MIN_EXPONENT and 2^(MIN_EXPONENT + OCTAVES) is divided into
+ * SUB_BUCKETS equal-width buckets, so that any recorded value is known to within
+ * 1/SUB_BUCKETS of its magnitude (HdrHistogram-style). Values at or below the lower limit
+ * (including zero and negative values) are counted in the first bucket, and values above
+ * the upper limit in the last one.
+ *
+ * Storage is only allocated once the first count is added, so an unused histogram is cheap
+ * to copy.
+ */
+class LogLinearHistogram
+{
+public:
+	static constexpr int SUB_BUCKET_BITS = 4;                      ///< log2 of the number of buckets per power of two
+	static constexpr size_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;    ///< Number of buckets per power of two
+	static constexpr int MIN_EXPONENT = -32;                       ///< Values below 2^MIN_EXPONENT are counted in the first bucket
+	static constexpr size_t OCTAVES = 64;                          ///< Number of powers of two covered by the histogram
+	static constexpr size_t BUCKET_COUNT = OCTAVES * SUB_BUCKETS;  ///< Total number of buckets
+
+	/**
+	 * \brief Find the bucket a value would be counted in
+	 * \param value Value to look up
+	 * \return Index of the bucket containing value
+	 */
+	static size_t bucketIndex(double value)
+	{
+		if (!(value > 0.0)) return 0;  // Also catches NaN
+		uint64_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		auto exponent = static_cast<int64_t>((bits >> 52) & 0x7FF) - 1023 - MIN_EXPONENT;
+		if (exponent < 0) return 0;
+		if (exponent >= static_cast<int64_t>(OCTAVES)) return BUCKET_COUNT - 1;
+		return static_cast<size_t>(exponent) * SUB_BUCKETS + ((bits >> (52 - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1));
+	}
+
+	/**
+	 * \brief Smallest value counted in the given bucket (apart from the underflow values in bucket 0)
+	 * \param bucket Bucket index
+	 * \return The lower edge of the bucket
+	 */
+	static double bucketLowerBound(size_t bucket)
+	{
+		return std::ldexp(1.0 + static_cast<double>(bucket % SUB_BUCKETS) / SUB_BUCKETS, static_cast<int>(bucket / SUB_BUCKETS) + MIN_EXPONENT);
+	}
+
+	/**
+	 * \brief Largest value counted in the given bucket (apart from the overflow values in the last bucket)
+	 * \param bucket Bucket index
+	 * \return The upper edge of the bucket
+	 */
+	static double bucketUpperBound(size_t bucket)
+	{
+		return bucketLowerBound(bucket) + std::ldexp(1.0 / SUB_BUCKETS, static_cast<int>(bucket / SUB_BUCKETS) + MIN_EXPONENT);
+	}
+
+	/**
+	 * \brief Count a value
+	 * \param value Value to count
+	 * \param count Number of times to count it
+	 */
+	void record(double value, uint64_t count = 1) { add(bucketIndex(value), count); }
+
+	/**
+	 * \brief Add to the count of a bucket
+	 * \param bucket Bucket index
+	 * \param count Amount to add
+	 */
+	void add(size_t bucket, uint64_t count)
+	{
+		if (count == 0) return;
+		if (counts_.empty()) counts_.resize(BUCKET_COUNT, 0);
+		counts_[bucket] += count;
+		total_ += count;
+	}
+
+	/**
+	 * \brief Subtract from the count of a bucket
+	 * \param bucket Bucket index
+	 * \param count Amount to subtract. Must not be larger than the current count of the bucket.
+	 */
+	void subtract(size_t bucket, uint64_t count)
+	{
+		if (count == 0) return;
+		counts_[bucket] -= count;
+		total_ -= count;
+	}
+
+	/**
+	 * \brief Add all counts from another histogram to this one
+	 * \param other Histogram to add
+	 */
+	void merge(LogLinearHistogram const& other)
+	{
+		if (other.total_ == 0) return;
+		if (counts_.empty()) counts_.resize(BUCKET_COUNT, 0);
+		for (size_t ii = 0; ii < BUCKET_COUNT; ++ii)
+		{
+			counts_[ii] += other.counts_[ii];
+		}
+		total_ += other.total_;
+	}
+
+	/**
+	 * \brief Remove all counts from the histogram
+	 */
+	void clear()
+	{
+		std::fill(counts_.begin(), counts_.end(), 0);
+		total_ = 0;
+	}
+
+	/**
+	 * \brief Get the count in a bucket
+	 * \param bucket Bucket index
+	 * \return The count in the bucket
+	 */
+	uint64_t count(size_t bucket) const { return counts_.empty() ? 0 : counts_[bucket]; }
+
+	/**
+	 * \brief Get the total count of the histogram
+	 * \return The sum of the counts of all buckets
+	 */
+	uint64_t totalCount() const { return total_; }
+
+	/**
+	 * \brief Get the non-empty buckets of the histogram
+	 * \return Pairs of bucket index and count, in bucket order
+	 */
+	std::vector<std::pair<uint16_t, uint64_t>> nonEmptyBuckets() const
+	{
+		std::vector<std::pair<uint16_t, uint64_t>> output;
+		for (size_t ii = 0; ii < counts_.size(); ++ii)
+		{
+			if (counts_[ii] != 0) output.emplace_back(static_cast<uint16_t>(ii), counts_[ii]);
+		}
+		return output;
+	}
+
+	/**
+	 * \brief Estimate a quantile of the counted values
+	 * \param q Quantile to estimate, between 0 and 1 (e.g. 0.99 for the 99th percentile)
+	 * \return The midpoint of the bucket containing the requested quantile, or 0 if the histogram is empty
+	 */
+	double quantile(double q) const
+	{
+		if (total_ == 0) return 0.0;
+		auto rank = static_cast<uint64_t>(std::ceil(std::min(std::max(q, 0.0), 1.0) * static_cast<double>(total_)));
+		if (rank == 0) rank = 1;
+		uint64_t seen = 0;
+		for (size_t ii = 0; ii < BUCKET_COUNT; ++ii)
+		{
+			seen += counts_[ii];
+			if (seen >= rank)
+			{
+				return (bucketLowerBound(ii) + bucketUpperBound(ii)) / 2.0;
+			}
+		}
+		return bucketUpperBound(BUCKET_COUNT - 1);
+	}
+
+private:
+	std::vector<uint64_t> counts_;
+	uint64_t total_{0};
+};
+}  // namespace artdaq
+
+#endif /* artdaq_core_Core_LogLinearHistogram_hh */
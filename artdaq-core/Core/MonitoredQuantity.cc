@@ -2,14 +2,49 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 
 using namespace artdaq;
 
+namespace {
+// Lock-free read-modify-write helpers for std::atomic<double>. The accumulator slots are
+// normally only written by one thread, so the compare-exchange succeeds on the first try.
+void atomic_add(std::atomic<double>& target, double value)
+{
+	auto current = target.load(std::memory_order_relaxed);
+	while (!target.compare_exchange_weak(current, current + value, std::memory_order_relaxed)) {}
+}
+
+void atomic_min(std::atomic<double>& target, double value)
+{
+	auto current = target.load(std::memory_order_relaxed);
+	while (value < current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+}
+
+void atomic_max(std::atomic<double>& target, double value)
+{
+	auto current = target.load(std::memory_order_relaxed);
+	while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+}
+}  // namespace
+
+constexpr size_t MonitoredQuantity::SHARD_COUNT;
+constexpr size_t MonitoredQuantity::SCALAR_WORDS;
+
 MonitoredQuantity::MonitoredQuantity(
     DURATION_T expectedCalculationInterval,
-    DURATION_T timeWindowForRecentResults)
+    DURATION_T timeWindowForRecentResults,
+    bool trackQuantiles)
     : _expectedCalculationInterval(expectedCalculationInterval)
+    , _trackQuantiles(trackQuantiles)
 {
+	if (_trackQuantiles)
+	{
+		for (auto& shard : _shards)
+		{
+			shard.histogram.reset(new std::atomic<uint32_t>[LogLinearHistogram::BUCKET_COUNT]);
+		}
+	}
 	setNewTimeWindowForRecentResults(timeWindowForRecentResults);
 	enabled = true;
 }
@@ -17,17 +52,36 @@ MonitoredQuantity::MonitoredQuantity(
 void MonitoredQuantity::addSample(const double value)
 {
 	if (!enabled) { return; }
-	boost::mutex::scoped_lock sl(_accumulationMutex);
-	if (_lastCalculationTime <= 0.0)
+	if (_lastCalculationTime.load(std::memory_order_relaxed) <= 0.0)
 	{
-		_lastCalculationTime = getCurrentTime();
+		TIME_POINT_T unset = _lastCalculationTime;
+		if (unset <= 0.0) { _lastCalculationTime.compare_exchange_strong(unset, getCurrentTime()); }
 	}
-	++_workingSampleCount;
-	_workingValueSum += value;
-	_workingValueSumOfSquares += (value * value);
-	if (value < _workingValueMin) { _workingValueMin = value; }
-	if (value > _workingValueMax) { _workingValueMax = value; }
-	_workingLastSampleValue = value;
+	auto& shard = _shards[_shard_index()];
+	shard.sampleCount.fetch_add(1, std::memory_order_relaxed);
+	atomic_add(shard.valueSum, value);
+	atomic_add(shard.valueSumOfSquares, value * value);
+	atomic_min(shard.valueMin, value);
+	atomic_max(shard.valueMax, value);
+	if (shard.histogram) { shard.histogram[LogLinearHistogram::bucketIndex(value)].fetch_add(1, std::memory_order_relaxed); }
+	_workingLastSampleValue.store(value, std::memory_order_relaxed);
+}
+
+size_t MonitoredQuantity::_shard_index()
+{
+	static std::atomic<size_t> next_thread(0);
+	thread_local size_t index = next_thread.fetch_add(1, std::memory_order_relaxed) % SHARD_COUNT;
+	return index;
+}
+
+size_t MonitoredQuantity::_working_sample_count() const
+{
+	size_t count = 0;
+	for (auto const& shard : _shards)
+	{
+		count += shard.sampleCount.load(std::memory_order_relaxed);
+	}
+	return count;
 }
 
 void MonitoredQuantity::addSample(const int value)
@@ -53,31 +107,39 @@ bool MonitoredQuantity::calculateStatistics(TIME_POINT_T currentTime)
 	{
 		return false;
 	}
-	// create local copies of the working values to minimize the
-	// time that we could block a thread trying to add a sample.
-	// Also, reset the working values.
-	size_t latestSampleCount;
-	double latestValueSum;
-	double latestValueSumOfSquares;
-	double latestValueMin;
-	double latestValueMax;
+	// merge the accumulator slots into local copies of the working
+	// values, resetting each slot as it is read. Threads adding samples
+	// are never blocked; a sample added while its slot is being read
+	// may be split between this calculation and the next.
+	size_t latestSampleCount = 0;
+	double latestValueSum = 0.0;
+	double latestValueSumOfSquares = 0.0;
+	double latestValueMin = INFINITY;
+	double latestValueMax = -INFINITY;
+	LogLinearHistogram latestHistogram;
 	DURATION_T latestDuration;
 	double latestLastLatchedSampleValue;
 	{
 		boost::mutex::scoped_lock sl(_accumulationMutex);
-		latestSampleCount = _workingSampleCount;
-		latestValueSum = _workingValueSum;
-		latestValueSumOfSquares = _workingValueSumOfSquares;
-		latestValueMin = _workingValueMin;
-		latestValueMax = _workingValueMax;
+		for (auto& shard : _shards)
+		{
+			latestSampleCount += shard.sampleCount.exchange(0, std::memory_order_relaxed);
+			latestValueSum += shard.valueSum.exchange(0.0, std::memory_order_relaxed);
+			latestValueSumOfSquares += shard.valueSumOfSquares.exchange(0.0, std::memory_order_relaxed);
+			latestValueMin = std::min(latestValueMin, shard.valueMin.exchange(INFINITY, std::memory_order_relaxed));
+			latestValueMax = std::max(latestValueMax, shard.valueMax.exchange(-INFINITY, std::memory_order_relaxed));
+			if (!shard.histogram) { continue; }
+			for (size_t bucket = 0; bucket < LogLinearHistogram::BUCKET_COUNT; ++bucket)
+			{
+				if (shard.histogram[bucket].load(std::memory_order_relaxed) != 0)
+				{
+					latestHistogram.add(bucket, shard.histogram[bucket].exchange(0, std::memory_order_relaxed));
+				}
+			}
+		}
 		latestDuration = currentTime - _lastCalculationTime;
-		latestLastLatchedSampleValue = _workingLastSampleValue;
+		latestLastLatchedSampleValue = _workingLastSampleValue.load(std::memory_order_relaxed);
 		_lastCalculationTime = currentTime;
-		_workingSampleCount = 0;
-		_workingValueSum = 0.0;
-		_workingValueSumOfSquares = 0.0;
-		_workingValueMin = INFINITY;
-		_workingValueMax = -INFINITY;
 	}
 	// lock out any interaction with the results while we update them
 	{
@@ -91,6 +153,7 @@ bool MonitoredQuantity::calculateStatistics(TIME_POINT_T currentTime)
 		if (latestValueMin < fullValueMin) { fullValueMin = latestValueMin; }
 		if (latestValueMax > fullValueMax) { fullValueMax = latestValueMax; }
 		fullDuration += latestDuration;
+		fullValueHistogram.merge(latestHistogram);
 		// for the recent results, we need to replace the contents of
 		// the working bin and re-calculate the recent values
 		recentBinnedSampleCounts[_workingBinId] = latestSampleCount;
@@ -100,6 +163,15 @@ bool MonitoredQuantity::calculateStatistics(TIME_POINT_T currentTime)
 		_binValueMax[_workingBinId] = latestValueMax;
 		recentBinnedDurations[_workingBinId] = latestDuration;
 		recentBinnedEndTimes[_workingBinId] = _lastCalculationTime;
+		if (_trackQuantiles)
+		{
+			for (auto const& bucket : _binHistograms[_workingBinId])
+			{
+				recentValueHistogram.subtract(bucket.first, bucket.second);
+			}
+			_binHistograms[_workingBinId] = latestHistogram.nonEmptyBuckets();
+			recentValueHistogram.merge(latestHistogram);
+		}
 		if (latestDuration > 0.0)
 		{
 			lastValueRate = latestValueSum / latestDuration;
@@ -196,6 +268,7 @@ bool MonitoredQuantity::calculateStatistics(TIME_POINT_T currentTime)
 			recentValueAverage = 0.0;
 			recentValueRMS = 0.0;
 		}
+		_publish_results();
 	}
 	return true;
 }
@@ -203,11 +276,19 @@ bool MonitoredQuantity::calculateStatistics(TIME_POINT_T currentTime)
 void MonitoredQuantity::_reset_accumulators()
 {
 	_lastCalculationTime = 0;
-	_workingSampleCount = 0;
-	_workingValueSum = 0.0;
-	_workingValueSumOfSquares = 0.0;
-	_workingValueMin = INFINITY;
-	_workingValueMax = -INFINITY;
+	for (auto& shard : _shards)
+	{
+		shard.sampleCount = 0;
+		shard.valueSum = 0.0;
+		shard.valueSumOfSquares = 0.0;
+		shard.valueMin = INFINITY;
+		shard.valueMax = -INFINITY;
+		if (!shard.histogram) { continue; }
+		for (size_t bucket = 0; bucket < LogLinearHistogram::BUCKET_COUNT; ++bucket)
+		{
+			shard.histogram[bucket] = 0;
+		}
+	}
 	_workingLastSampleValue = 0;
 }
 
@@ -224,6 +305,9 @@ void MonitoredQuantity::_reset_results()
 		recentBinnedDurations[idx] = 0.0;
 		recentBinnedEndTimes[idx] = 0.0;
 	}
+	_binHistograms.assign(_binCount, {});
+	fullValueHistogram.clear();
+	recentValueHistogram.clear();
 	fullSampleCount = 0;
 	fullSampleRate = 0.0;
 	fullValueSum = 0.0;
@@ -257,6 +341,7 @@ void MonitoredQuantity::reset()
 	{
 		boost::mutex::scoped_lock sl(_resultsMutex);
 		_reset_results();
+		_publish_results();
 	}
 }
 
@@ -298,6 +383,7 @@ void MonitoredQuantity::setNewTimeWindowForRecentResults(DURATION_T interval)
 		recentBinnedDurations.reserve(_binCount);
 		recentBinnedEndTimes.reserve(_binCount);
 		_reset_results();
+		_publish_results();
 	}
 	{
 		boost::mutex::scoped_lock sl(_accumulationMutex);
@@ -312,25 +398,20 @@ bool MonitoredQuantity::
     waitUntilAccumulatorsHaveBeenFlushed(DURATION_T timeout) const
 {
 	timeout /= 10;
-	{
-		boost::mutex::scoped_lock sl(_accumulationMutex);
-		if (_workingSampleCount == 0) { return true; }
-	}
+	if (_working_sample_count() == 0) { return true; }
 	auto sleepTime = static_cast<int64_t>(timeout * 100000.0);
 	for (auto idx = 0; idx < 10; ++idx)
 	{
 		usleep(sleepTime);
-		{
-			boost::mutex::scoped_lock sl(_accumulationMutex);
-			if (_workingSampleCount == 0) { return true; }
-		}
+		if (_working_sample_count() == 0) { return true; }
 	}
 	return false;
 }
 
-void MonitoredQuantity::getStats(MonitoredQuantityStats& s) const
+void MonitoredQuantity::_publish_results()
 {
-	boost::mutex::scoped_lock results(_resultsMutex);
+	auto snapshot = std::make_shared<MonitoredQuantityStats>();
+	auto& s = *snapshot;
 	s.fullSampleCount = fullSampleCount;
 	s.fullSampleRate = fullSampleRate;
 	s.fullValueSum = fullValueSum;
@@ -351,6 +432,8 @@ void MonitoredQuantity::getStats(MonitoredQuantityStats& s) const
 	s.recentValueMax = recentValueMax;
 	s.recentValueRate = recentValueRate;
 	s.recentDuration = recentDuration;
+	s.fullValueHistogram = fullValueHistogram;
+	s.recentValueHistogram = recentValueHistogram;
 	s.recentBinnedSampleCounts.resize(_binCount);
 	s.recentBinnedValueSums.resize(_binCount);
 	s.recentBinnedDurations.resize(_binCount);
@@ -369,6 +452,55 @@ void MonitoredQuantity::getStats(MonitoredQuantityStats& s) const
 	s.lastValueRate = lastValueRate;
 	s.lastCalculationTime = lastCalculationTime;
 	s.enabled = enabled;
+
+	ScalarResults scalars{lastCalculationTime, fullDuration, recentValueSum, recentValueAverage, fullSampleCount};
+	std::array<uint64_t, SCALAR_WORDS> words;
+	memcpy(words.data(), &scalars, sizeof(scalars));
+	auto sequence = _scalarSequence.load(std::memory_order_relaxed);
+	_scalarSequence.store(sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	for (size_t ii = 0; ii < SCALAR_WORDS; ++ii)
+	{
+		_scalars[ii].store(words[ii], std::memory_order_relaxed);
+	}
+	_scalarSequence.store(sequence + 2, std::memory_order_release);
+
+	std::shared_ptr<MonitoredQuantityStats const> previous(std::move(snapshot));
+	{
+		std::lock_guard<std::mutex> lk(_snapshotMutex);
+		_snapshot.swap(previous);
+	}
+}
+
+MonitoredQuantity::ScalarResults MonitoredQuantity::_read_scalars() const
+{
+	std::array<uint64_t, SCALAR_WORDS> words;
+	while (true)
+	{
+		auto sequence = _scalarSequence.load(std::memory_order_acquire);
+		if ((sequence & 1) != 0) { continue; }
+		for (size_t ii = 0; ii < SCALAR_WORDS; ++ii)
+		{
+			words[ii] = _scalars[ii].load(std::memory_order_relaxed);
+		}
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (_scalarSequence.load(std::memory_order_relaxed) == sequence) { break; }
+	}
+	ScalarResults scalars;
+	memcpy(&scalars, words.data(), sizeof(scalars));
+	return scalars;
+}
+
+void MonitoredQuantity::getStats(MonitoredQuantityStats& s) const
+{
+	s = *getSnapshot();
+	s.enabled = enabled;
+}
+
+std::shared_ptr<MonitoredQuantityStats const> MonitoredQuantity::getSnapshot() const
+{
+	std::lock_guard<std::mutex> lk(_snapshotMutex);
+	return _snapshot;
 }
 
 MonitoredQuantity::TIME_POINT_T MonitoredQuantity::getCurrentTime()
@@ -385,30 +517,25 @@ MonitoredQuantity::TIME_POINT_T MonitoredQuantity::getCurrentTime()
 
 MonitoredQuantity::TIME_POINT_T MonitoredQuantity::getLastCalculationTime() const
 {
-	boost::mutex::scoped_lock results(_resultsMutex);
-	return lastCalculationTime;
+	return _read_scalars().lastCalculationTime;
 }
 
 MonitoredQuantity::DURATION_T MonitoredQuantity::getFullDuration() const
 {
-	boost::mutex::scoped_lock results(_resultsMutex);
-	return fullDuration;
+	return _read_scalars().fullDuration;
 }
 
 double MonitoredQuantity::getRecentValueSum() const
 {
-	boost::mutex::scoped_lock results(_resultsMutex);
-	return recentValueSum;
+	return _read_scalars().recentValueSum;
 }
 
 double MonitoredQuantity::getRecentValueAverage() const
 {
-	boost::mutex::scoped_lock results(_resultsMutex);
-	return recentValueAverage;
+	return _read_scalars().recentValueAverage;
 }
 
 size_t MonitoredQuantity::getFullSampleCount() const
 {
-	boost::mutex::scoped_lock results(_resultsMutex);
-	return fullSampleCount;
+	return _read_scalars().fullSampleCount;
 }
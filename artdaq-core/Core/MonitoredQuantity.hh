@@ -1,11 +1,16 @@
 #ifndef artdaq_core_Core_MonitoredQuantity_hh
 #define artdaq_core_Core_MonitoredQuantity_hh
 
+#include "artdaq-core/Core/LogLinearHistogram.hh"
+
 #include <boost/thread/mutex.hpp>
 
+#include <array>
 #include <atomic>
 #include <cmath>
 #include <cstdint>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 namespace artdaq {
@@ -53,6 +58,9 @@ struct MonitoredQuantityStats
 	std::vector<DURATION_T> recentBinnedDurations;   ///< Duration between each instance of calcualteStatistics in _intervalForRecentStats (rolling window)
 	std::vector<TIME_POINT_T> recentBinnedEndTimes;  ///< Last sample time in each instance of calculateStatistics in _intervalForRecentStats (rolling window)
 
+	LogLinearHistogram fullValueHistogram;    ///< Distribution of all samples (empty unless the MonitoredQuantity tracks quantiles)
+	LogLinearHistogram recentValueHistogram;  ///< Distribution of the "recent" samples (empty unless the MonitoredQuantity tracks quantiles)
+
 	double lastSampleValue;            ///< Value of the most recent sample
 	double lastValueRate;              ///< Latest rate point (sum of values over calculateStatistics interval)
 	TIME_POINT_T lastCalculationTime;  ///< Last time calculateStatistics was called
@@ -132,6 +140,19 @@ struct MonitoredQuantityStats
 		return v != 0.0 ? 1e6 / v : INFINITY;
 	}
 
+	/**
+	 * \brief Returns an estimate of a quantile of the values in the requested interval
+	 * \param q Quantile to return, between 0 and 1 (e.g. 0.99 for the 99th percentile)
+	 * \param t  Which interval to return, DataSetType::FULL (default) or DataSetType::RECENT
+	 * \return The requested quantile, accurate to 1/LogLinearHistogram::SUB_BUCKETS of its value, or 0 if quantiles are not tracked
+	 */
+	double getValueQuantile(double q, DataSetType t = DataSetType::FULL) const
+	{
+		auto const& histogram = t == DataSetType::RECENT ? recentValueHistogram : fullValueHistogram;
+		if (histogram.totalCount() == 0) { return 0.0; }
+		return std::min(std::max(histogram.quantile(q), getValueMin(t)), getValueMax(t));
+	}
+
 	/**
 	 * \brief Accessor for the last sample value recorded
 	 * \return The last sample value recorded
@@ -162,10 +183,12 @@ public:
 	 * \brief Instantiates a MonitoredQuantity object
 	 * \param expectedCalculationInterval How often calculateStatistics is expected to be called
 	 * \param timeWindowForRecentResults Defines the meaning of DataSetType::RECENT
+	 * \param trackQuantiles Whether to keep histograms of the sample values, so that quantiles can be reported
 	 */
 	explicit MonitoredQuantity(
 	    DURATION_T expectedCalculationInterval,
-	    DURATION_T timeWindowForRecentResults);
+	    DURATION_T timeWindowForRecentResults,
+	    bool trackQuantiles = false);
 
 	/**
 	 * \brief Adds the specified doubled valued sample value to the monitor instance.
@@ -226,6 +249,12 @@ public:
 	 */
 	bool isEnabled() const { return enabled; }
 
+	/**
+	 * \brief Tests whether the monitor keeps histograms of the sample values
+	 * \return Whether quantiles are available from getStats
+	 */
+	bool tracksQuantiles() const { return _trackQuantiles; }
+
 	/**
 	 * \brief Specifies a new time interval to be used when calculating "recent" statistics.
 	 * \param interval The new time interval for calculating "recent" statistics.
@@ -268,9 +297,21 @@ public:
 	/**
 	 * \brief Write all our collected statistics into the given Stats struct.
 	 * \param stats Destination for copy of collected statistics
+	 *
+	 * This copies the latest snapshot, and never waits for a calculation in progress.
 	 */
 	void getStats(MonitoredQuantityStats& stats) const;
 
+	/**
+	 * \brief Get the statistics published by the most recent calculation (or reset)
+	 * \return Shared pointer to an immutable copy of the collected statistics
+	 *
+	 * Each calculation publishes a new snapshot rather than modifying the previous one, so
+	 * readers never block on, or see a partial update from, calculateStatistics. The lock
+	 * guarding the snapshot pointer is only held to copy or replace it.
+	 */
+	std::shared_ptr<MonitoredQuantityStats const> getSnapshot() const;
+
 	/**
 	 * \brief Returns the current point in time.
 	 * \return The current point in time.
@@ -281,8 +322,9 @@ public:
 	 */
 	static TIME_POINT_T getCurrentTime();
 
-	// accessors for particular statistics values (more efficient when
-	// only a single value is needed)
+	// accessors for particular statistics values, read without locking from a
+	// seqlock-protected copy of the latest results (more efficient when only a
+	// single value is needed)
 	TIME_POINT_T getLastCalculationTime() const;  ///< Access the last calculation time
 	DURATION_T getFullDuration() const;           ///< Access the full duration of the statistics
 	double getRecentValueSum() const;             ///< Access the sum of the value samples in the "recent" time span
@@ -305,26 +347,72 @@ private:
 
 	void _reset_results();
 
+	// Publish a snapshot of the current results. Requires _resultsMutex.
+	void _publish_results();
+
+	/**
+	 * \brief The results read by the single-value accessors, published through a seqlock
+	 */
+	struct ScalarResults
+	{
+		TIME_POINT_T lastCalculationTime;  ///< MonitoredQuantityStats::lastCalculationTime
+		DURATION_T fullDuration;           ///< MonitoredQuantityStats::fullDuration
+		double recentValueSum;             ///< MonitoredQuantityStats::recentValueSum
+		double recentValueAverage;         ///< MonitoredQuantityStats::recentValueAverage
+		uint64_t fullSampleCount;          ///< MonitoredQuantityStats::fullSampleCount
+	};
+	static constexpr size_t SCALAR_WORDS = sizeof(ScalarResults) / sizeof(uint64_t);  ///< Size of ScalarResults in 64-bit words
+	static_assert(sizeof(ScalarResults) % sizeof(uint64_t) == 0, "ScalarResults must be a whole number of 64-bit words");
+
+	// Read the latest ScalarResults, retrying while a calculation is publishing new ones
+	ScalarResults _read_scalars() const;
+
+	/**
+	 * \brief One slot of the sample accumulator
+	 *
+	 * Each thread adds its samples to one of SHARD_COUNT slots, chosen when the thread first
+	 * calls addSample, so that concurrent writers do not share a cache line. The slots are
+	 * merged, and reset, by calculateStatistics.
+	 */
+	struct alignas(64) AccumulatorShard
+	{
+		std::atomic<size_t> sampleCount{0};                  ///< Number of samples added since the last calculation
+		std::atomic<double> valueSum{0.0};                   ///< Sum of the samples added since the last calculation
+		std::atomic<double> valueSumOfSquares{0.0};          ///< Sum of the squares of the samples added since the last calculation
+		std::atomic<double> valueMin{INFINITY};              ///< Smallest sample added since the last calculation
+		std::atomic<double> valueMax{-INFINITY};             ///< Largest sample added since the last calculation
+		std::unique_ptr<std::atomic<uint32_t>[]> histogram;  ///< Per-bucket counts of the samples added since the last calculation, if tracking quantiles
+	};
+	static constexpr size_t SHARD_COUNT = 16;  ///< Number of accumulator slots per MonitoredQuantity
+
+	// Index of the accumulator slot used by the calling thread
+	static size_t _shard_index();
+
+	size_t _working_sample_count() const;
+
 	std::atomic<TIME_POINT_T> _lastCalculationTime;
-	size_t _workingSampleCount;
-	double _workingValueSum;
-	double _workingValueSumOfSquares;
-	double _workingValueMin;
-	double _workingValueMax;
-	double _workingLastSampleValue;
+	std::array<AccumulatorShard, SHARD_COUNT> _shards;
+	std::atomic<double> _workingLastSampleValue;
 
-	mutable boost::mutex _accumulationMutex;
+	mutable boost::mutex _accumulationMutex;  // Serializes flushing and resetting the accumulator slots; not taken by addSample
 
 	unsigned int _binCount;
 	unsigned int _workingBinId;
 	std::vector<double> _binValueSumOfSquares;
 	std::vector<double> _binValueMin;
 	std::vector<double> _binValueMax;
+	std::vector<std::vector<std::pair<uint16_t, uint64_t>>> _binHistograms;  // Non-empty histogram buckets of each bin
+
+	mutable boost::mutex _resultsMutex;                       // Serializes writers of the results; readers use _snapshot or _scalars
+	mutable std::mutex _snapshotMutex;                        // Only held while _snapshot is copied or replaced
+	std::shared_ptr<MonitoredQuantityStats const> _snapshot;  // Latest published results
 
-	mutable boost::mutex _resultsMutex;
+	std::atomic<uint64_t> _scalarSequence{0};                       // Seqlock sequence number for _scalars; odd while they are being written
+	std::array<std::atomic<uint64_t>, SCALAR_WORDS> _scalars = {};  // Latest ScalarResults, copied word by word
 
 	DURATION_T _intervalForRecentStats;             // seconds
 	const DURATION_T _expectedCalculationInterval;  // seconds
+	const bool _trackQuantiles;
 };
 }  // namespace artdaq
 
@@ -1,5 +1,6 @@
 
 #include "artdaq-core/Core/SharedMemoryEventReceiver.hh"
+#include "artdaq-core/Core/TimingProbe.hh"
 
 #include <sys/time.h>
 #include "artdaq-core/Data/Fragment.hh"
@@ -140,6 +141,7 @@ std::set<artdaq::Fragment::type_t> artdaq::SharedMemoryEventReceiver::GetFragmen
 
 std::unique_ptr<artdaq::Fragments> artdaq::SharedMemoryEventReceiver::GetFragmentsByType(bool& err, Fragment::type_t type)
 {
+	ARTDAQ_TIMING_PROBE("SharedMemoryEventReceiver.GetFragmentsByType");
 	if ((current_data_source_ == nullptr) || (current_header_ == nullptr) || current_read_buffer_ == -1)
 	{
 		throw cet::exception("AccessViolation") << "Cannot call GetFragmentsByType when not currently reading a buffer! Call ReadHeader() first!";  // NOLINT(cert-err60-cpp)
@@ -194,9 +196,10 @@ std::string artdaq::SharedMemoryEventReceiver::printBuffers_(SharedMemoryManager
 		{
 			auto fragHdr = reinterpret_cast<artdaq::detail::RawFragmentHeader*>(data_ptr);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
 			ostr << "    Fragment " << fragHdr->fragment_id << ": Sequence ID: " << fragHdr->sequence_id << ", Type:" << fragHdr->type;
-			if (artdaq::detail::RawFragmentHeader::MakeVerboseSystemTypeMap().count(fragHdr->type) != 0u)
+			auto typeName = artdaq::detail::RawFragmentHeader::SystemTypeName(fragHdr->type);
+			if (typeName != nullptr)
 			{
-				ostr << " (" << artdaq::detail::RawFragmentHeader::MakeVerboseSystemTypeMap()[fragHdr->type] << ")";
+				ostr << " (" << typeName << ")";
 			}
 			ostr << ", Size: " << fragHdr->word_count << " words." << std::endl;
 			data_ptr = static_cast<uint8_t*>(data_ptr) + fragHdr->word_count * sizeof(RawDataType);
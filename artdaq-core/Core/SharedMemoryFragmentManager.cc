@@ -1,6 +1,7 @@
 
 #define TRACE_NAME "SharedMemoryFragmentManager"
 #include "artdaq-core/Core/SharedMemoryFragmentManager.hh"
+#include "artdaq-core/Core/TimingProbe.hh"
 #include "TRACE/tracemf.h"
 
 artdaq::SharedMemoryFragmentManager::SharedMemoryFragmentManager(uint32_t shm_key, size_t buffer_count, size_t max_buffer_size, size_t buffer_timeout_us)
@@ -23,6 +24,7 @@ bool artdaq::SharedMemoryFragmentManager::ReadyForWrite(bool overwrite)
 
 int artdaq::SharedMemoryFragmentManager::WriteFragment(Fragment&& fragment, bool overwrite, size_t timeout_us)
 {
+	ARTDAQ_TIMING_PROBE("SharedMemoryFragmentManager.WriteFragment");
 	if (!IsValid() || IsEndOfData())
 	{
 		TLOG(TLVL_WARNING) << "WriteFragment: Shared memory is not connected! Attempting reconnect...";
@@ -8,8 +8,12 @@
 #define SHM_DEST 01000
 #endif
 #include <csignal>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 #include "TRACE/tracemf.h"
 #include "artdaq-core/Core/SharedMemoryManager.hh"
+#include "artdaq-core/Core/TimingProbe.hh"
 #include "artdaq-core/Utilities/TraceLock.hh"
 #include "cetlib_except/exception.h"
 
@@ -297,6 +301,7 @@ bool artdaq::SharedMemoryManager::Attach(size_t timeout_usec)
 
 int artdaq::SharedMemoryManager::GetBufferForReading()
 {
+	ARTDAQ_TIMING_PROBE("SharedMemoryManager.GetBufferForReading");
 	TLOG(TLVL_GETBUFFER) << "GetBufferForReading BEGIN";
 
 	if (!registered_reader_)
@@ -1177,6 +1182,63 @@ size_t artdaq::SharedMemoryManager::Write(int buffer, void* data, size_t size)
 	return size;
 }
 
+size_t artdaq::SharedMemoryManager::WriteScatter(int buffer, std::vector<struct iovec> const& pieces)
+{
+	return Writev(buffer, pieces.data(), pieces.size());
+}
+
+size_t artdaq::SharedMemoryManager::Writev(int buffer, struct iovec const* iov, size_t count)
+{
+	TLOG(TLVL_WRITE) << "Writev BEGIN";
+	if (buffer >= shm_ptr_->buffer_count)
+	{
+		Detach(true, "ArgumentOutOfRange", "The specified buffer does not exist!");
+	}
+
+	size_t size = 0;
+	for (size_t ii = 0; ii < count; ++ii)
+	{
+		size += iov[ii].iov_len;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	}
+
+	std::lock_guard<std::mutex> lk(buffer_mutexes_[buffer]);
+	auto shmBuf = getBufferInfo_(buffer);
+	if (shmBuf == nullptr)
+	{
+		return -1;
+	}
+	checkBuffer_(shmBuf, BufferSemaphoreFlags::Writing);
+	touchBuffer_(shmBuf);
+	TLOG(TLVL_WRITE) << "Buffer Write Pos is " << std::dec << shmBuf->writePos << ", write size is " << size << " in " << count << " pieces";
+	if (shmBuf->writePos + size > shm_ptr_->buffer_size)
+	{
+		TLOG(TLVL_ERROR) << "Attempted to write more data than fits into Shared Memory, bufferSize=" << std::dec << shm_ptr_->buffer_size
+		                 << ",writePos=" << shmBuf->writePos << ",writeSize=" << size;
+		Detach(true, "SharedMemoryWrite", "Attempted to write more data than fits into Shared Memory! \nRe-run with a larger buffer size!");
+	}
+
+	auto pos = static_cast<uint8_t*>(GetWritePos(buffer));
+	bool streamed = false;
+	for (size_t ii = 0; ii < count; ++ii)
+	{
+		auto const& piece = iov[ii];  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		streamed |= copyToShm_(pos, piece.iov_base, piece.iov_len);
+		pos += piece.iov_len;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	}
+#if defined(__SSE2__)
+	// Non-temporal stores are weakly ordered; make them visible before the write position is updated
+	if (streamed) _mm_sfence();
+#endif
+	touchBuffer_(shmBuf);
+	shmBuf->writePos = shmBuf->writePos + size;
+
+	auto last_seen = last_seen_id_.load();
+	while (last_seen < shmBuf->sequence_id && !last_seen_id_.compare_exchange_weak(last_seen, shmBuf->sequence_id)) {}
+
+	TLOG(TLVL_WRITE) << "Writev END";
+	return size;
+}
+
 bool artdaq::SharedMemoryManager::Read(int buffer, void* data, size_t size)
 {
 	if (buffer >= shm_ptr_->buffer_count)
@@ -1213,6 +1275,82 @@ bool artdaq::SharedMemoryManager::Read(int buffer, void* data, size_t size)
 	return false;
 }
 
+bool artdaq::SharedMemoryManager::Readv(int buffer, struct iovec const* iov, size_t count)
+{
+	if (buffer >= shm_ptr_->buffer_count)
+	{
+		Detach(true, "ArgumentOutOfRange", "The specified buffer does not exist!");
+	}
+
+	size_t size = 0;
+	for (size_t ii = 0; ii < count; ++ii)
+	{
+		size += iov[ii].iov_len;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	}
+
+	std::lock_guard<std::mutex> lk(buffer_mutexes_[buffer]);
+	auto shmBuf = getBufferInfo_(buffer);
+	if (shmBuf == nullptr)
+	{
+		return false;
+	}
+	checkBuffer_(shmBuf, BufferSemaphoreFlags::Reading);
+	touchBuffer_(shmBuf);
+	if (shmBuf->readPos + size > shm_ptr_->buffer_size)
+	{
+		TLOG(TLVL_ERROR) << "Attempted to read more data than fits into Shared Memory, bufferSize=" << shm_ptr_->buffer_size
+		                 << ",readPos=" << shmBuf->readPos << ",readSize=" << size;
+		Detach(true, "SharedMemoryRead", "Attempted to read more data than exists in Shared Memory!");
+	}
+
+	auto pos = static_cast<uint8_t const*>(GetReadPos(buffer));
+	TLOG(TLVL_READ) << "Before memcpy in Readv(), size is " << size << " in " << count << " pieces";
+	for (size_t ii = 0; ii < count; ++ii)
+	{
+		auto const& piece = iov[ii];  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		memcpy(piece.iov_base, pos, piece.iov_len);
+		pos += piece.iov_len;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	}
+	TLOG(TLVL_READ) << "After memcpy in Readv()";
+	auto sts = checkBuffer_(shmBuf, BufferSemaphoreFlags::Reading, false);
+	if (sts)
+	{
+		shmBuf->readPos += size;
+		touchBuffer_(shmBuf);
+		return true;
+	}
+	return false;
+}
+
+bool artdaq::SharedMemoryManager::copyToShm_(void* dest, void const* src, size_t size)
+{
+#if defined(__SSE2__)
+	if (size >= NON_TEMPORAL_COPY_THRESHOLD)
+	{
+		// Align the destination, then stream whole 16-byte blocks past the cache: the data is
+		// consumed by another process, so caching it here would only evict the writer's working set
+		auto out = static_cast<uint8_t*>(dest);
+		auto in = static_cast<uint8_t const*>(src);
+		size_t head = (16 - (reinterpret_cast<uintptr_t>(out) & 15)) & 15;  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+		memcpy(out, in, head);
+		out += head;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		in += head;   // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		size -= head;
+
+		auto blocks = size / 16;
+		for (size_t ii = 0; ii < blocks; ++ii)
+		{
+			auto value = _mm_loadu_si128(reinterpret_cast<__m128i const*>(in) + ii);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+			_mm_stream_si128(reinterpret_cast<__m128i*>(out) + ii, value);            // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		}
+		memcpy(out + blocks * 16, in + blocks * 16, size - blocks * 16);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		return true;
+	}
+#endif
+	memcpy(dest, src, size);
+	return false;
+}
+
 std::string artdaq::SharedMemoryManager::toString()
 {
 	if (shm_ptr_ == nullptr)
@@ -11,6 +11,7 @@
 #include <vector>
 #include "artdaq-core/Utilities/TimeUtils.hh"
 #include "sys/sysinfo.h"
+#include "sys/uio.h"
 
 namespace artdaq {
 /**
@@ -31,6 +32,8 @@ public:
 		Reading   ///< The buffer is currently being read from
 	};
 
+	static constexpr size_t NON_TEMPORAL_COPY_THRESHOLD = 256 * 1024;  ///< Pieces of at least this many bytes are written to shared memory with non-temporal stores by Writev
+
 	/**
 	 * \brief Convert a BufferSemaphoreFlags variable to its string represenatation
 	 * \param flag BufferSemaphoreFlags variable to convert
@@ -265,6 +268,30 @@ public:
 	 */
 	size_t Write(int buffer, void* data, size_t size);
 
+	/**
+	 * \brief Write several pieces of data to a buffer, back-to-back, in a single operation
+	 * \param buffer Buffer ID of buffer
+	 * \param pieces Source pointers and sizes of the pieces to write, in order
+	 * \return Amount of data written, in bytes
+	 *
+	 * The total size is checked against the space remaining in the buffer before anything is copied,
+	 * and the buffer is locked and touched once for the whole write, rather than once per piece.
+	 */
+	size_t WriteScatter(int buffer, std::vector<struct iovec> const& pieces);
+
+	/**
+	 * \brief Write count pieces of data to a buffer, back-to-back, in a single operation
+	 * \param buffer Buffer ID of buffer
+	 * \param iov Source pointers and sizes of the pieces to write, in order
+	 * \param count Number of pieces
+	 * \return Amount of data written, in bytes
+	 *
+	 * The buffer is locked, checked and touched, and the write position and last-seen sequence ID
+	 * updated, once per call. Pieces of at least NON_TEMPORAL_COPY_THRESHOLD bytes are copied with
+	 * non-temporal stores where the platform supports them.
+	 */
+	size_t Writev(int buffer, struct iovec const* iov, size_t count);
+
 	/**
 	 * \brief Read size bytes of data from buffer into the given pointer
 	 * \param buffer Buffer ID of buffer
@@ -274,6 +301,15 @@ public:
 	 */
 	bool Read(int buffer, void* data, size_t size);
 
+	/**
+	 * \brief Read data from a buffer into count destinations, in order, in a single operation
+	 * \param buffer Buffer ID of buffer
+	 * \param iov Destination pointers and sizes of the pieces to read, in order
+	 * \param count Number of pieces
+	 * \return Whether the read was successful
+	 */
+	bool Readv(int buffer, struct iovec const* iov, size_t count);
+
 	/**
 	 *\brief Write information about the SharedMemory to a string
 	 *\return String describing current state of SharedMemory and buffers
@@ -451,6 +487,8 @@ private:
 	}
 	bool checkBuffer_(ShmBuffer* buffer, BufferSemaphoreFlags flags, bool exceptions = true);
 	void touchBuffer_(ShmBuffer* buffer);
+	// Copy into shared memory; returns whether non-temporal stores were used, in which case the caller must fence
+	static bool copyToShm_(void* dest, void const* src, size_t size);
 
 	ShmStruct requested_shm_parameters_;
 
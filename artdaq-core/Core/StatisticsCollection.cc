@@ -1,10 +1,16 @@
 #include "artdaq-core/Core/StatisticsCollection.hh"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <limits>
 #include <utility>
 
 #include "TRACE/tracemf.h"
 
 namespace artdaq {
+constexpr double StatisticsCollection::WHEEL_TICK_SECONDS;
+constexpr size_t StatisticsCollection::WHEEL_SLOTS;
+
 StatisticsCollection& StatisticsCollection::getInstance()
 {
 	static StatisticsCollection singletonInstance;
@@ -12,6 +18,8 @@ StatisticsCollection& StatisticsCollection::getInstance()
 }
 
 StatisticsCollection::StatisticsCollection()
+    : wheel_(WHEEL_SLOTS)
+    , start_time_(std::chrono::steady_clock::now())
 {
 	thread_stop_requested_ = false;
 	try
@@ -34,7 +42,7 @@ StatisticsCollection::StatisticsCollection()
 StatisticsCollection::~StatisticsCollection() noexcept
 {
 	// stop and clean up the thread
-	thread_stop_requested_ = true;
+	requestStop();
 
 	try
 	{
@@ -54,8 +62,19 @@ void StatisticsCollection::
     addMonitoredQuantity(const std::string& name,
                          MonitoredQuantityPtr mqPtr)
 {
-	std::lock_guard<std::mutex> scopedLock(map_mutex_);
-	monitoredQuantityMap_[name] = std::move(mqPtr);
+	if (mqPtr == nullptr) { return; }
+	{
+		std::lock_guard<std::mutex> scopedLock(map_mutex_);
+		auto& registered = monitoredQuantityMap_[name];
+		if (registered == mqPtr) { return; }  // Already scheduled
+		registered = mqPtr;
+
+		// Any entry of a quantity previously registered under this name (even the same one, if it was
+		// replaced in between) now belongs to an old registration, and is dropped when it comes due
+		std::lock_guard<std::mutex> scheduleLock(schedule_mutex_);
+		schedule_(ScheduledQuantity{name, std::move(mqPtr), ++registrations_[name], 0});
+	}
+	schedule_cv_.notify_all();
 }
 
 MonitoredQuantityPtr
@@ -69,39 +88,133 @@ StatisticsCollection::getMonitoredQuantity(const std::string& name) const
 	return iter->second;
 }
 
+std::map<std::string, MonitoredQuantityStatsPtr> StatisticsCollection::snapshotAll() const
+{
+	std::vector<std::pair<std::string, MonitoredQuantityPtr>> quantities;
+	{
+		std::lock_guard<std::mutex> scopedLock(map_mutex_);
+		quantities.assign(monitoredQuantityMap_.begin(), monitoredQuantityMap_.end());
+	}
+	std::map<std::string, MonitoredQuantityStatsPtr> snapshots;
+	for (auto const& quantity : quantities)
+	{
+		snapshots.emplace_hint(snapshots.end(), quantity.first, quantity.second->getSnapshot());
+	}
+	return snapshots;
+}
+
 void StatisticsCollection::reset()
 {
-	std::lock_guard<std::mutex> scopedLock(map_mutex_);
-	std::map<std::string, MonitoredQuantityPtr>::const_iterator iter;
-	std::map<std::string, MonitoredQuantityPtr>::const_iterator iterEnd;
-	iterEnd = monitoredQuantityMap_.end();
-	for (iter = monitoredQuantityMap_.begin(); iter != iterEnd; ++iter)
+	std::vector<MonitoredQuantityPtr> quantities;
+	{
+		std::lock_guard<std::mutex> scopedLock(map_mutex_);
+		quantities.reserve(monitoredQuantityMap_.size());
+		for (auto const& entry : monitoredQuantityMap_)
+		{
+			quantities.push_back(entry.second);
+		}
+	}
+	for (auto const& quantity : quantities)
 	{
-		iter->second->reset();
+		quantity->reset();
 	}
 }
 
 void StatisticsCollection::requestStop()
 {
-	thread_stop_requested_ = true;
+	{
+		std::lock_guard<std::mutex> scheduleLock(schedule_mutex_);
+		thread_stop_requested_ = true;
+	}
+	schedule_cv_.notify_all();
+}
+
+void StatisticsCollection::schedule_(ScheduledQuantity&& entry)
+{
+	// Round up, so that a quantity is never calculated before its interval has elapsed
+	auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time_).count();
+	auto now_tick = static_cast<uint64_t>(std::ceil(elapsed / WHEEL_TICK_SECONDS));
+	auto interval_ticks = static_cast<uint64_t>(std::ceil(entry.quantity->ExpectedCalculationInterval() / WHEEL_TICK_SECONDS));
+	entry.due_tick = std::max(current_tick_ + 1, now_tick + std::max(interval_ticks, uint64_t{1}));
+	wheel_[entry.due_tick % WHEEL_SLOTS].push_back(std::move(entry));
+	++scheduled_count_;
+}
+
+bool StatisticsCollection::is_current_(ScheduledQuantity const& entry) const
+{
+	auto it = registrations_.find(entry.name);
+	return it != registrations_.end() && it->second == entry.registration;
+}
+
+uint64_t StatisticsCollection::next_due_tick_() const
+{
+	if (scheduled_count_ == 0) { return 0; }
+	for (auto tick = current_tick_ + 1; tick <= current_tick_ + WHEEL_SLOTS; ++tick)
+	{
+		for (auto const& entry : wheel_[tick % WHEEL_SLOTS])
+		{
+			if (entry.due_tick == tick) { return tick; }
+		}
+	}
+
+	// Everything is due more than one revolution of the wheel ahead
+	auto next = std::numeric_limits<uint64_t>::max();
+	for (auto const& slot : wheel_)
+	{
+		for (auto const& entry : slot)
+		{
+			next = std::min(next, entry.due_tick);
+		}
+	}
+	return next;
 }
 
 void StatisticsCollection::run()
 {
+	auto tick = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(WHEEL_TICK_SECONDS));
+	std::vector<ScheduledQuantity> due;
+	std::unique_lock<std::mutex> scheduleLock(schedule_mutex_);
 	while (!thread_stop_requested_)
 	{
-		auto useconds = static_cast<uint64_t>(calculationInterval_ * 1000000);
-		usleep(useconds);
+		auto due_tick = next_due_tick_();
+		if (due_tick == 0)
+		{
+			schedule_cv_.wait(scheduleLock, [this] { return thread_stop_requested_.load() || scheduled_count_ != 0; });
+			continue;
+		}
+
+		// Wake early if a newly-registered quantity is due sooner. If calculations overran, this does not wait,
+		// and the missed ticks are processed in turn.
+		if (schedule_cv_.wait_until(scheduleLock, start_time_ + tick * due_tick, [this, due_tick] { return thread_stop_requested_.load() || next_due_tick_() < due_tick; }))
+		{
+			continue;
+		}
+		current_tick_ = due_tick;
+
+		auto& slot = wheel_[current_tick_ % WHEEL_SLOTS];
+		auto later = std::partition(slot.begin(), slot.end(), [this](ScheduledQuantity const& entry) { return entry.due_tick <= current_tick_; });
+		due.assign(std::make_move_iterator(slot.begin()), std::make_move_iterator(later));
+		slot.erase(slot.begin(), later);
+		scheduled_count_ -= due.size();
+
+		// Drop quantities which have been replaced since they were scheduled
+		due.erase(std::remove_if(due.begin(), due.end(), [this](ScheduledQuantity const& entry) { return !is_current_(entry); }), due.end());
+		if (due.empty()) { continue; }
+
+		// Calculate without holding the lock, so that slow quantities do not block registration or stopping
+		scheduleLock.unlock();
+		auto now = MonitoredQuantity::getCurrentTime();
+		for (auto const& entry : due)
+		{
+			entry.quantity->calculateStatistics(now);
+		}
+
+		scheduleLock.lock();
+		for (auto& entry : due)
 		{
-			std::lock_guard<std::mutex> scopedLock(map_mutex_);
-			std::map<std::string, MonitoredQuantityPtr>::const_iterator iter;
-			std::map<std::string, MonitoredQuantityPtr>::const_iterator iterEnd;
-			iterEnd = monitoredQuantityMap_.end();
-			for (iter = monitoredQuantityMap_.begin(); iter != iterEnd; ++iter)
-			{
-				iter->second->calculateStatistics();
-			}
+			if (is_current_(entry)) { schedule_(std::move(entry)); }
 		}
+		due.clear();
 	}
 }
 }  // namespace artdaq
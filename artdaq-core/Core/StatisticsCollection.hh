@@ -2,9 +2,13 @@
 #define artdaq_core_Core_StatisticsCollection_hh
 
 #include <boost/thread.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <vector>
 #include "artdaq-core/Core/MonitoredQuantity.hh"
 
 namespace artdaq {
@@ -13,11 +17,18 @@ namespace artdaq {
  */
 typedef std::shared_ptr<MonitoredQuantity> MonitoredQuantityPtr;
 
+/**
+ * \brief A shared_ptr to an immutable snapshot of the statistics of a MonitoredQuantity
+ */
+typedef std::shared_ptr<MonitoredQuantityStats const> MonitoredQuantityStatsPtr;
+
 /**
  * \brief A collection of MonitoredQuantity instances describing low-level statistics of the _artdaq_ system
  *
  * A collection of MonitoredQuantity instances describing low-level statistics of the _artdaq_ system.
- * Periodically (default 1s) calculates statistics for each MonitoredQuantity instance.
+ * Calculates statistics for each MonitoredQuantity instance at that instance's ExpectedCalculationInterval,
+ * using a timer wheel with a resolution of WHEEL_TICK_SECONDS. The calculation thread sleeps until the
+ * next tick at which a quantity is due, and is woken early by registration and by requestStop.
  */
 class StatisticsCollection
 {
@@ -37,6 +48,8 @@ public:
 	 * \brief Registers a new MonitoredQuantity to be tracked by the StatisticsCollection
 	 * \param name Name of the MonitoredQuantity (used for lookup)
 	 * \param mqPtr shared_ptr to MonitoredQuantity
+	 *
+	 * Registering a different MonitoredQuantity under an existing name replaces (and unschedules) the previous one.
 	 */
 	void addMonitoredQuantity(const std::string& name,
 	                          MonitoredQuantityPtr mqPtr);
@@ -48,13 +61,22 @@ public:
 	 */
 	MonitoredQuantityPtr getMonitoredQuantity(const std::string& name) const;
 
+	/**
+	 * \brief Get the latest statistics of every MonitoredQuantity in the StatisticsCollection
+	 * \return Map from MonitoredQuantity name to the snapshot published by its most recent calculation
+	 *
+	 * The lookup map is only locked while the list of quantities is copied; the snapshots are
+	 * then collected without blocking on any calculation in progress.
+	 */
+	std::map<std::string, MonitoredQuantityStatsPtr> snapshotAll() const;
+
 	/**
 	 * \brief Reset all MonitoredQuantity object in this StatisticsCollection
 	 */
 	void reset();
 
 	/**
-	 * \brief Stops the statistics calculation thread
+	 * \brief Stops the statistics calculation thread, without waiting for the current timer tick to expire
 	 */
 	void requestStop();
 
@@ -83,9 +105,56 @@ private:
 	StatisticsCollection& operator=(StatisticsCollection&&) = delete;
 
 	/**
-	 * \brief Interval for calculation of statistics. Defaulted to 1 second
+	 * \brief A MonitoredQuantity waiting in the timer wheel for its next calculation
+	 */
+	struct ScheduledQuantity
+	{
+		std::string name;               ///< Name under which the MonitoredQuantity was registered
+		MonitoredQuantityPtr quantity;  ///< The MonitoredQuantity
+		uint64_t registration;          ///< Registration of the name this entry belongs to; stale entries are dropped
+		uint64_t due_tick;              ///< Timer tick at which statistics should next be calculated
+	};
+
+	static constexpr double WHEEL_TICK_SECONDS = 0.01;  ///< Resolution of the timer wheel
+	static constexpr size_t WHEEL_SLOTS = 256;          ///< Number of slots in the timer wheel (quantities due further ahead wait for later revolutions)
+
+	// Add a MonitoredQuantity to the timer wheel, due one ExpectedCalculationInterval from now. Requires schedule_mutex_.
+	void schedule_(ScheduledQuantity&& entry);
+
+	// Whether an entry belongs to the current registration of its name. Requires schedule_mutex_.
+	bool is_current_(ScheduledQuantity const& entry) const;
+
+	// First timer tick after current_tick_ at which a quantity is due, or 0 if none are scheduled. Requires schedule_mutex_.
+	uint64_t next_due_tick_() const;
+
+	/**
+	 * \brief Timer wheel of MonitoredQuantity instances, indexed by due tick modulo WHEEL_SLOTS
+	 */
+	std::vector<std::vector<ScheduledQuantity>> wheel_;
+	/**
+	 * \brief Current registration number of each name; entries from earlier registrations are not rescheduled
+	 */
+	std::map<std::string, uint64_t> registrations_;
+	/**
+	 * \brief Number of entries in the timer wheel
+	 */
+	size_t scheduled_count_{0};
+	/**
+	 * \brief Last timer tick processed by the calculation thread
+	 */
+	uint64_t current_tick_{0};
+	/**
+	 * \brief Time of timer tick 0
+	 */
+	std::chrono::steady_clock::time_point start_time_;
+	/**
+	 * \brief Mutex for protecting accesses to the timer wheel
+	 */
+	std::mutex schedule_mutex_;
+	/**
+	 * \brief Wakes the calculation thread when a stop is requested or a MonitoredQuantity is registered
 	 */
-	double calculationInterval_{1.0};
+	std::condition_variable schedule_cv_;
 	/**
 	 * \brief Lookup map for MonitoredQuantityPtr objects, keyed by name
 	 */
@@ -94,7 +163,7 @@ private:
 	/**
 	 * \brief Thread control varaible
 	 */
-	bool thread_stop_requested_;
+	std::atomic<bool> thread_stop_requested_;
 	/**
 	 * \brief Thread which performs calculation of MonitoredQuantity statistics
 	 */
@@ -0,0 +1,362 @@
+#define TRACE_NAME "StatisticsExporter"
+#include "artdaq-core/Core/StatisticsExporter.hh"
+
+#include <poll.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <utility>
+
+#include "TRACE/tracemf.h"
+#include "artdaq-core/Utilities/TimeUtils.hh"
+#include "cetlib_except/exception.h"
+
+namespace artdaq {
+constexpr uint32_t StatisticsTable::MAGIC;
+constexpr uint32_t StatisticsTable::VERSION;
+constexpr size_t StatisticsTable::NAME_LENGTH;
+
+namespace {
+// Escape a Prometheus label value
+std::string escape_label(std::string const& value)
+{
+	std::string output;
+	output.reserve(value.size());
+	for (auto c : value)
+	{
+		switch (c)
+		{
+			case '\\':
+				output += "\\\\";
+				break;
+			case '"':
+				output += "\\\"";
+				break;
+			case '\n':
+				output += "\\n";
+				break;
+			default:
+				output += c;
+		}
+	}
+	return output;
+}
+
+double recent_quantile(MonitoredQuantityStats const& stats, double q)
+{
+	return stats.getValueQuantile(q, MonitoredQuantityStats::DataSetType::RECENT);
+}
+}  // namespace
+
+StatisticsExporter::StatisticsExporter(double interval, uint32_t shm_key, size_t shm_capacity, std::string prometheus_file, std::string socket_path)
+    : interval_(interval)
+    , prometheus_file_(std::move(prometheus_file))
+    , socket_path_(std::move(socket_path))
+{
+	if (shm_key != 0)
+	{
+		// Never take over a segment which is in use, or which is not a StatisticsTable
+		auto size = sizeof(StatisticsTable::Header) + shm_capacity * sizeof(StatisticsTable::Entry);
+		shm_segment_id_ = shmget(shm_key, size, IPC_CREAT | IPC_EXCL | 0666);
+		if (shm_segment_id_ == -1 && errno == EEXIST && removeStaleTable_(shm_key))
+		{
+			shm_segment_id_ = shmget(shm_key, size, IPC_CREAT | IPC_EXCL | 0666);
+		}
+		if (shm_segment_id_ == -1)
+		{
+			throw cet::exception("StatisticsExporter") << "Failed to create shared memory segment with key 0x" << std::hex << shm_key << std::dec << ": " << strerror(errno);  // NOLINT(cert-err60-cpp)
+		}
+		auto ptr = shmat(shm_segment_id_, nullptr, 0);
+		if (ptr == reinterpret_cast<void*>(-1))  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast,performance-no-int-to-ptr)
+		{
+			shmctl(shm_segment_id_, IPC_RMID, nullptr);
+			throw cet::exception("StatisticsExporter") << "Failed to attach to shared memory segment " << shm_segment_id_ << ": " << strerror(errno);  // NOLINT(cert-err60-cpp)
+		}
+		memset(ptr, 0, size);
+		table_ = static_cast<StatisticsTable::Header*>(ptr);
+		table_capacity_ = shm_capacity;
+		table_->version = StatisticsTable::VERSION;
+		table_->entry_capacity = shm_capacity;
+		table_->magic = StatisticsTable::MAGIC;
+		TLOG(TLVL_DEBUG) << "Created StatisticsTable with key 0x" << std::hex << shm_key << std::dec << " for " << shm_capacity << " quantities";
+	}
+
+	if (!socket_path_.empty())
+	{
+		sockaddr_un addr{};
+		if (socket_path_.size() >= sizeof(addr.sun_path))
+		{
+			throw cet::exception("StatisticsExporter") << "Socket path " << socket_path_ << " is too long";  // NOLINT(cert-err60-cpp)
+		}
+		addr.sun_family = AF_UNIX;
+		strncpy(&addr.sun_path[0], socket_path_.c_str(), sizeof(addr.sun_path) - 1);
+		unlink(socket_path_.c_str());
+		listen_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		if (listen_fd_ == -1 || bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1 || listen(listen_fd_, 8) == -1)  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+		{
+			auto err = errno;
+			if (listen_fd_ != -1) close(listen_fd_);
+			listen_fd_ = -1;
+			throw cet::exception("StatisticsExporter") << "Failed to listen on socket " << socket_path_ << ": " << strerror(err);  // NOLINT(cert-err60-cpp)
+		}
+	}
+
+	export_thread_ = std::make_unique<boost::thread>([this] { run_(); });
+	char tname[16];                                          // Size 16 - see man page pthread_setname_np(3) and/or prctl(2)
+	snprintf(tname, sizeof(tname) - 1, "%s", "StatExport");  // NOLINT
+	tname[sizeof(tname) - 1] = '\0';                         // assure term. snprintf is not too evil :)
+	pthread_setname_np(export_thread_->native_handle(), tname);
+}
+
+StatisticsExporter::~StatisticsExporter() noexcept
+{
+	{
+		std::lock_guard<std::mutex> lk(stop_mutex_);
+		stop_requested_ = true;
+	}
+	stop_cv_.notify_all();
+	try
+	{
+		if (export_thread_ && export_thread_->joinable()) export_thread_->join();
+	}
+	catch (...)
+	{
+		// IGNORED
+	}
+
+	if (listen_fd_ != -1)
+	{
+		close(listen_fd_);
+		unlink(socket_path_.c_str());
+	}
+	if (table_ != nullptr)
+	{
+		shmdt(table_);
+		shmctl(shm_segment_id_, IPC_RMID, nullptr);
+	}
+}
+
+bool StatisticsExporter::removeStaleTable_(uint32_t shm_key)
+{
+	auto id = shmget(shm_key, 0, 0);
+	shmid_ds info{};
+	if (id == -1 || shmctl(id, IPC_STAT, &info) == -1) return false;
+	if (info.shm_nattch != 0 || info.shm_segsz < sizeof(StatisticsTable::Header))
+	{
+		TLOG(TLVL_WARNING) << "Shared memory segment with key 0x" << std::hex << shm_key << std::dec << " exists and is in use (" << info.shm_nattch << " attached), not replacing it";
+		return false;
+	}
+
+	auto ptr = shmat(id, nullptr, SHM_RDONLY);
+	if (ptr == reinterpret_cast<void*>(-1)) return false;  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast,performance-no-int-to-ptr)
+	auto magic = static_cast<StatisticsTable::Header const*>(ptr)->magic.load();
+	shmdt(ptr);
+	if (magic != StatisticsTable::MAGIC)
+	{
+		TLOG(TLVL_WARNING) << "Shared memory segment with key 0x" << std::hex << shm_key << " exists and is not a StatisticsTable (magic 0x" << magic << std::dec << "), not replacing it";
+		return false;
+	}
+
+	TLOG(TLVL_INFO) << "Removing StatisticsTable with key 0x" << std::hex << shm_key << std::dec << " left behind by process " << info.shm_cpid;
+	return shmctl(id, IPC_RMID, nullptr) == 0;
+}
+
+void StatisticsExporter::exportNow()
+{
+	std::lock_guard<std::mutex> exportLock(export_mutex_);
+	auto snapshots = StatisticsCollection::getInstance().snapshotAll();
+	if (table_ != nullptr) writeTable_(snapshots);
+	if (prometheus_file_.empty() && listen_fd_ == -1) return;
+
+	auto text = RenderPrometheus(snapshots);
+	if (!prometheus_file_.empty()) writeFile_(text);
+	std::lock_guard<std::mutex> lk(text_mutex_);
+	latest_text_ = std::move(text);
+}
+
+std::string StatisticsExporter::RenderPrometheus(std::map<std::string, MonitoredQuantityStatsPtr> const& snapshots)
+{
+	struct Family
+	{
+		char const* name;
+		char const* type;
+		char const* help;
+		double (*value)(MonitoredQuantityStats const&);
+	};
+	static const Family families[] = {
+	    {"sample_count", "counter", "Number of samples since the last reset", [](MonitoredQuantityStats const& s) { return static_cast<double>(s.fullSampleCount); }},
+	    {"value_sum", "counter", "Sum of all samples since the last reset", [](MonitoredQuantityStats const& s) { return s.fullValueSum; }},
+	    {"value_average", "gauge", "Average of the recent samples", [](MonitoredQuantityStats const& s) { return s.recentValueAverage; }},
+	    {"value_rms", "gauge", "RMS of the recent samples", [](MonitoredQuantityStats const& s) { return s.recentValueRMS; }},
+	    {"value_min", "gauge", "Smallest of the recent samples", [](MonitoredQuantityStats const& s) { return s.recentSampleCount > 0 ? s.recentValueMin : 0.0; }},
+	    {"value_max", "gauge", "Largest of the recent samples", [](MonitoredQuantityStats const& s) { return s.recentSampleCount > 0 ? s.recentValueMax : 0.0; }},
+	    {"sample_rate", "gauge", "Recent samples per second", [](MonitoredQuantityStats const& s) { return s.recentSampleRate; }},
+	    {"value_rate", "gauge", "Sum of the recent samples per second", [](MonitoredQuantityStats const& s) { return s.recentValueRate; }},
+	    {"last_value", "gauge", "Value of the most recent sample", [](MonitoredQuantityStats const& s) { return s.lastSampleValue; }},
+	};
+
+	std::ostringstream os;
+	os.precision(17);
+	for (auto const& family : families)
+	{
+		os << "# HELP artdaq_monitored_" << family.name << ' ' << family.help << '\n'
+		   << "# TYPE artdaq_monitored_" << family.name << ' ' << family.type << '\n';
+		for (auto const& snapshot : snapshots)
+		{
+			os << "artdaq_monitored_" << family.name << "{quantity=\"" << escape_label(snapshot.first) << "\"} " << family.value(*snapshot.second) << '\n';
+		}
+	}
+
+	bool have_quantiles = std::any_of(snapshots.begin(), snapshots.end(), [](auto const& snapshot) { return snapshot.second->recentValueHistogram.totalCount() > 0; });
+	if (have_quantiles)
+	{
+		os << "# HELP artdaq_monitored_value_quantile Quantiles of the recent samples\n"
+		   << "# TYPE artdaq_monitored_value_quantile gauge\n";
+		for (auto const& snapshot : snapshots)
+		{
+			if (snapshot.second->recentValueHistogram.totalCount() == 0) continue;
+			for (auto q : {std::make_pair("0.5", 0.5), std::make_pair("0.99", 0.99), std::make_pair("0.999", 0.999)})
+			{
+				os << "artdaq_monitored_value_quantile{quantity=\"" << escape_label(snapshot.first) << "\",quantile=\"" << q.first << "\"} " << recent_quantile(*snapshot.second, q.second) << '\n';
+			}
+		}
+	}
+	return os.str();
+}
+
+void StatisticsExporter::writeTable_(std::map<std::string, MonitoredQuantityStatsPtr> const& snapshots)
+{
+	auto entries = reinterpret_cast<StatisticsTable::Entry*>(table_ + 1);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	if (snapshots.size() > table_capacity_ && !capacity_warning_issued_)
+	{
+		TLOG(TLVL_WARNING) << "StatisticsTable has room for " << table_capacity_ << " quantities, but there are " << snapshots.size() << "; the remainder will not be exported";
+		capacity_warning_issued_ = true;
+	}
+
+	size_t index = 0;
+	for (auto const& snapshot : snapshots)
+	{
+		if (index == table_capacity_) break;
+		auto& entry = entries[index++];  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		auto const& s = *snapshot.second;
+
+		auto sequence = entry.sequence.load(std::memory_order_relaxed);
+		entry.sequence.store(sequence + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		strncpy(&entry.name[0], snapshot.first.c_str(), StatisticsTable::NAME_LENGTH - 1);
+		entry.name[StatisticsTable::NAME_LENGTH - 1] = '\0';
+		entry.type = s.fullValueHistogram.totalCount() > 0 ? 1 : 0;
+		entry.enabled = s.enabled ? 1 : 0;
+		entry.values[StatisticsTable::FullSampleCount] = static_cast<double>(s.fullSampleCount);
+		entry.values[StatisticsTable::FullValueSum] = s.fullValueSum;
+		entry.values[StatisticsTable::FullValueAverage] = s.fullValueAverage;
+		entry.values[StatisticsTable::FullValueRMS] = s.fullValueRMS;
+		entry.values[StatisticsTable::FullValueMin] = s.fullValueMin;
+		entry.values[StatisticsTable::FullValueMax] = s.fullValueMax;
+		entry.values[StatisticsTable::FullSampleRate] = s.fullSampleRate;
+		entry.values[StatisticsTable::FullValueRate] = s.fullValueRate;
+		entry.values[StatisticsTable::RecentSampleCount] = static_cast<double>(s.recentSampleCount);
+		entry.values[StatisticsTable::RecentValueSum] = s.recentValueSum;
+		entry.values[StatisticsTable::RecentValueAverage] = s.recentValueAverage;
+		entry.values[StatisticsTable::RecentValueRMS] = s.recentValueRMS;
+		entry.values[StatisticsTable::RecentValueMin] = s.recentValueMin;
+		entry.values[StatisticsTable::RecentValueMax] = s.recentValueMax;
+		entry.values[StatisticsTable::RecentSampleRate] = s.recentSampleRate;
+		entry.values[StatisticsTable::RecentValueRate] = s.recentValueRate;
+		entry.values[StatisticsTable::RecentValueP50] = recent_quantile(s, 0.5);
+		entry.values[StatisticsTable::RecentValueP99] = recent_quantile(s, 0.99);
+		entry.values[StatisticsTable::RecentValueP999] = recent_quantile(s, 0.999);
+		entry.values[StatisticsTable::LastSampleValue] = s.lastSampleValue;
+		entry.values[StatisticsTable::LastValueRate] = s.lastValueRate;
+		entry.values[StatisticsTable::LastCalculationTime] = s.lastCalculationTime;
+
+		entry.sequence.store(sequence + 2, std::memory_order_release);
+	}
+	table_->entry_count = index;
+	table_->update_time = TimeUtils::gettimeofday_us();
+	table_->update_count.fetch_add(1);
+}
+
+void StatisticsExporter::writeFile_(std::string const& text)
+{
+	// Write to a temporary file and rename it, so that scrapers never see a partial file
+	auto tmp = prometheus_file_ + ".tmp";
+	auto fp = fopen(tmp.c_str(), "w");
+	if (fp == nullptr)
+	{
+		TLOG(TLVL_WARNING) << "Could not open " << tmp << " for writing: " << strerror(errno);
+		return;
+	}
+	auto written = fwrite(text.data(), 1, text.size(), fp);
+	fclose(fp);
+	if (written != text.size() || rename(tmp.c_str(), prometheus_file_.c_str()) != 0)
+	{
+		TLOG(TLVL_WARNING) << "Could not write " << prometheus_file_ << ": " << strerror(errno);
+	}
+}
+
+void StatisticsExporter::serveClients_(int timeout_ms)
+{
+	pollfd pfd{listen_fd_, POLLIN, 0};
+	if (poll(&pfd, 1, timeout_ms) <= 0 || (pfd.revents & POLLIN) == 0) return;
+
+	auto fd = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+	if (fd == -1) return;
+
+	// A client which does not read must not stall the export thread
+	timeval timeout{0, SEND_TIMEOUT_MS * 1000};
+	setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+	std::string text;
+	{
+		std::lock_guard<std::mutex> lk(text_mutex_);
+		text = latest_text_;
+	}
+	size_t sent = 0;
+	while (sent < text.size())
+	{
+		auto sts = send(fd, text.data() + sent, text.size() - sent, MSG_NOSIGNAL);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		if (sts <= 0)
+		{
+			TLOG(TLVL_DEBUG + 33) << "Stopped sending statistics to client after " << sent << " of " << text.size() << " bytes: " << strerror(errno);
+			break;
+		}
+		sent += sts;
+	}
+	close(fd);
+}
+
+void StatisticsExporter::run_()
+{
+	auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(interval_));
+	auto next_export = std::chrono::steady_clock::now();
+	while (!stop_requested_)
+	{
+		if (std::chrono::steady_clock::now() >= next_export)
+		{
+			exportNow();
+			// If an export overran, skip the missed ones rather than running them back-to-back
+			next_export = std::max(next_export + interval, std::chrono::steady_clock::now());
+		}
+
+		if (listen_fd_ != -1)
+		{
+			// Serve clients between exports, checking for a stop request at least every 100 ms
+			auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(next_export - std::chrono::steady_clock::now()).count();
+			serveClients_(static_cast<int>(std::max<int64_t>(0, std::min<int64_t>(wait, 100))));
+		}
+		else
+		{
+			std::unique_lock<std::mutex> lk(stop_mutex_);
+			stop_cv_.wait_until(lk, next_export, [this] { return stop_requested_.load(); });
+		}
+	}
+}
+}  // namespace artdaq
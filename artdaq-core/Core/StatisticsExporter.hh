@@ -0,0 +1,174 @@
+#ifndef artdaq_core_Core_StatisticsExporter_hh
+#define artdaq_core_Core_StatisticsExporter_hh
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <boost/thread.hpp>
+#include "artdaq-core/Core/StatisticsCollection.hh"
+
+namespace artdaq {
+/**
+ * \brief Layout of the shared memory table written by StatisticsExporter
+ *
+ * The table is a StatisticsTableHeader followed by entry_capacity StatisticsTableEntry
+ * structures. There is a single writer; readers in other processes never take a lock,
+ * and instead use the per-entry sequence number as a seqlock: read the sequence number,
+ * copy the entry, and re-read the sequence number, retrying if it was odd or changed.
+ */
+struct StatisticsTable
+{
+	static constexpr uint32_t MAGIC = 0x5374A7D0;  ///< Value of StatisticsTableHeader::magic once the table is initialized
+	static constexpr uint32_t VERSION = 1;         ///< Version of the table layout
+	static constexpr size_t NAME_LENGTH = 64;      ///< Size of the (null-terminated) name field of each entry
+
+	/**
+	 * \brief Indices of the values stored for each MonitoredQuantity
+	 */
+	enum Field : uint32_t
+	{
+		FullSampleCount,      ///< MonitoredQuantityStats::fullSampleCount
+		FullValueSum,         ///< MonitoredQuantityStats::fullValueSum
+		FullValueAverage,     ///< MonitoredQuantityStats::fullValueAverage
+		FullValueRMS,         ///< MonitoredQuantityStats::fullValueRMS
+		FullValueMin,         ///< MonitoredQuantityStats::fullValueMin
+		FullValueMax,         ///< MonitoredQuantityStats::fullValueMax
+		FullSampleRate,       ///< MonitoredQuantityStats::fullSampleRate
+		FullValueRate,        ///< MonitoredQuantityStats::fullValueRate
+		RecentSampleCount,    ///< MonitoredQuantityStats::recentSampleCount
+		RecentValueSum,       ///< MonitoredQuantityStats::recentValueSum
+		RecentValueAverage,   ///< MonitoredQuantityStats::recentValueAverage
+		RecentValueRMS,       ///< MonitoredQuantityStats::recentValueRMS
+		RecentValueMin,       ///< MonitoredQuantityStats::recentValueMin
+		RecentValueMax,       ///< MonitoredQuantityStats::recentValueMax
+		RecentSampleRate,     ///< MonitoredQuantityStats::recentSampleRate
+		RecentValueRate,      ///< MonitoredQuantityStats::recentValueRate
+		RecentValueP50,       ///< Median of the "recent" samples (0 if the MonitoredQuantity does not track quantiles)
+		RecentValueP99,       ///< 99th percentile of the "recent" samples (0 if the MonitoredQuantity does not track quantiles)
+		RecentValueP999,      ///< 99.9th percentile of the "recent" samples (0 if the MonitoredQuantity does not track quantiles)
+		LastSampleValue,      ///< MonitoredQuantityStats::lastSampleValue
+		LastValueRate,        ///< MonitoredQuantityStats::lastValueRate
+		LastCalculationTime,  ///< MonitoredQuantityStats::lastCalculationTime
+		FieldCount            ///< Number of values stored for each MonitoredQuantity
+	};
+
+	/**
+	 * \brief Header of the shared memory table
+	 */
+	struct Header
+	{
+		std::atomic<uint32_t> magic;         ///< MAGIC once the table has been initialized
+		uint32_t version;                    ///< Layout version (VERSION)
+		uint32_t entry_capacity;             ///< Number of entries allocated in the table
+		std::atomic<uint32_t> entry_count;   ///< Number of entries currently in use
+		std::atomic<uint64_t> update_count;  ///< Number of times the table has been updated
+		std::atomic<uint64_t> update_time;   ///< Wall-clock time of the last update, in microseconds since the epoch
+	};
+
+	/**
+	 * \brief One MonitoredQuantity in the shared memory table
+	 */
+	struct Entry
+	{
+		std::atomic<uint64_t> sequence;  ///< Seqlock sequence number; odd while the entry is being written
+		char name[NAME_LENGTH];          ///< Name of the MonitoredQuantity in the StatisticsCollection
+		uint32_t type;                   ///< Kind of MonitoredQuantity: 1 if it tracks quantiles, else 0
+		uint32_t enabled;                ///< Whether the MonitoredQuantity is enabled
+		double values[FieldCount];       ///< Latest statistics, indexed by Field
+	};
+};
+
+/**
+ * \brief Periodically exports the statistics of every MonitoredQuantity in the StatisticsCollection
+ *
+ * The StatisticsExporter runs a background thread which, every export interval, takes a snapshot
+ * of all quantities (see StatisticsCollection::snapshotAll) and writes it to any of:
+ * - A SysV shared memory segment laid out as a StatisticsTable
+ * - A file, in Prometheus text exposition format (written to a temporary file and renamed)
+ * - A Unix domain socket, which sends the latest Prometheus text to each client that connects
+ *
+ * Exporting only reads published snapshots, so it never takes the locks used by data-taking threads.
+ */
+class StatisticsExporter
+{
+public:
+	/**
+	 * \brief StatisticsExporter Constructor
+	 * \param interval Time between exports, in seconds
+	 * \param shm_key Key of the shared memory segment to create for the StatisticsTable (0 for none). An existing segment
+	 * with this key is only replaced if it is a StatisticsTable which no process is attached to.
+	 * \param shm_capacity Maximum number of MonitoredQuantity instances in the StatisticsTable
+	 * \param prometheus_file Path of the Prometheus text file to write (empty for none)
+	 * \param socket_path Path of the Unix domain socket to serve Prometheus text on (empty for none)
+	 * \exception cet::exception if the shared memory segment or socket cannot be created
+	 */
+	StatisticsExporter(double interval, uint32_t shm_key, size_t shm_capacity = 256, std::string prometheus_file = "", std::string socket_path = "");
+
+	/**
+	 * \brief StatisticsExporter Destructor. Stops the export thread, and removes the shared memory segment and socket
+	 */
+	virtual ~StatisticsExporter() noexcept;
+
+	/**
+	 * \brief Export the current statistics immediately, on the calling thread
+	 *
+	 * Exports are serialized, so this may wait for one in progress on the export thread.
+	 */
+	void exportNow();
+
+	/**
+	 * \brief Render statistics in Prometheus text exposition format
+	 * \param snapshots Statistics to render, keyed by MonitoredQuantity name
+	 * \return Prometheus text, with one metric family per statistic and the quantity name as the "quantity" label
+	 */
+	static std::string RenderPrometheus(std::map<std::string, MonitoredQuantityStatsPtr> const& snapshots);
+
+	/**
+	 * \brief Get the number of the shared memory segment holding the StatisticsTable
+	 * \return The shared memory segment ID, or -1 if none
+	 */
+	int GetShmSegmentId() const { return shm_segment_id_; }
+
+private:
+	StatisticsExporter(StatisticsExporter const&) = delete;
+	StatisticsExporter(StatisticsExporter&&) = delete;
+	StatisticsExporter& operator=(StatisticsExporter const&) = delete;
+	StatisticsExporter& operator=(StatisticsExporter&&) = delete;
+
+	static constexpr int SEND_TIMEOUT_MS = 100;  ///< Longest time a socket client may block a send of the statistics text
+
+	// Remove a StatisticsTable segment left behind by a process which exited without cleaning up
+	static bool removeStaleTable_(uint32_t shm_key);
+
+	void run_();
+	void writeTable_(std::map<std::string, MonitoredQuantityStatsPtr> const& snapshots);
+	void writeFile_(std::string const& text);
+	void serveClients_(int timeout_ms);
+
+	double interval_;
+	std::string prometheus_file_;
+	std::string socket_path_;
+
+	int shm_segment_id_{-1};
+	StatisticsTable::Header* table_{nullptr};
+	size_t table_capacity_{0};
+	bool capacity_warning_issued_{false};
+	std::mutex export_mutex_;  // Serializes exports, as the StatisticsTable has a single writer
+
+	int listen_fd_{-1};
+	std::mutex text_mutex_;
+	std::string latest_text_;
+
+	std::atomic<bool> stop_requested_{false};
+	std::mutex stop_mutex_;
+	std::condition_variable stop_cv_;
+	std::unique_ptr<boost::thread> export_thread_;
+};
+}  // namespace artdaq
+
+#endif /* artdaq_core_Core_StatisticsExporter_hh */
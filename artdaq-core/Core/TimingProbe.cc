@@ -0,0 +1,55 @@
+#define TRACE_NAME "TimingProbe"
+#include "artdaq-core/Core/TimingProbe.hh"
+
+#include <cstdlib>
+
+#include "TRACE/tracemf.h"
+
+std::atomic<uint32_t> artdaq::TimingProbe::sample_interval_(0);
+std::atomic<bool> artdaq::TimingProbe::use_tsc_(false);
+
+namespace {
+// Apply ARTDAQ_TIMING_PROBE_INTERVAL at static initialization, which also calibrates the TSC if it is set
+bool set_initial_sample_interval()
+{
+	auto env = getenv("ARTDAQ_TIMING_PROBE_INTERVAL");
+	auto interval = env != nullptr ? static_cast<uint32_t>(strtoul(env, nullptr, 0)) : 0;
+	if (interval != 0) artdaq::TimingProbe::SetSampleInterval(interval);
+	return interval != 0;
+}
+const bool initial_sample_interval_set = set_initial_sample_interval();
+}  // namespace
+
+void artdaq::TimingProbe::SetSampleInterval(uint32_t interval)
+{
+	if (interval != 0) select_clock_();
+	sample_interval_ = interval;
+}
+
+void artdaq::TimingProbe::select_clock_()
+{
+	use_tsc_ = TimeUtils::calibrate_tsc() != nullptr;
+}
+
+double artdaq::TimingProbe::SecondsPerTick()
+{
+	auto calibration = use_tsc_.load(std::memory_order_relaxed) ? TimeUtils::get_tsc_calibration() : nullptr;
+	return calibration != nullptr ? calibration->ns_per_tick * 1e-9 : 1e-9;
+}
+
+artdaq::MonitoredQuantity* artdaq::TimingProbe::register_()
+{
+	std::call_once(registered_, [this] {
+		auto& collection = StatisticsCollection::getInstance();
+		quantity_ptr_ = collection.getMonitoredQuantity(name_);
+		if (quantity_ptr_ == nullptr)
+		{
+			// Durations are in seconds; keep a histogram so that tail latencies can be reported
+			quantity_ptr_ = std::make_shared<MonitoredQuantity>(1.0, 60.0, true);
+			collection.addMonitoredQuantity(name_, quantity_ptr_);
+		}
+		TLOG(TLVL_DEBUG) << "Registered timing probe " << name_ << ", sampling one in " << SampleInterval() << " passes, " << SecondsPerTick() * 1e9 << " ns per tick";
+		quantity_.store(quantity_ptr_.get(), std::memory_order_release);
+	});
+	return quantity_.load(std::memory_order_acquire);
+}
@@ -0,0 +1,195 @@
+#ifndef artdaq_core_Core_TimingProbe_hh
+#define artdaq_core_Core_TimingProbe_hh
+
+////////////////////////////////////////////////////////////////////////
+// TimingProbe
+//
+// Low-overhead timing of code regions, reported through a
+// MonitoredQuantity in the StatisticsCollection. Usage:
+//
+//   void MyReceiver::readData()
+//   {
+//     ARTDAQ_TIMING_PROBE("MyReceiver.readData");
+//     ...
+//   }
+//
+// Only one in every SampleInterval() passes through a probe is timed
+// (per thread); the others cost a thread-local decrement. Sampling is
+// off (interval 0) unless set with TimingProbe::SetSampleInterval or
+// the ARTDAQ_TIMING_PROBE_INTERVAL environment variable. Defining
+// ARTDAQ_DISABLE_TIMING_PROBES compiles all probes out.
+//
+// Timed passes read the CPU time-stamp counter, using the calibration
+// shared with TimeUtils. It is calibrated when sampling is enabled,
+// never while timing; without an invariant TSC, the steady clock is
+// used instead.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "artdaq-core/Core/StatisticsCollection.hh"
+#include "artdaq-core/Utilities/TimeUtils.hh"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+namespace artdaq {
+/**
+ * \brief One instrumented code region, with the MonitoredQuantity its timings are reported to
+ *
+ * TimingProbe objects are created as function-local statics by the ARTDAQ_TIMING_PROBE macro.
+ * The MonitoredQuantity is created and registered in the StatisticsCollection the first time
+ * the region is actually timed.
+ */
+class TimingProbe
+{
+public:
+	/**
+	 * \brief TimingProbe Constructor
+	 * \param name Name under which the MonitoredQuantity will be registered in the StatisticsCollection
+	 */
+	explicit TimingProbe(std::string name)
+	    : name_(std::move(name)) {}
+
+	/**
+	 * \brief Read the timestamp counter (or the steady clock, in ns, if the TSC is not calibrated)
+	 * \return The current tick count
+	 */
+	static uint64_t Now()
+	{
+		if (use_tsc_.load(std::memory_order_relaxed)) return TimeUtils::read_tsc();
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	/**
+	 * \brief Length of one tick of Now()
+	 * \return Seconds per tick, from the current TimeUtils TSC calibration
+	 */
+	static double SecondsPerTick();
+
+	/**
+	 * \brief Set how often probes are timed
+	 * \param interval Time one in every interval passes through each probe, per thread (0 disables timing)
+	 *
+	 * Enabling sampling calibrates the TSC (see TimeUtils::calibrate_tsc) if that has not already been done.
+	 */
+	static void SetSampleInterval(uint32_t interval);
+
+	/**
+	 * \brief Get how often probes are timed
+	 * \return One in every SampleInterval() passes is timed (0 if timing is disabled)
+	 */
+	static uint32_t SampleInterval() { return sample_interval_.load(std::memory_order_relaxed); }
+
+	/**
+	 * \brief Decide whether the current pass through a probe should be timed
+	 * \return Whether to time this pass
+	 */
+	static bool ShouldSample()
+	{
+		auto interval = SampleInterval();
+		if (interval == 0) return false;
+		thread_local uint32_t countdown = 0;
+		if (countdown == 0)
+		{
+			countdown = interval - 1;
+			return true;
+		}
+		--countdown;
+		return false;
+	}
+
+	/**
+	 * \brief Report one timed pass through the region
+	 * \param ticks Duration of the pass, in Now() ticks
+	 */
+	void record(uint64_t ticks)
+	{
+		auto quantity = quantity_.load(std::memory_order_acquire);
+		if (quantity == nullptr) quantity = register_();
+		quantity->addSample(static_cast<double>(ticks) * SecondsPerTick());
+	}
+
+	/**
+	 * \brief Get the name of the probe
+	 * \return The name under which the MonitoredQuantity is registered
+	 */
+	std::string const& name() const { return name_; }
+
+private:
+	TimingProbe(TimingProbe const&) = delete;
+	TimingProbe(TimingProbe&&) = delete;
+	TimingProbe& operator=(TimingProbe const&) = delete;
+	TimingProbe& operator=(TimingProbe&&) = delete;
+
+	// Create the MonitoredQuantity and register it in the StatisticsCollection
+	MonitoredQuantity* register_();
+
+	// Select the clock read by Now(). Called before sampling is enabled, so that a timed pass never calibrates
+	// and its start and end are always read from the same clock.
+	static void select_clock_();
+
+	static std::atomic<uint32_t> sample_interval_;
+	static std::atomic<bool> use_tsc_;
+
+	std::string name_;
+	std::once_flag registered_;
+	MonitoredQuantityPtr quantity_ptr_;
+	std::atomic<MonitoredQuantity*> quantity_{nullptr};
+};
+
+/**
+ * \brief Times the scope in which it is declared, if TimingProbe::ShouldSample() says to
+ */
+class ScopedTimingProbe
+{
+public:
+	/**
+	 * \brief Start timing, if this pass is sampled
+	 * \param probe TimingProbe to report to
+	 */
+	explicit ScopedTimingProbe(TimingProbe& probe)
+	    : probe_(TimingProbe::ShouldSample() ? &probe : nullptr)
+	    , start_(probe_ != nullptr ? TimingProbe::Now() : 0)
+	{}
+
+	/**
+	 * \brief Stop timing and report the duration, if this pass was sampled
+	 */
+	~ScopedTimingProbe()
+	{
+		if (probe_ != nullptr) probe_->record(TimingProbe::Now() - start_);
+	}
+
+private:
+	ScopedTimingProbe(ScopedTimingProbe const&) = delete;
+	ScopedTimingProbe(ScopedTimingProbe&&) = delete;
+	ScopedTimingProbe& operator=(ScopedTimingProbe const&) = delete;
+	ScopedTimingProbe& operator=(ScopedTimingProbe&&) = delete;
+
+	TimingProbe* probe_;
+	uint64_t start_;
+};
+}  // namespace artdaq
+
+#define ARTDAQ_TIMING_PROBE_CONCAT_(a, b) a##b
+#define ARTDAQ_TIMING_PROBE_CONCAT(a, b) ARTDAQ_TIMING_PROBE_CONCAT_(a, b)
+
+#ifndef ARTDAQ_DISABLE_TIMING_PROBES
+/**
+ * \brief Time the rest of the enclosing scope, reporting to the MonitoredQuantity with the given name
+ */
+#define ARTDAQ_TIMING_PROBE(name)                                                                                  \
+	static artdaq::TimingProbe ARTDAQ_TIMING_PROBE_CONCAT(artdaq_timing_probe_, __LINE__)(name);                   \
+	artdaq::ScopedTimingProbe ARTDAQ_TIMING_PROBE_CONCAT(artdaq_scoped_timing_probe_, __LINE__)(                   \
+	    ARTDAQ_TIMING_PROBE_CONCAT(artdaq_timing_probe_, __LINE__))
+#else
+#define ARTDAQ_TIMING_PROBE(name) \
+	do                            \
+	{                             \
+	} while (0)
+#endif
+
+#endif /* artdaq_core_Core_TimingProbe_hh */
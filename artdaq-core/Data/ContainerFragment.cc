@@ -0,0 +1,362 @@
+#include "artdaq-core/Data/ContainerFragment.hh"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+constexpr size_t BLOCKS_PER_VALIDATION_THREAD = 8192;
+constexpr size_t MAX_VALIDATION_THREADS = 8;
+constexpr size_t MAX_INDEX_CACHE_ENTRIES = 1024;
+
+/// An index rebuilt from the contained Fragment headers, along with the shape of the Fragment it was built for
+struct IndexCacheEntry
+{
+	size_t payload_bytes;
+	size_t block_count;
+	size_t index_offset;
+	artdaq::Fragment::sequence_id_t sequence_id;
+	artdaq::Fragment::fragment_id_t fragment_id;
+	std::shared_ptr<std::vector<size_t> const> index;
+};
+
+std::mutex index_cache_mutex;
+std::unordered_map<void const*, IndexCacheEntry> index_cache;  ///< Keyed by the start of the Fragment payload
+
+/**
+ * \brief Check that a cached index still describes the Fragment payload it is keyed by
+ * \param entry Cached index and Fragment shape
+ * \param payload Start of the Fragment payload
+ * \return Whether the first and last contained Fragment headers still end where the index says
+ *
+ * The buffer may have been reused for another Fragment of the same shape, so the headers are spot-checked.
+ */
+bool cachedIndexMatches(IndexCacheEntry const& entry, uint8_t const* payload)
+{
+	if (entry.block_count == 0) return true;
+	auto const& index = *entry.index;
+	auto first = reinterpret_cast<artdaq::detail::RawFragmentHeader const*>(payload);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+	if (first->word_count * sizeof(artdaq::RawDataType) != index[0]) return false;
+	auto last_begin = entry.block_count == 1 ? 0 : index[entry.block_count - 2];
+	auto last = reinterpret_cast<artdaq::detail::RawFragmentHeader const*>(payload + last_begin);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	return last->word_count * sizeof(artdaq::RawDataType) == index[entry.block_count - 1] - last_begin;
+}
+
+/**
+ * \brief Check the index entries for blocks [begin, end)
+ * \param payload Start of the ContainerFragment payload
+ * \param index Index stored in the ContainerFragment
+ * \param begin First block to check
+ * \param end One past the last block to check
+ * \param index_offset Offset of the index in the payload (at or after the end of the contained Fragments)
+ * \param uncompressed_sizes Uncompressed Fragment sizes stored in the index of a compressed ContainerFragment, or nullptr
+ * \return Whether every checked entry matches the word_count of its block (or, if compressed, is a plausible size)
+ */
+bool validateIndexRange(uint8_t const* payload, size_t const* index, size_t begin, size_t end, size_t index_offset, size_t const* uncompressed_sizes)
+{
+	size_t start = begin == 0 ? 0 : index[begin - 1];  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	for (size_t ii = begin; ii < end; ++ii)
+	{
+		auto block_end = index[ii];  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		if (block_end > index_offset || block_end <= start || start + sizeof(artdaq::RawDataType) > index_offset)
+		{
+			return false;
+		}
+		if (uncompressed_sizes != nullptr)
+		{
+			// Compressed blocks have no readable header, but each holds at least a RawFragmentHeader
+			auto size = uncompressed_sizes[ii];  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+			if (size < sizeof(artdaq::detail::RawFragmentHeaderV1) || size % sizeof(artdaq::RawDataType) != 0) return false;
+			start = block_end;
+			continue;
+		}
+		auto hdr = reinterpret_cast<artdaq::detail::RawFragmentHeader const*>(payload + start);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		if (hdr->word_count * sizeof(artdaq::RawDataType) != block_end - start)
+		{
+			return false;
+		}
+		start = block_end;
+	}
+	return true;
+}
+}  // namespace
+
+bool artdaq::ContainerFragment::validateIndex() const
+{
+	auto md = metadata();
+	if (md->version == 0 || !md->has_index) return false;
+
+	size_t block_count = block_count_(md);
+	size_t index_offset = md->index_offset;
+	size_t index_words = compressed_(md) ? 2 * block_count + 1 : block_count + 1;
+	if (index_offset % sizeof(size_t) != 0 || index_offset + sizeof(size_t) * index_words > artdaq_Fragment_.dataSizeBytes())
+	{
+		return false;
+	}
+
+	auto payload = artdaq_Fragment_.dataBeginBytes();
+	auto index = reinterpret_cast<size_t const*>(payload + index_offset);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	if (index[block_count] != CONTAINER_MAGIC) return false;                // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	if (block_count == 0) return true;
+	if (index[block_count - 1] > index_offset) return false;           // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	auto sizes = compressed_(md) ? index + block_count + 1 : nullptr;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+
+	size_t threads = 1;
+	if (block_count >= PARALLEL_VALIDATION_THRESHOLD)
+	{
+		threads = std::min({static_cast<size_t>(std::max(std::thread::hardware_concurrency(), 1U)), block_count / BLOCKS_PER_VALIDATION_THREAD, MAX_VALIDATION_THREADS});
+	}
+	if (threads <= 1)
+	{
+		return validateIndexRange(payload, index, 0, block_count, index_offset, sizes);
+	}
+
+	TLOG(TLVL_DEBUG + 33, "ContainerFragment") << "Validating index of " << block_count << " blocks using " << threads << " threads";
+	std::atomic<bool> valid(true);
+	std::vector<std::thread> workers;
+	workers.reserve(threads - 1);
+	auto blocks_per_thread = (block_count + threads - 1) / threads;
+	for (size_t tt = 1; tt < threads; ++tt)
+	{
+		auto begin = std::min(tt * blocks_per_thread, block_count);
+		auto end = std::min(begin + blocks_per_thread, block_count);
+		workers.emplace_back([&valid, payload, index, begin, end, index_offset, sizes]() {
+			if (!validateIndexRange(payload, index, begin, end, index_offset, sizes)) valid = false;
+		});
+	}
+	if (!validateIndexRange(payload, index, 0, std::min(blocks_per_thread, block_count), index_offset, sizes)) valid = false;
+	for (auto& worker : workers)
+	{
+		worker.join();
+	}
+	return valid;
+}
+
+bool artdaq::ContainerFragment::verifyIndex() const
+{
+	if (validateIndex())
+	{
+		reset_index_ptr_();
+		return true;
+	}
+
+	TLOG(TLVL_WARNING, "ContainerFragment") << "Index of ContainerFragment with sequence ID " << artdaq_Fragment_.sequenceID() << " is invalid, rebuilding it from the contained Fragment headers";
+	index_ptr_ = create_index_();
+	return false;
+}
+
+void artdaq::ContainerFragment::load_index_() const
+{
+	if (index_ptr_ != nullptr) return;  // Set by UpgradeMetadata for MetadataV0 containers
+
+	// Containers written with an index are trusted if it is terminated by CONTAINER_MAGIC where expected
+	auto md = metadata();
+	if (md->has_index && md->index_offset + sizeof(size_t) * (block_count_(md) + 1) <= artdaq_Fragment_.dataSizeBytes())
+	{
+		auto index = reinterpret_cast<size_t const*>(artdaq_Fragment_.dataBeginBytes() + md->index_offset);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		if (index[block_count_(md)] == CONTAINER_MAGIC)                                                       // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		{
+			index_ptr_ = index;
+			return;
+		}
+		TLOG(TLVL_WARNING, "ContainerFragment") << "Index of ContainerFragment with sequence ID " << artdaq_Fragment_.sequenceID() << " not found where expected, rebuilding it from the contained Fragment headers";
+	}
+
+	auto payload = artdaq_Fragment_.dataBeginBytes();
+	{
+		std::lock_guard<std::mutex> lk(index_cache_mutex);
+		auto it = index_cache.find(payload);
+		if (it != index_cache.end())
+		{
+			auto const& entry = it->second;
+			if (entry.payload_bytes == artdaq_Fragment_.dataSizeBytes() && entry.block_count == block_count_(md) && entry.index_offset == md->index_offset &&
+			    entry.sequence_id == artdaq_Fragment_.sequenceID() && entry.fragment_id == artdaq_Fragment_.fragmentID() && cachedIndexMatches(entry, payload))
+			{
+				TLOG(TLVL_DEBUG + 34, "ContainerFragment") << "Using cached index for ContainerFragment with sequence ID " << entry.sequence_id;
+				index_ptr_owner_ = entry.index;
+				index_ptr_ = index_ptr_owner_->data();
+				return;
+			}
+			index_cache.erase(it);
+		}
+	}
+
+	index_ptr_ = create_index_();
+
+	std::lock_guard<std::mutex> lk(index_cache_mutex);
+	if (index_cache.size() >= MAX_INDEX_CACHE_ENTRIES) index_cache.clear();
+	index_cache[payload] = IndexCacheEntry{artdaq_Fragment_.dataSizeBytes(), block_count_(md), md->index_offset,
+	                                       artdaq_Fragment_.sequenceID(), artdaq_Fragment_.fragmentID(), index_ptr_owner_};
+}
+
+void artdaq::ContainerFragment::ClearIndexCache()
+{
+	std::lock_guard<std::mutex> lk(index_cache_mutex);
+	index_cache.clear();
+}
+
+artdaq::FragmentView artdaq::ContainerFragment::view(std::vector<size_t> const& path) const
+{
+	if (path.empty())
+	{
+		throw cet::exception("ArgumentOutOfRange") << "ContainerFragment::view was given an empty path!";  // NOLINT(cert-err60-cpp)
+	}
+
+	auto output = view(path[0]);
+	for (size_t level = 1; level < path.size(); ++level)
+	{
+		output = NestedView(output, path[level]);
+	}
+	return output;
+}
+
+artdaq::FragmentView artdaq::ContainerFragment::NestedView(FragmentView const& container, size_t index)
+{
+	if (container.type() != Fragment::ContainerFragmentType)
+	{
+		throw cet::exception("InvalidPath") << "ContainerFragment::NestedView: Fragment with type " << static_cast<int>(container.type()) << " is not a ContainerFragment!";  // NOLINT(cert-err60-cpp)
+	}
+
+	auto payload = reinterpret_cast<uint8_t const*>(container.dataBegin());  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+	auto payload_bytes = container.dataSizeBytes();
+	auto metadata_bytes = (container.dataBegin() - container.metadataAddress()) * sizeof(RawDataType);
+
+	size_t block_count = 0;
+	size_t const* index_ptr = nullptr;
+	if (metadata_bytes == sizeof(Metadata))
+	{
+		auto md = container.metadata<Metadata>();
+		if (compressed_(md))
+		{
+			throw cet::exception("CompressedContainer") << "ContainerFragment::NestedView cannot be used on a compressed ContainerFragment!";  // NOLINT(cert-err60-cpp)
+		}
+		block_count = block_count_(md);
+		if (md->has_index && md->index_offset + sizeof(size_t) * (block_count + 1) <= payload_bytes)
+		{
+			auto stored_index = reinterpret_cast<size_t const*>(payload + md->index_offset);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+			if (stored_index[block_count] == CONTAINER_MAGIC) index_ptr = stored_index;       // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		}
+	}
+	else if (metadata_bytes == sizeof(MetadataV0))
+	{
+		auto md = container.metadata<MetadataV0>();
+		block_count = md->block_count;
+		index_ptr = static_cast<size_t const*>(md->index);
+	}
+	else
+	{
+		throw cet::exception("InvalidFragment") << "ContainerFragment::NestedView: ContainerFragment has unexpected metadata size " << metadata_bytes;  // NOLINT(cert-err60-cpp)
+	}
+
+	if (index >= block_count)
+	{
+		throw cet::exception("ArgumentOutOfRange") << "Buffer overrun detected! ContainerFragment::NestedView was asked for a non-existent Fragment (index " << index << ", block_count " << block_count << ")!";  // NOLINT(cert-err60-cpp)
+	}
+
+	size_t offset = 0;
+	if (index_ptr != nullptr)
+	{
+		offset = index == 0 ? 0 : index_ptr[index - 1];  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	}
+	else
+	{
+		// No usable index; walk the contained Fragment headers
+		for (size_t ii = 0; ii < index && offset + sizeof(RawDataType) <= payload_bytes; ++ii)
+		{
+			auto this_size = reinterpret_cast<detail::RawFragmentHeader const*>(payload + offset)->word_count * sizeof(RawDataType);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+			if (this_size == 0)
+			{
+				throw cet::exception("InvalidIndex") << "ContainerFragment::NestedView: Block " << ii << " has zero size!";  // NOLINT(cert-err60-cpp)
+			}
+			offset += this_size;
+		}
+	}
+
+	if (offset + sizeof(RawDataType) > payload_bytes)
+	{
+		throw cet::exception("InvalidIndex") << "ContainerFragment::NestedView: Block " << index << " starts beyond the end of the payload!";  // NOLINT(cert-err60-cpp)
+	}
+	return FragmentView(reinterpret_cast<RawDataType const*>(payload + offset));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+}
+
+artdaq::FragmentPtr artdaq::ContainerFragment::decompress_(size_t index) const
+{
+	auto size = fragSize(index);
+	auto start = fragmentIndex(index);
+	auto compressed_size = fragmentIndex(index + 1) - start;
+	if (size < sizeof(detail::RawFragmentHeaderV1) || size % sizeof(RawDataType) != 0)
+	{
+		throw cet::exception("InvalidIndex") << "ContainerFragment::at: Compressed Fragment " << index << " has an invalid size (" << size << " bytes)!";  // NOLINT(cert-err60-cpp)
+	}
+
+	// Fragment(n) allocates n + RawFragmentHeader::num_words() words; the decompressed header determines the layout
+	auto words = size / sizeof(RawDataType);
+	auto frag = std::make_unique<Fragment>(words > detail::RawFragmentHeader::num_words() ? words - detail::RawFragmentHeader::num_words() : 0);
+
+	uLongf out_size = size;
+	auto sts = uncompress(reinterpret_cast<Bytef*>(frag->headerAddress()), &out_size,                                   // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+	                      reinterpret_cast<Bytef const*>(artdaq_Fragment_.dataBeginBytes() + start), compressed_size);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	if (sts != Z_OK || out_size != size)
+	{
+		TLOG(TLVL_ERROR, "ContainerFragment") << "Error decompressing Fragment " << index << ": zlib status " << sts << ", " << out_size << " of " << size << " bytes";
+		throw cet::exception("DecompressionError") << "ContainerFragment::at: Error decompressing Fragment " << index << " (zlib status " << sts << ")";  // NOLINT(cert-err60-cpp)
+	}
+	return frag;
+}
+
+std::vector<size_t> artdaq::ContainerFragment::blocksInTimeRange(Fragment::timestamp_t t0, Fragment::timestamp_t t1) const
+{
+	std::vector<size_t> output;
+	auto block_count = this->block_count();
+	if (t1 < t0 || block_count == 0) return output;
+
+	auto info = block_info_();
+	if (info == nullptr)
+	{
+		for (size_t ii = 0; ii < block_count; ++ii)
+		{
+			auto ts = blockTimestamp(ii);
+			if (ts >= t0 && ts <= t1) output.push_back(ii);
+		}
+		return output;
+	}
+
+	auto timestamps = info + 1;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	if (info[0] != 0)
+	{
+		auto first = std::lower_bound(timestamps, timestamps + block_count, t0);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		auto last = std::upper_bound(first, timestamps + block_count, t1);        // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		output.resize(last - first);
+		std::iota(output.begin(), output.end(), static_cast<size_t>(first - timestamps));
+		return output;
+	}
+
+	// Out-of-order timestamps: branch-free test of a chunk of timestamps at a time (which the compiler can vectorize),
+	// only looking at individual entries for chunks which contain a match
+	constexpr size_t chunk = 8;
+	auto span = t1 - t0;
+	size_t ii = 0;
+	for (; ii + chunk <= block_count; ii += chunk)
+	{
+		unsigned matches = 0;
+		for (size_t jj = 0; jj < chunk; ++jj)
+		{
+			matches |= static_cast<unsigned>(timestamps[ii + jj] - t0 <= span) << jj;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		}
+		while (matches != 0)
+		{
+			output.push_back(ii + __builtin_ctz(matches));
+			matches &= matches - 1;
+		}
+	}
+	for (; ii < block_count; ++ii)
+	{
+		if (timestamps[ii] - t0 <= span) output.push_back(ii);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	}
+	return output;
+}
@@ -2,7 +2,9 @@
 #define artdaq_core_Data_ContainerFragment_hh
 
 #include <memory>
+#include <vector>
 #include "artdaq-core/Data/Fragment.hh"
+#include "artdaq-core/Data/FragmentView.hh"
 #include "cetlib_except/exception.h"
 
 // #include <ostream>
@@ -20,11 +22,18 @@ class ContainerFragment;
 class artdaq::ContainerFragment
 {
 public:
-	/// The current version of the ContainerFragmentHeader
-	static constexpr uint8_t CURRENT_VERSION = 1;
+	/// The current version of the ContainerFragmentHeader. Version 2 adds Metadata::block_count_high; version 1 data is still readable.
+	static constexpr uint8_t CURRENT_VERSION = 2;
+	/// The maximum number of Fragments in a version 2 ContainerFragment (version 1 is limited to 65535)
+	static constexpr size_t MAX_BLOCK_COUNT = (1ULL << 48) - 1;
 	/// Marker word used in index
 	static constexpr size_t CONTAINER_MAGIC = 0x00BADDEED5B1BEE5;
 
+	typedef FragmentViewIterator const_iterator;  ///< Iterator over the contained Fragments, yielding FragmentView objects
+
+	/// Containers with at least this many blocks have their index validated in parallel
+	static constexpr size_t PARALLEL_VALIDATION_THRESHOLD = 16384;
+
 	/**
 	 * \brief Contains the information necessary for retrieving Fragment objects from the ContainerFragment
 	 */
@@ -63,11 +72,11 @@ public:
 		count_t version : 4;        ///< Version number of ContainerFragment
 		count_t missing_data : 1;   ///< Flag if the ContainerFragment knows that it is missing data
 		count_t has_index : 1;      ///< Whether the ContainerFragment has an index at the end of the payload
-		count_t unused_flag1 : 1;   ///< Unused
-		count_t unused_flag2 : 1;   ///< Unused
-		count_t unused : 32;        ///< Unused
+		count_t compressed : 1;     ///< Whether each Fragment is stored as an independent zlib stream (version 2 and later, unused before)
+		count_t has_block_info : 1;  ///< Whether the index is followed by per-Fragment timestamps, sequence IDs and Fragment IDs (version 2 and later, unused before)
+		count_t block_count_high : 32;  ///< Upper 32 bits of the number of Fragment objects (version 2 and later, unused before)
 
-		uint64_t index_offset;  ///< Index starts this many bytes after the beginning of the payload (is also the total size of contained Fragments)
+		uint64_t index_offset;  ///< Index starts this many bytes after the beginning of the payload (at or after the end of the contained Fragments)
 
 		/// Size of the Metadata object
 		static size_t const size_words = 16ul;  // Units of Header::data_t
@@ -127,7 +136,7 @@ public:
 	 * \brief Gets the number of fragments stored in the ContainerFragment
 	 * \return The number of Fragment objects stored in the ContainerFragment
 	 */
-	Metadata::count_t block_count() const { return metadata()->block_count; }
+	Metadata::count_t block_count() const { return block_count_(metadata()); }
 	/**
 	 * \brief Get the Fragment::type_t of stored Fragment objects
 	 * \return The Fragment::type_t of stored Fragment objects
@@ -138,6 +147,22 @@ public:
 	 * \return The flag if the ContainerFragment knows that it is missing data
 	 */
 	bool missing_data() const { return static_cast<bool>(metadata()->missing_data); }
+	/**
+	 * \brief Gets the flag if the contained Fragments are stored compressed
+	 * \return Whether the contained Fragments are stored compressed
+	 *
+	 * In a compressed ContainerFragment, each Fragment is compressed independently and only decompressed by at(). The index
+	 * holds the end offset of each compressed block, CONTAINER_MAGIC, and then the uncompressed size of each Fragment.
+	 */
+	bool compressed() const { return compressed_(metadata()); }
+	/**
+	 * \brief Gets the flag if the index is followed by per-Fragment header information
+	 * \return Whether per-Fragment timestamps, sequence IDs and Fragment IDs are stored after the index
+	 *
+	 * The block information is stored as a word which is non-zero if the timestamps are in non-decreasing order,
+	 * followed by arrays of the timestamps, sequence IDs and (16-bit) Fragment IDs of the contained Fragments.
+	 */
+	bool has_block_info() const { return block_info_() != nullptr; }
 
 	/**
 	 * \brief Gets the start of the data
@@ -169,6 +194,7 @@ public:
 		{
 			throw cet::exception("ArgumentOutOfRange") << "Buffer overrun detected! ContainerFragment::at was asked for a non-existent Fragment!";  // NOLINT(cert-err60-cpp)
 		}
+		if (compressed()) return decompress_(index);
 
 		FragmentPtr frag(nullptr);
 		auto size = fragSize(index);
@@ -186,10 +212,73 @@ public:
 		return frag;
 	}
 
+	/**
+	 * \brief Gets a non-owning view of a specific Fragment in the ContainerFragment, without copying it
+	 * \param index The Fragment index to view
+	 * \return FragmentView of the specified Fragment, valid as long as the underlying Fragment is not modified
+	 * \exception cet::exception if the index is out-of-range, or if the ContainerFragment is compressed
+	 */
+	FragmentView view(size_t index) const
+	{
+		if (index >= block_count() || block_count() == 0)
+		{
+			throw cet::exception("ArgumentOutOfRange") << "Buffer overrun detected! ContainerFragment::view was asked for a non-existent Fragment!";  // NOLINT(cert-err60-cpp)
+		}
+		check_uncompressed_("view");
+		return FragmentView(reinterpret_cast<RawDataType const*>(reinterpret_cast<uint8_t const*>(dataBegin()) + fragmentIndex(index)));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	}
+
+	/**
+	 * \brief Gets a non-owning view of a Fragment stored in a hierarchy of ContainerFragments, without copying it
+	 * \param path Position of the Fragment at each level, starting with this ContainerFragment
+	 * \return FragmentView of the specified Fragment, valid as long as the underlying Fragment is not modified
+	 * \exception cet::exception if the path is empty, a position is out-of-range, or an intermediate Fragment is not a ContainerFragment
+	 *
+	 * Each level is looked up using the index of the ContainerFragment at that level, so the cost is proportional to the length of the path.
+	 */
+	FragmentView view(std::vector<size_t> const& path) const;
+
+	/**
+	 * \brief Gets a copy of a Fragment stored in a hierarchy of ContainerFragments
+	 * \param path Position of the Fragment at each level, starting with this ContainerFragment
+	 * \return Pointer to a copy of the specified Fragment. Only the addressed Fragment is copied.
+	 * \exception cet::exception if the path is empty, a position is out-of-range, or an intermediate Fragment is not a ContainerFragment
+	 */
+	FragmentPtr at(std::vector<size_t> const& path) const
+	{
+		return view(path).toFragment();
+	}
+
+	/**
+	 * \brief Gets a non-owning view of a Fragment stored in a ContainerFragment which is itself only available as a view
+	 * \param container FragmentView of a ContainerFragment (for example, one returned by view())
+	 * \param index The Fragment index within container
+	 * \return FragmentView of the specified Fragment
+	 * \exception cet::exception if container is not a ContainerFragment, or the index is out-of-range
+	 */
+	static FragmentView NestedView(FragmentView const& container, size_t index);
+
+	/**
+	 * \brief Iterator to the first contained Fragment, for walking the ContainerFragment without copying
+	 * \return const_iterator to the first contained Fragment
+	 * \exception cet::exception if the ContainerFragment is compressed
+	 */
+	const_iterator begin() const
+	{
+		check_uncompressed_("begin");
+		return const_iterator(reinterpret_cast<RawDataType const*>(dataBegin()));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+	}
+
+	/**
+	 * \brief Iterator one past the last contained Fragment
+	 * \return const_iterator one past the last contained Fragment
+	 */
+	const_iterator end() const { return const_iterator(reinterpret_cast<RawDataType const*>(dataEnd())); }  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+
 	/**
 	 * \brief Gets the size of the Fragment at the specified location in the ContainerFragment, in bytes
 	 * \param index The Fragment index
-	 * \return The size of the Fragment at the specified location in the ContainerFragment, in bytes
+	 * \return The size of the Fragment at the specified location in the ContainerFragment, in bytes (before compression, if compressed)
 	 * \exception cet::exception if the index is out-of-range
 	 */
 	size_t fragSize(size_t index) const
@@ -198,6 +287,7 @@ public:
 		{
 			throw cet::exception("ArgumentOutOfRange") << "Buffer overrun detected! ContainerFragment::fragSize was asked for a non-existent Fragment!";  // NOLINT(cert-err60-cpp)
 		}
+		if (compressed()) return get_index_()[block_count() + 1 + index];  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
 		auto end = fragmentIndex(index + 1);
 		if (index == 0) return end;
 		return end - fragmentIndex(index);
@@ -242,7 +332,187 @@ public:
 		return fragmentIndex(block_count());
 	}
 
+	/**
+	 * \brief Gets the timestamp of a contained Fragment, without copying (or decompressing) it if the block information is stored
+	 * \param index The Fragment index
+	 * \return The timestamp of the specified Fragment
+	 * \exception cet::exception if the index is out-of-range
+	 */
+	Fragment::timestamp_t blockTimestamp(size_t index) const
+	{
+		auto info = block_info_();
+		if (info == nullptr) return blockHeader_(index).timestamp;
+		check_block_index_(index, "blockTimestamp");
+		return info[1 + index];  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	}
+
+	/**
+	 * \brief Gets the sequence ID of a contained Fragment, without copying (or decompressing) it if the block information is stored
+	 * \param index The Fragment index
+	 * \return The sequence ID of the specified Fragment
+	 * \exception cet::exception if the index is out-of-range
+	 */
+	Fragment::sequence_id_t blockSequenceID(size_t index) const
+	{
+		auto info = block_info_();
+		if (info == nullptr) return blockHeader_(index).sequence_id;
+		check_block_index_(index, "blockSequenceID");
+		return info[1 + block_count() + index];  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	}
+
+	/**
+	 * \brief Gets the Fragment ID of a contained Fragment, without copying (or decompressing) it if the block information is stored
+	 * \param index The Fragment index
+	 * \return The Fragment ID of the specified Fragment
+	 * \exception cet::exception if the index is out-of-range
+	 */
+	Fragment::fragment_id_t blockFragmentID(size_t index) const
+	{
+		auto info = block_info_();
+		if (info == nullptr) return blockHeader_(index).fragment_id;
+		check_block_index_(index, "blockFragmentID");
+		return reinterpret_cast<uint16_t const*>(info + 1 + 2 * block_count())[index];  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	}
+
+	/**
+	 * \brief Find the contained Fragments with timestamps in the range [t0, t1]
+	 * \param t0 Start of the time window
+	 * \param t1 End of the time window (inclusive)
+	 * \return Indices of the contained Fragments with t0 <= timestamp <= t1, in increasing order
+	 *
+	 * If the block information is stored and the timestamps are in order, the window is found by binary search; otherwise
+	 * the timestamps are scanned.
+	 */
+	std::vector<size_t> blocksInTimeRange(Fragment::timestamp_t t0, Fragment::timestamp_t t1) const;
+
+	/**
+	 * \brief Check every entry of the index stored in the ContainerFragment against the word_count of the block it ends
+	 * \return Whether the stored index is present and consistent with the contained Fragment headers
+	 *
+	 * Containers with at least PARALLEL_VALIDATION_THRESHOLD blocks are validated using multiple threads.
+	 */
+	bool validateIndex() const;
+
+	/**
+	 * \brief Fully validate the index stored in the ContainerFragment, using it for this overlay if it is consistent
+	 * \return Whether the stored index is present and consistent with the contained Fragment headers
+	 * \exception cet::exception if the stored index is invalid and cannot be rebuilt
+	 *
+	 * Readers normally only check that the stored index ends with CONTAINER_MAGIC. If the full check fails,
+	 * this overlay instead uses an index rebuilt from the contained Fragment headers.
+	 */
+	bool verifyIndex() const;
+
+	/**
+	 * \brief Clear the process-wide cache of indices rebuilt from the contained Fragment headers
+	 *
+	 * An index rebuilt for a container written without one (or whose index is not terminated by CONTAINER_MAGIC)
+	 * is reused by later overlays over the same buffer, as long as its size, sequence ID, Fragment ID, index_offset
+	 * and block count are unchanged and its first and last contained headers still match the index. Code which
+	 * rewrites contained Fragment headers in place without changing any of these should clear the cache.
+	 */
+	static void ClearIndexCache();
+
 protected:
+	/**
+	 * \brief Gets the number of Fragments described by a Metadata object, taking its version into account
+	 * \param md Metadata to read
+	 * \return The number of Fragment objects in the ContainerFragment
+	 */
+	static size_t block_count_(Metadata const* md)
+	{
+		return md->version >= 2 ? md->block_count | (static_cast<size_t>(md->block_count_high) << 16) : md->block_count;
+	}
+
+	/**
+	 * \brief Gets whether a Metadata object describes a compressed ContainerFragment, taking its version into account
+	 * \param md Metadata to read
+	 * \return Whether the contained Fragments are stored compressed
+	 */
+	static bool compressed_(Metadata const* md)
+	{
+		return md->version >= 2 && md->compressed;
+	}
+
+	/**
+	 * \brief Throw if the ContainerFragment is compressed, for operations which need the contained Fragments in place
+	 * \param function Name of the calling function, for the exception message
+	 * \exception cet::exception if the ContainerFragment is compressed
+	 */
+	void check_uncompressed_(const char* function) const
+	{
+		if (compressed())
+		{
+			throw cet::exception("CompressedContainer") << "ContainerFragment::" << function << " cannot be used on a compressed ContainerFragment, use at() instead!";  // NOLINT(cert-err60-cpp)
+		}
+	}
+
+	/**
+	 * \brief Number of words after the end of the contained Fragments used by the index
+	 * \param md Metadata to read
+	 * \return The number of words in the index
+	 */
+	static size_t index_words_(Metadata const* md)
+	{
+		return compressed_(md) ? 2 * block_count_(md) + 1 : block_count_(md) + 1;
+	}
+
+	/**
+	 * \brief Number of words used by the block information for the given number of Fragments
+	 * \param block_count Number of Fragments
+	 * \return The number of words in the block information
+	 */
+	static constexpr size_t block_info_words_(size_t block_count)
+	{
+		return 1 + 2 * block_count + (block_count * sizeof(uint16_t) + sizeof(RawDataType) - 1) / sizeof(RawDataType);
+	}
+
+	/**
+	 * \brief Get a pointer to the block information which follows the index
+	 * \return Pointer to the block information, or nullptr if it is not present
+	 */
+	RawDataType const* block_info_() const
+	{
+		auto md = metadata();
+		if (md->version < 2 || !md->has_block_info) return nullptr;
+		auto offset = md->index_offset + sizeof(size_t) * index_words_(md);
+		if (offset + sizeof(RawDataType) * block_info_words_(block_count_(md)) > artdaq_Fragment_.dataSizeBytes()) return nullptr;
+		return reinterpret_cast<RawDataType const*>(artdaq_Fragment_.dataBeginBytes() + offset);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	}
+
+	/**
+	 * \brief Throw if a Fragment index is out-of-range
+	 * \param index The Fragment index
+	 * \param function Name of the calling function, for the exception message
+	 * \exception cet::exception if the index is out-of-range
+	 */
+	void check_block_index_(size_t index, const char* function) const
+	{
+		if (index >= block_count())
+		{
+			throw cet::exception("ArgumentOutOfRange") << "Buffer overrun detected! ContainerFragment::" << function << " was asked for a non-existent Fragment!";  // NOLINT(cert-err60-cpp)
+		}
+	}
+
+	/**
+	 * \brief Get the header of a contained Fragment, for containers without block information
+	 * \param index The Fragment index
+	 * \return The header of the specified Fragment, upgraded to the current version
+	 * \exception cet::exception if the index is out-of-range
+	 */
+	detail::RawFragmentHeader blockHeader_(size_t index) const
+	{
+		return compressed() ? at(index)->fragmentHeader() : view(index).header();
+	}
+
+	/**
+	 * \brief Decompress a Fragment from a compressed ContainerFragment
+	 * \param index The Fragment index
+	 * \return Pointer to the decompressed Fragment
+	 * \exception cet::exception if the compressed data is corrupt
+	 */
+	FragmentPtr decompress_(size_t index) const;
+
 	/**
 	 * \brief Gets the ratio between the fundamental data storage type and the representation within the Fragment
 	 * \return The ratio between the fundamental data storage type and the representation within the Fragment
@@ -253,25 +523,40 @@ protected:
 	}
 
 	/**
-	 * \brief Create an index for the currently-contained Fragments
+	 * \brief Create an index for the currently-contained Fragments by walking their headers
 	 * \return Array of block_count size_t words containing index
+	 * \exception cet::exception if the contained Fragment headers do not fit within the payload
 	 */
 	const size_t* create_index_() const
 	{
+		if (compressed())
+		{
+			throw cet::exception("InvalidIndex") << "ContainerFragment::create_index_: The index of a compressed ContainerFragment cannot be rebuilt!";  // NOLINT(cert-err60-cpp)
+		}
 		TLOG(TLVL_DEBUG + 33, "ContainerFragment") << "Creating new index for ContainerFragment";
-		index_ptr_owner_ = std::make_unique<std::vector<size_t>>(metadata()->block_count + 1);
+		auto block_count = this->block_count();
+		auto index = std::make_shared<std::vector<size_t>>(block_count + 1);
 
 		auto current = reinterpret_cast<uint8_t const*>(artdaq_Fragment_.dataBegin());  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
 		size_t offset = 0;
-		for (int ii = 0; ii < metadata()->block_count; ++ii)
+		for (size_t ii = 0; ii < block_count; ++ii)
 		{
+			if (offset + sizeof(detail::RawFragmentHeader::RawDataType) > artdaq_Fragment_.dataSizeBytes())
+			{
+				throw cet::exception("InvalidIndex") << "ContainerFragment::create_index_: Block " << ii << " starts beyond the end of the payload!";  // NOLINT(cert-err60-cpp)
+			}
 			auto this_size = reinterpret_cast<const detail::RawFragmentHeader*>(current)->word_count * sizeof(RawDataType);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+			if (this_size == 0 || offset + this_size > artdaq_Fragment_.dataSizeBytes())
+			{
+				throw cet::exception("InvalidIndex") << "ContainerFragment::create_index_: Block " << ii << " has an invalid size (" << this_size << " bytes)!";  // NOLINT(cert-err60-cpp)
+			}
 			offset += this_size;
-			index_ptr_owner_->at(ii) = offset;
+			index->at(ii) = offset;
 			current += this_size;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
 		}
-		index_ptr_owner_->at(metadata()->block_count) = CONTAINER_MAGIC;
-		return &index_ptr_owner_->at(0);
+		index->at(block_count) = CONTAINER_MAGIC;
+		index_ptr_owner_ = index;
+		return index->data();
 	}
 
 	/**
@@ -280,8 +565,8 @@ protected:
 	void reset_index_ptr_() const
 	{
 		TLOG(TLVL_DEBUG + 33, "ContainerFragment") << "Request to reset index_ptr recieved. has_index=" << metadata()->has_index << ", Check word = " << std::hex
-		                                           << *(reinterpret_cast<size_t const*>(artdaq_Fragment_.dataBeginBytes() + metadata()->index_offset) + metadata()->block_count);    // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
-		if (metadata()->has_index && *(reinterpret_cast<size_t const*>(artdaq_Fragment_.dataBeginBytes() + metadata()->index_offset) + metadata()->block_count) == CONTAINER_MAGIC)  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		                                           << *(reinterpret_cast<size_t const*>(artdaq_Fragment_.dataBeginBytes() + metadata()->index_offset) + block_count());    // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		if (metadata()->has_index && *(reinterpret_cast<size_t const*>(artdaq_Fragment_.dataBeginBytes() + metadata()->index_offset) + block_count()) == CONTAINER_MAGIC)  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
 		{
 			TLOG(TLVL_DEBUG + 33, "ContainerFragment") << "Setting index_ptr to found valid index";
 			index_ptr_ = reinterpret_cast<size_t const*>(artdaq_Fragment_.dataBeginBytes() + metadata()->index_offset);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
@@ -301,11 +586,19 @@ protected:
 	{
 		if (index_ptr_ != nullptr) return index_ptr_;
 
-		reset_index_ptr_();
+		load_index_();
 
 		return index_ptr_;
 	}
 
+	/**
+	 * \brief Find the index for a ContainerFragment being read, rebuilding it from the contained Fragment
+	 * headers if it is missing (e.g. written without one) or not terminated by CONTAINER_MAGIC
+	 *
+	 * Rebuilt indices are kept in a process-wide cache, so that later overlays over the same Fragment reuse them.
+	 */
+	void load_index_() const;
+
 private:
 	ContainerFragment(ContainerFragment const&) = delete;             // ContainerFragments should definitely not be copied
 	ContainerFragment(ContainerFragment&&) = delete;                  // ContainerFragments should not be moved, only the underlying Fragment
@@ -315,7 +608,7 @@ private:
 	Fragment const& artdaq_Fragment_;
 
 	mutable const size_t* index_ptr_;
-	mutable std::unique_ptr<std::vector<size_t>> index_ptr_owner_;
+	mutable std::shared_ptr<std::vector<size_t> const> index_ptr_owner_;
 	mutable std::unique_ptr<Metadata> metadata_;
 };
 
@@ -0,0 +1,69 @@
+#include "artdaq-core/Data/ContainerFragmentLoader.hh"
+
+#include <zlib.h>
+
+#include <vector>
+
+void artdaq::ContainerFragmentLoader::compress(int level)
+{
+	check_uncompressed_("compress");
+
+	auto block_count = this->block_count();
+	std::vector<size_t> ends(block_count);
+	std::vector<size_t> sizes(block_count);
+	std::vector<RawDataType> block_info;
+	auto info = block_info_();
+	if (info != nullptr) block_info.assign(info, info + block_info_words_(block_count));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+
+	size_t bound = 0;
+	for (size_t ii = 0; ii < block_count; ++ii)
+	{
+		sizes[ii] = fragSize(ii);
+		bound += compressBound(sizes[ii]) + sizeof(RawDataType);
+	}
+
+	// One deflate stream is reset between blocks, rather than allocating a new one for each
+	z_stream stream{};
+	auto sts = deflateInit(&stream, level);
+	if (sts != Z_OK)
+	{
+		throw cet::exception("CompressionError") << "ContainerFragmentLoader::compress: Could not initialize zlib (status " << sts << ")";  // NOLINT(cert-err60-cpp)
+	}
+
+	// Each block is padded to a whole RawDataType word so that the index which follows stays aligned
+	std::vector<RawDataType> blocks(bound / sizeof(RawDataType) + 1);
+	auto out = reinterpret_cast<Bytef*>(blocks.data());  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+	size_t offset = 0;
+	for (size_t ii = 0; ii < block_count; ++ii)
+	{
+		deflateReset(&stream);
+		stream.next_in = reinterpret_cast<Bytef*>(dataBegin_() + fragmentIndex(ii));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		stream.avail_in = sizes[ii];
+		stream.next_out = out + offset;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		stream.avail_out = bound - offset;
+		sts = deflate(&stream, Z_FINISH);
+		if (sts != Z_STREAM_END)
+		{
+			deflateEnd(&stream);
+			TLOG(TLVL_ERROR, "ContainerFragmentLoader") << "Error compressing Fragment " << ii << ": zlib status " << sts;
+			throw cet::exception("CompressionError") << "ContainerFragmentLoader::compress: Error compressing Fragment " << ii << " (zlib status " << sts << ")";  // NOLINT(cert-err60-cpp)
+		}
+		offset += (stream.total_out + sizeof(RawDataType) - 1) / sizeof(RawDataType) * sizeof(RawDataType);
+		ends[ii] = offset;
+	}
+	deflateEnd(&stream);
+	TLOG(TLVL_DEBUG + 33, "ContainerFragmentLoader") << "compress: Compressed " << block_count << " Fragments from " << lastFragmentIndex() << " to " << offset << " bytes";
+
+	artdaq_Fragment_.resizeBytes(offset + sizeof(size_t) * (2 * block_count + 1) + sizeof(RawDataType) * block_info.size());
+	memcpy(dataBegin_(), blocks.data(), offset);
+	auto index = reinterpret_cast<size_t*>(dataBegin_() + offset);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	memcpy(index, ends.data(), sizeof(size_t) * block_count);
+	index[block_count] = CONTAINER_MAGIC;                                                             // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	memcpy(index + block_count + 1, sizes.data(), sizeof(size_t) * block_count);                      // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	memcpy(index + 2 * block_count + 1, block_info.data(), sizeof(RawDataType) * block_info.size());  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+
+	metadata()->index_offset = offset;
+	metadata()->compressed = 1;
+	metadata()->has_index = 1;
+	reset_index_ptr_();
+}
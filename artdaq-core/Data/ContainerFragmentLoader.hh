@@ -15,6 +15,7 @@
 
 #include "TRACE/tracemf.h"
 
+#include <algorithm>
 #include <iostream>
 
 namespace artdaq {
@@ -35,6 +36,29 @@ public:
 	 */
 	explicit ContainerFragmentLoader(Fragment& f, Fragment::type_t expectedFragmentType);
 
+	/**
+	 * \brief Constructs the ContainerFragmentLoader, pre-allocating space for the expected contents
+	 * \param f A Fragment object containing a Fragment header.
+	 * \param expectedFragmentType The type of fragment which will be put into this ContainerFragment
+	 * \param total_payload_bytes Total size of the Fragments (including their headers) expected to be added, in bytes
+	 * \param expected_blocks Number of Fragments expected to be added
+	 * \exception cet::exception if the Fragment input has inconsistent Header information
+	 */
+	ContainerFragmentLoader(Fragment& f, Fragment::type_t expectedFragmentType, size_t total_payload_bytes, size_t expected_blocks);
+
+	/**
+	 * \brief Pre-allocate space for Fragments which will be added to the ContainerFragment
+	 * \param total_payload_bytes Total size of the Fragments (including their headers) expected to be added, in bytes
+	 * \param expected_blocks Number of Fragments expected to be added
+	 *
+	 * Allocates capacity for the expected Fragments and for their index in one step, so that adding
+	 * Fragments within the reservation never reallocates the underlying Fragment. The size of the
+	 * Fragment does not change, so an over-estimate costs memory only while the ContainerFragment
+	 * is being filled, and is never stored or sent. Adding more than was reserved falls back to the
+	 * normal growth strategy.
+	 */
+	void reserve(size_t total_payload_bytes, size_t expected_blocks);
+
 	// ReSharper disable once CppMemberFunctionMayBeConst
 	/**
 	 * \brief Get the ContainerFragment metadata (includes information about the location of Fragment objects within the ContainerFragment)
@@ -93,6 +117,15 @@ public:
 	 */
 	void addFragments(artdaq::FragmentPtrs& frags, bool allowDifferentTypes = false);
 
+	/**
+	 * \brief Add a contiguous block of Fragments (header + payload each, laid out back-to-back) to the ContainerFragment
+	 * \param first Pointer to the header of the first Fragment in the block
+	 * \param count Number of Fragments in the block
+	 * \param allowDifferentTypes Whether Fragments with a type different from the ContainerFragment's fragment_type may be added
+	 * \exception cet::exception If a Fragment to be added has a different type than expected
+	 */
+	void addFragments(detail::RawFragmentHeader const* first, size_t count, bool allowDifferentTypes = false);
+
 	/**
 	 * \brief Create a Fragment at the end of the ContainerFragment with the given size
 	 * \prarm nwords Size (in RawDataType words) of the new Fragment
@@ -106,6 +139,24 @@ public:
 	 */
 	void resizeLastFragment(size_t nwords);
 
+	/**
+	 * \brief Store the timestamp, sequence ID and Fragment ID of each contained Fragment after the index
+	 * \exception cet::exception if the ContainerFragment is compressed
+	 *
+	 * Should be called once all Fragments have been added (and before compress()); adding or resizing Fragments
+	 * afterwards removes the stored block information. Enables ContainerFragment::blocksInTimeRange to use binary search.
+	 */
+	void writeBlockInfo();
+
+	/**
+	 * \brief Compress each Fragment in the ContainerFragment independently, so that readers only decompress the Fragments they access
+	 * \param level zlib compression level (1 = fastest, 9 = smallest)
+	 * \exception cet::exception if compression fails
+	 *
+	 * Fragments cannot be added to the ContainerFragment once it has been compressed.
+	 */
+	void compress(int level = 1);
+
 	detail::RawFragmentHeader* lastFragmentHeader() { return reinterpret_cast<detail::RawFragmentHeader*>(dataBegin_() + fragmentIndex(block_count() - 1)); }
 
 private:
@@ -116,6 +167,46 @@ private:
 
 	void addSpace_(size_t bytes);
 
+	// Returns the fragment_type the container will have once a Fragment of the given type is added to a container
+	// of container_type, or throws if that is not allowed. Does not modify the container.
+	static Fragment::type_t checkFragmentType_(Fragment::type_t container_type, Fragment::type_t type, bool allowDifferentTypes);
+
+	// Make room for bytes of new Fragment data and count new index entries, moving the index out of the way
+	// if the new data would overlap it. Returns the address at which the new Fragments should be written.
+	uint8_t* reserveBlocks_(size_t bytes, size_t count);
+
+	// Append index entries for the count Fragments written at the address returned by reserveBlocks_
+	void commitBlocks_(size_t count);
+
+	void set_block_count_(size_t count);
+
+	// Remove the block information written by writeBlockInfo, as the contents of the ContainerFragment are about to change
+	void drop_block_info_();
+
+	// Indices at least this large are moved with slack after the contained Fragments (see reserveBlocks_)
+	static constexpr size_t INDEX_SLACK_THRESHOLD_BYTES = 512;
+
+	// Offset at which to place an index of index_bytes bytes when it has to move past data_end
+	static size_t index_offset_after_(size_t data_end, size_t index_bytes)
+	{
+		return data_end + (index_bytes >= INDEX_SLACK_THRESHOLD_BYTES ? index_bytes : 0);
+	}
+
+	// Move the index (and the magic word which ends it) to new_offset, resizing the payload to end with it. Any gap
+	// between data_end (the end of the contained Fragments, once they are written) and the index is zeroed, so that
+	// no uninitialized memory is stored in the ContainerFragment.
+	void move_index_(size_t new_offset, size_t data_end);
+
+	// The index stored in the payload, which is kept up to date by the loader
+	size_t* stored_index_() { return reinterpret_cast<size_t*>(dataBegin_() + metadata()->index_offset); }  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+
+	// Offset of the end of the contained Fragments. The index starts at or after this offset.
+	size_t data_end_()
+	{
+		auto block_count = this->block_count();
+		return block_count == 0 ? 0 : stored_index_()[block_count - 1];  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	}
+
 	uint8_t* dataBegin_() { return reinterpret_cast<uint8_t*>(&*artdaq_Fragment_.dataBegin()); }  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
 	void* dataEnd_() { return static_cast<void*>(dataBegin_() + lastFragmentIndex()); }           // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
 };
@@ -127,9 +218,12 @@ inline artdaq::ContainerFragmentLoader::ContainerFragmentLoader(artdaq::Fragment
 	artdaq_Fragment_.setSystemType(Fragment::ContainerFragmentType);
 	Metadata m;
 	m.block_count = 0;
+	m.block_count_high = 0;
 	m.fragment_type = expectedFragmentType;
 	m.missing_data = false;
 	m.has_index = true;
+	m.compressed = false;
+	m.has_block_info = false;
 	m.version = ContainerFragment::CURRENT_VERSION;
 	m.index_offset = 0;
 	artdaq_Fragment_.setMetadata<Metadata>(m);
@@ -148,6 +242,26 @@ inline artdaq::ContainerFragmentLoader::ContainerFragmentLoader(artdaq::Fragment
 	*artdaq_Fragment_.dataBegin() = CONTAINER_MAGIC;
 }
 
+inline artdaq::ContainerFragmentLoader::ContainerFragmentLoader(artdaq::Fragment& f, artdaq::Fragment::type_t expectedFragmentType, size_t total_payload_bytes, size_t expected_blocks)
+    : ContainerFragmentLoader(f, expectedFragmentType)
+{
+	reserve(total_payload_bytes, expected_blocks);
+}
+
+inline void artdaq::ContainerFragmentLoader::reserve(size_t total_payload_bytes, size_t expected_blocks)
+{
+	check_uncompressed_("reserve");
+
+	// The index follows the contained Fragments, and may be moved with slack of its own size (see reserveBlocks_)
+	auto index_bytes = sizeof(size_t) * (block_count() + expected_blocks + 1);
+	auto data_end = data_end_() + (total_payload_bytes + sizeof(RawDataType) - 1) / sizeof(RawDataType) * sizeof(RawDataType);
+	auto bytes = std::max(static_cast<size_t>(metadata()->index_offset), index_offset_after_(data_end, index_bytes)) + index_bytes;
+	bytes = std::max(bytes, artdaq_Fragment_.dataSizeBytes());
+	TLOG(TLVL_DEBUG + 33, "ContainerFragmentLoader") << "reserve: Reserving " << bytes << " bytes of payload for " << expected_blocks << " additional Fragments";
+	artdaq_Fragment_.reserve((bytes + sizeof(RawDataType) - 1) / sizeof(RawDataType));
+	reset_index_ptr_();  // Must reset index_ptr after a possible reallocation!
+}
+
 inline size_t artdaq::ContainerFragmentLoader::words_to_frag_words_(size_t nWords)
 {
 	size_t mod = nWords % words_per_frag_word_();
@@ -163,77 +277,167 @@ inline void artdaq::ContainerFragmentLoader::addSpace_(size_t bytes)
 	TLOG(TLVL_DEBUG + 33, "ContainerFragmentLoader") << "addSpace_: dataEnd_ is now at " << static_cast<void*>(dataEnd_()) << " (oldSizeBytes/deltaBytes: " << currSize << "/" << bytes << ")";
 }
 
-inline void artdaq::ContainerFragmentLoader::addFragment(artdaq::Fragment& frag, bool allowDifferentTypes)
+inline artdaq::Fragment::type_t artdaq::ContainerFragmentLoader::checkFragmentType_(Fragment::type_t container_type, Fragment::type_t type, bool allowDifferentTypes)
 {
-	TLOG(TLVL_DEBUG + 33, "ContainerFragmentLoader") << "addFragment: Adding Fragment with payload size " << frag.dataSizeBytes() << " to Container";
-	if (metadata()->fragment_type == Fragment::EmptyFragmentType)
-		metadata()->fragment_type = frag.type();
-	else if (!allowDifferentTypes && frag.type() != metadata()->fragment_type)
+	if (container_type == Fragment::EmptyFragmentType) return type;
+	if (!allowDifferentTypes && type != container_type)
+	{
+		TLOG(TLVL_ERROR, "ContainerFragmentLoader") << "Trying to add a fragment of different type than what's already been added!";
+		throw cet::exception("WrongFragmentType") << "ContainerFragmentLoader: Trying to add a fragment of different type than what's already been added!";  // NOLINT(cert-err60-cpp)
+	}
+	return container_type;
+}
+
+inline uint8_t* artdaq::ContainerFragmentLoader::reserveBlocks_(size_t bytes, size_t count)
+{
+	check_uncompressed_("reserveBlocks_");
+	auto block_count = this->block_count();
+	if (block_count + count > MAX_BLOCK_COUNT)
+	{
+		TLOG(TLVL_ERROR, "ContainerFragmentLoader") << "Trying to add more than " << MAX_BLOCK_COUNT << " Fragments to a ContainerFragment!";
+		throw cet::exception("ContainerFull") << "ContainerFragmentLoader: Trying to add more than " << MAX_BLOCK_COUNT << " Fragments to a ContainerFragment!";  // NOLINT(cert-err60-cpp)
+	}
+	drop_block_info_();
+	auto data_end = data_end_();
+	auto index_bytes = sizeof(size_t) * (block_count + count + 1);
+
+	TLOG(TLVL_DEBUG + 33, "ContainerFragmentLoader") << "reserveBlocks_: Payload Size is " << artdaq_Fragment_.dataSizeBytes() << ", lastFragmentIndex is " << data_end << ", index is at " << metadata()->index_offset << ", and size to add is " << bytes;
+	if (data_end + bytes > metadata()->index_offset)
 	{
-		TLOG(TLVL_ERROR, "ContainerFragmentLoader") << "addFragment: Trying to add a fragment of different type than what's already been added!";
-		throw cet::exception("WrongFragmentType") << "ContainerFragmentLoader::addFragment: Trying to add a fragment of different type than what's already been added!";  // NOLINT(cert-err60-cpp)
+		// Large indices are moved with slack equal to their own size, so that the bytes moved are paid for by the Fragment
+		// data added before the next move and filling a ContainerFragment costs time linear in its size. Small indices are
+		// kept directly after the contained Fragments.
+		move_index_(index_offset_after_(data_end + bytes, index_bytes), data_end + bytes);
 	}
 
-	TLOG(TLVL_DEBUG + 33, "ContainerFragmentLoader") << "addFragment: Payload Size is " << artdaq_Fragment_.dataSizeBytes() << ", lastFragmentIndex is " << lastFragmentIndex() << ", and frag.size is " << frag.sizeBytes();
-	if (artdaq_Fragment_.dataSizeBytes() < (lastFragmentIndex() + frag.sizeBytes() + sizeof(size_t) * (metadata()->block_count + 2)))
+	auto required = metadata()->index_offset + index_bytes;
+	if (artdaq_Fragment_.dataSizeBytes() < required)
 	{
-		addSpace_((lastFragmentIndex() + frag.sizeBytes() + sizeof(size_t) * (metadata()->block_count + 2)) - artdaq_Fragment_.dataSizeBytes());
+		addSpace_(required - artdaq_Fragment_.dataSizeBytes());
 	}
-	// frag.setSequenceID(artdaq_Fragment_.sequenceID());
-	TLOG(TLVL_DEBUG + 33, "ContainerFragmentLoader") << "addFragment, copying " << frag.sizeBytes() << " bytes from " << static_cast<void*>(frag.headerAddress()) << " to " << static_cast<void*>(dataEnd_());
-	memcpy(dataEnd_(), frag.headerAddress(), frag.sizeBytes());
+
 	metadata()->has_index = 0;
+	return dataBegin_() + data_end;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+}
 
-	metadata()->block_count++;
+inline void artdaq::ContainerFragmentLoader::move_index_(size_t new_offset, size_t data_end)
+{
+	auto old_offset = metadata()->index_offset;
+	if (new_offset == old_offset) return;
 
-	auto index = create_index_();
-	metadata()->index_offset = index[metadata()->block_count - 1];                                           // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-	memcpy(dataBegin_() + metadata()->index_offset, index, sizeof(size_t) * (metadata()->block_count + 1));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	auto index_bytes = sizeof(size_t) * index_words_(metadata());
+	TLOG(TLVL_DEBUG + 33, "ContainerFragmentLoader") << "move_index_: Moving " << index_bytes << " bytes of index from offset " << old_offset << " to " << new_offset;
+	if (new_offset + index_bytes > artdaq_Fragment_.dataSizeBytes())
+	{
+		addSpace_(new_offset + index_bytes - artdaq_Fragment_.dataSizeBytes());
+	}
+	memmove(dataBegin_() + new_offset, dataBegin_() + old_offset, index_bytes);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	if (new_offset > data_end)
+	{
+		memset(dataBegin_() + data_end, 0, new_offset - data_end);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	}
+	metadata()->index_offset = new_offset;
+	if (new_offset < old_offset)
+	{
+		artdaq_Fragment_.resizeBytes(new_offset + index_bytes);
+	}
+	reset_index_ptr_();
+}
+
+inline void artdaq::ContainerFragmentLoader::commitBlocks_(size_t count)
+{
+	auto block_count = this->block_count();
+	auto index = stored_index_();
+	size_t offset = data_end_();
+	for (size_t ii = 0; ii < count; ++ii)
+	{
+		offset += reinterpret_cast<detail::RawFragmentHeader const*>(dataBegin_() + offset)->word_count * sizeof(RawDataType);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		index[block_count + ii] = offset;                                                                                    // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	}
+	index[block_count + count] = CONTAINER_MAGIC;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
 
+	set_block_count_(block_count + count);
 	metadata()->has_index = 1;
 	reset_index_ptr_();
 }
 
+inline void artdaq::ContainerFragmentLoader::set_block_count_(size_t count)
+{
+	metadata()->block_count = count & 0xFFFF;
+	metadata()->block_count_high = count >> 16;
+}
+
+inline void artdaq::ContainerFragmentLoader::drop_block_info_()
+{
+	if (!metadata()->has_block_info) return;
+
+	TLOG(TLVL_DEBUG + 33, "ContainerFragmentLoader") << "drop_block_info_: Removing block information, as the ContainerFragment is being modified";
+	metadata()->has_block_info = 0;
+	artdaq_Fragment_.resizeBytes(metadata()->index_offset + sizeof(size_t) * index_words_(metadata()));
+	reset_index_ptr_();
+}
+
+inline void artdaq::ContainerFragmentLoader::writeBlockInfo()
+{
+	check_uncompressed_("writeBlockInfo");
+	auto block_count = this->block_count();
+	auto info_offset = metadata()->index_offset + sizeof(size_t) * index_words_(metadata());
+	artdaq_Fragment_.resizeBytes(info_offset + sizeof(RawDataType) * block_info_words_(block_count));
+
+	auto info = reinterpret_cast<RawDataType*>(dataBegin_() + info_offset);       // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	auto timestamps = info + 1;                                                   // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	auto sequence_ids = timestamps + block_count;                                 // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	auto fragment_ids = reinterpret_cast<uint16_t*>(sequence_ids + block_count);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	memset(fragment_ids, 0, sizeof(RawDataType) * block_info_words_(block_count) - sizeof(RawDataType) * (1 + 2 * block_count));
+
+	reset_index_ptr_();  // Must reset index_ptr after a possible reallocation!
+	bool ordered = true;
+	for (size_t ii = 0; ii < block_count; ++ii)
+	{
+		auto hdr = view(ii).header();
+		timestamps[ii] = hdr.timestamp;                                      // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		sequence_ids[ii] = hdr.sequence_id;                                  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		fragment_ids[ii] = hdr.fragment_id;                                  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		if (ii > 0 && timestamps[ii] < timestamps[ii - 1]) ordered = false;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	}
+	info[0] = ordered ? 1 : 0;
+	metadata()->has_block_info = 1;
+}
+
+inline void artdaq::ContainerFragmentLoader::addFragment(artdaq::Fragment& frag, bool allowDifferentTypes)
+{
+	TLOG(TLVL_DEBUG + 33, "ContainerFragmentLoader") << "addFragment: Adding Fragment with payload size " << frag.dataSizeBytes() << " to Container";
+	auto container_type = checkFragmentType_(metadata()->fragment_type, frag.type(), allowDifferentTypes);
+
+	auto data_ptr = reserveBlocks_(frag.sizeBytes(), 1);
+	metadata()->fragment_type = container_type;
+	TLOG(TLVL_DEBUG + 33, "ContainerFragmentLoader") << "addFragment, copying " << frag.sizeBytes() << " bytes from " << static_cast<void*>(frag.headerAddress()) << " to " << static_cast<void*>(data_ptr);
+	memcpy(data_ptr, frag.headerAddress(), frag.sizeBytes());
+	commitBlocks_(1);
+}
 
 inline void artdaq::ContainerFragmentLoader::addFragments(artdaq::Fragments& frags, bool allowDifferentTypes)
 {
 	TLOG(TLVL_DEBUG + 33, "ContainerFragmentLoader") << "addFragments: Adding " << frags.size() << " Fragments to Container";
+	if (frags.empty()) return;
 
 	size_t total_size = 0;
-	for (auto& frag : frags) { total_size += frag.sizeBytes(); }
-
-	TLOG(TLVL_DEBUG + 33, "ContainerFragmentLoader") << "addFragments: Payload Size is " << artdaq_Fragment_.dataSizeBytes() << ", lastFragmentIndex is " << lastFragmentIndex() << ", and size to add is " << total_size;
-	if (artdaq_Fragment_.dataSizeBytes() < (lastFragmentIndex() + total_size + sizeof(size_t) * (metadata()->block_count + 1 + frags.size())))
+	auto container_type = metadata()->fragment_type;
+	for (auto& frag : frags)
 	{
-		addSpace_((lastFragmentIndex() + total_size + sizeof(size_t) * (metadata()->block_count + 1 + frags.size())) - artdaq_Fragment_.dataSizeBytes());
+		container_type = checkFragmentType_(container_type, frag.type(), allowDifferentTypes);
+		total_size += frag.sizeBytes();
 	}
 
-	auto data_ptr = dataEnd_();
-
+	auto data_ptr = reserveBlocks_(total_size, frags.size());
+	metadata()->fragment_type = container_type;
 	for (auto& frag : frags)
 	{
-		if (metadata()->fragment_type == Fragment::EmptyFragmentType)
-			metadata()->fragment_type = frag.type();
-		else if (!allowDifferentTypes && frag.type() != metadata()->fragment_type)
-		{
-			TLOG(TLVL_ERROR, "ContainerFragmentLoader") << "addFragments: Trying to add a fragment of different type than what's already been added!";
-			throw cet::exception("WrongFragmentType") << "ContainerFragmentLoader::addFragments: Trying to add a fragment of different type than what's already been added!";  // NOLINT(cert-err60-cpp)
-		}
-
-		// frag->setSequenceID(artdaq_Fragment_.sequenceID());
-		TLOG(TLVL_DEBUG + 33, "ContainerFragmentLoader") << "addFragments, copying " << frag.sizeBytes() << " bytes from " << static_cast<void*>(frag.headerAddress()) << " to " << static_cast<void*>(dataEnd_());
+		TLOG(TLVL_DEBUG + 33, "ContainerFragmentLoader") << "addFragments, copying " << frag.sizeBytes() << " bytes from " << static_cast<void*>(frag.headerAddress()) << " to " << static_cast<void*>(data_ptr);
 		memcpy(data_ptr, frag.headerAddress(), frag.sizeBytes());
-		data_ptr = static_cast<uint8_t*>(data_ptr) + frag.sizeBytes();
+		data_ptr += frag.sizeBytes();  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
 	}
-	metadata()->has_index = 0;
-	metadata()->block_count += frags.size();
-
-	auto index = create_index_();
-	metadata()->index_offset = index[metadata()->block_count - 1];                                           // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-	memcpy(dataBegin_() + metadata()->index_offset, index, sizeof(size_t) * (metadata()->block_count + 1));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-
-	metadata()->has_index = 1;
-	reset_index_ptr_();
+	commitBlocks_(frags.size());
 }
 
 inline artdaq::detail::RawFragmentHeader* artdaq::ContainerFragmentLoader::appendFragment(size_t nwords)
@@ -241,12 +445,7 @@ inline artdaq::detail::RawFragmentHeader* artdaq::ContainerFragmentLoader::appen
 	TLOG(TLVL_TRACE, "ContainerFragmentLoader") << "addFragment: Allocating Fragment with payload size " << nwords << " in Container";
 
 	auto fragSizeBytes = (nwords + detail::RawFragmentHeader::num_words()) * sizeof(RawDataType);
-	TLOG(TLVL_TRACE, "ContainerFragmentLoader") << "addFragment: Payload Size is " << artdaq_Fragment_.dataSizeBytes() << ", lastFragmentIndex is " << lastFragmentIndex() << ", and frag.size is "
-	                                            << fragSizeBytes;
-	if (artdaq_Fragment_.dataSizeBytes() < (lastFragmentIndex() + fragSizeBytes + sizeof(size_t) * (metadata()->block_count + 2)))
-	{
-		addSpace_((lastFragmentIndex() + fragSizeBytes + sizeof(size_t) * (metadata()->block_count + 2)) - artdaq_Fragment_.dataSizeBytes());
-	}
+	auto ptr = reserveBlocks_(fragSizeBytes, 1);
 
 	detail::RawFragmentHeader hdr;
 	hdr.sequence_id = artdaq_Fragment_.sequenceID();
@@ -255,41 +454,34 @@ inline artdaq::detail::RawFragmentHeader* artdaq::ContainerFragmentLoader::appen
 	hdr.fragment_id = artdaq_Fragment_.fragmentID();
 	hdr.version = detail::RawFragmentHeader::CurrentVersion;
 
-	auto ptr = dataEnd_();
 	memcpy(ptr, &hdr, sizeof(detail::RawFragmentHeader));
-
-	metadata()->has_index = 0;
-
-	metadata()->block_count++;
-
-	auto index = create_index_();
-	metadata()->index_offset = index[metadata()->block_count - 1];                                           // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-	memcpy(dataBegin_() + metadata()->index_offset, index, sizeof(size_t) * (metadata()->block_count + 1));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-
-	metadata()->has_index = 1;
-	reset_index_ptr_();
+	commitBlocks_(1);
 
 	return lastFragmentHeader();
 }
 
 inline void artdaq::ContainerFragmentLoader::resizeLastFragment(size_t nwords)
 {
-	auto hdr = lastFragmentHeader();
-	auto curFragSize = hdr->word_count - detail::RawFragmentHeader::num_words();
-
-	hdr->word_count = nwords + detail::RawFragmentHeader::num_words();
-	// New size is larger than current
-	if (curFragSize < nwords)
+	check_uncompressed_("resizeLastFragment");
+	drop_block_info_();
+	auto block_count = this->block_count();
+	auto last_offset = fragmentIndex(block_count - 1);
+	auto new_end_offset = last_offset + (nwords + detail::RawFragmentHeader::num_words()) * sizeof(RawDataType);
+
+	// Keep small indices directly after the contained Fragments; large ones only move if the last Fragment grows into them
+	auto index_bytes = sizeof(size_t) * (block_count + 1);
+	if (index_bytes < INDEX_SLACK_THRESHOLD_BYTES || new_end_offset > metadata()->index_offset)
 	{
-		addSpace_((nwords - curFragSize) * sizeof(artdaq::RawDataType));
+		move_index_(index_offset_after_(new_end_offset, index_bytes), new_end_offset);
+	}
+	else if (new_end_offset < data_end_())
+	{
+		// The index stays put, so clear what the last Fragment no longer covers
+		memset(dataBegin_() + new_end_offset, 0, data_end_() - new_end_offset);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
 	}
-	metadata()->has_index = 0;
-
-	auto index = create_index_();
-	metadata()->index_offset = index[metadata()->block_count - 1];                                           // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-	memcpy(dataBegin_() + metadata()->index_offset, index, sizeof(size_t) * (metadata()->block_count + 1));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
 
-	metadata()->has_index = 1;
+	reinterpret_cast<detail::RawFragmentHeader*>(dataBegin_() + last_offset)->word_count = nwords + detail::RawFragmentHeader::num_words();  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	stored_index_()[block_count - 1] = new_end_offset;                                                                                       // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
 	reset_index_ptr_();
 }
 
@@ -301,42 +493,47 @@ inline void artdaq::ContainerFragmentLoader::addFragment(artdaq::FragmentPtr& fr
 inline void artdaq::ContainerFragmentLoader::addFragments(artdaq::FragmentPtrs& frags, bool allowDifferentTypes)
 {
 	TLOG(TLVL_DEBUG + 33, "ContainerFragmentLoader") << "addFragments: Adding " << frags.size() << " Fragments to Container";
+	if (frags.empty()) return;
 
 	size_t total_size = 0;
-	for (auto& frag : frags) { total_size += frag->sizeBytes(); }
-
-	TLOG(TLVL_DEBUG + 33, "ContainerFragmentLoader") << "addFragments: Payload Size is " << artdaq_Fragment_.dataSizeBytes() << ", lastFragmentIndex is " << lastFragmentIndex() << ", and size to add is " << total_size;
-	if (artdaq_Fragment_.dataSizeBytes() < (lastFragmentIndex() + total_size + sizeof(size_t) * (metadata()->block_count + 1 + frags.size())))
+	auto container_type = metadata()->fragment_type;
+	for (auto& frag : frags)
 	{
-		addSpace_((lastFragmentIndex() + total_size + sizeof(size_t) * (metadata()->block_count + 1 + frags.size())) - artdaq_Fragment_.dataSizeBytes());
+		container_type = checkFragmentType_(container_type, frag->type(), allowDifferentTypes);
+		total_size += frag->sizeBytes();
 	}
 
-	auto data_ptr = dataEnd_();
-
+	auto data_ptr = reserveBlocks_(total_size, frags.size());
+	metadata()->fragment_type = container_type;
 	for (auto& frag : frags)
 	{
-		if (metadata()->fragment_type == Fragment::EmptyFragmentType)
-			metadata()->fragment_type = frag->type();
-		else if (!allowDifferentTypes && frag->type() != metadata()->fragment_type)
-		{
-			TLOG(TLVL_ERROR, "ContainerFragmentLoader") << "addFragments: Trying to add a fragment of different type than what's already been added!";
-			throw cet::exception("WrongFragmentType") << "ContainerFragmentLoader::addFragments: Trying to add a fragment of different type than what's already been added!";  // NOLINT(cert-err60-cpp)
-		}
-
-		// frag->setSequenceID(artdaq_Fragment_.sequenceID());
-		TLOG(TLVL_DEBUG + 33, "ContainerFragmentLoader") << "addFragments, copying " << frag->sizeBytes() << " bytes from " << static_cast<void*>(frag->headerAddress()) << " to " << static_cast<void*>(dataEnd_());
+		TLOG(TLVL_DEBUG + 33, "ContainerFragmentLoader") << "addFragments, copying " << frag->sizeBytes() << " bytes from " << static_cast<void*>(frag->headerAddress()) << " to " << static_cast<void*>(data_ptr);
 		memcpy(data_ptr, frag->headerAddress(), frag->sizeBytes());
-		data_ptr = static_cast<uint8_t*>(data_ptr) + frag->sizeBytes();
+		data_ptr += frag->sizeBytes();  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
 	}
-	metadata()->has_index = 0;
-	metadata()->block_count += frags.size();
+	commitBlocks_(frags.size());
+}
 
-	auto index = create_index_();
-	metadata()->index_offset = index[metadata()->block_count - 1];                                           // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-	memcpy(dataBegin_() + metadata()->index_offset, index, sizeof(size_t) * (metadata()->block_count + 1));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+inline void artdaq::ContainerFragmentLoader::addFragments(artdaq::detail::RawFragmentHeader const* first, size_t count, bool allowDifferentTypes)
+{
+	TLOG(TLVL_DEBUG + 33, "ContainerFragmentLoader") << "addFragments: Adding block of " << count << " Fragments to Container";
+	if (count == 0) return;
 
-	metadata()->has_index = 1;
-	reset_index_ptr_();
+	auto block_begin = reinterpret_cast<uint8_t const*>(first);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+	size_t total_size = 0;
+	auto container_type = metadata()->fragment_type;
+	for (size_t ii = 0; ii < count; ++ii)
+	{
+		auto hdr = reinterpret_cast<detail::RawFragmentHeader const*>(block_begin + total_size);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		container_type = checkFragmentType_(container_type, hdr->type, allowDifferentTypes);
+		total_size += hdr->word_count * sizeof(RawDataType);
+	}
+
+	auto data_ptr = reserveBlocks_(total_size, count);
+	metadata()->fragment_type = container_type;
+	TLOG(TLVL_DEBUG + 33, "ContainerFragmentLoader") << "addFragments, copying " << total_size << " bytes from " << static_cast<void const*>(first) << " to " << static_cast<void*>(data_ptr);
+	memcpy(data_ptr, first, total_size);
+	commitBlocks_(count);
 }
 
 #endif /* artdaq_core_Data_ContainerFragmentLoader_hh */
@@ -1,7 +1,11 @@
 #include "artdaq-core/Data/Fragment.hh"
 
+#include <array>
+#include <atomic>
 #include <cmath>
 #include <iostream>
+#include <list>
+#include <mutex>
 
 using artdaq::detail::RawFragmentHeader;
 
@@ -10,6 +14,60 @@ bool artdaq::fragmentSequenceIDCompare(const Fragment& i, const Fragment& j)
 	return i.sequenceID() < j.sequenceID();
 }
 
+namespace {
+// Registered user type names. Lookups are a single atomic load; the strings themselves are
+// kept in user_type_name_storage(), and are never freed, so that pointers handed out stay valid.
+std::array<std::atomic<char const*>, 256> user_type_names;
+std::mutex user_type_name_mutex;
+
+// Function-local so that types can be registered from static initializers in other libraries
+std::list<std::string>& user_type_name_storage()
+{
+	static std::list<std::string> storage;
+	return storage;
+}
+}  // namespace
+
+size_t artdaq::upgradeAll(Fragments& frags)
+{
+	size_t upgraded = 0;
+	for (auto& frag : frags)
+	{
+		if (frag.upgradeHeader()) { ++upgraded; }
+	}
+	return upgraded;
+}
+
+size_t artdaq::upgradeAll(FragmentPtrs& frags)
+{
+	size_t upgraded = 0;
+	for (auto& frag : frags)
+	{
+		if (frag->upgradeHeader()) { ++upgraded; }
+	}
+	return upgraded;
+}
+
+void artdaq::touchAll(Fragments& frags)
+{
+	if (TimeUtils::getAccessTimeClock() == TimeUtils::AccessTimeClock::Disabled) return;
+	auto time = TimeUtils::get_access_time();
+	for (auto& frag : frags)
+	{
+		frag.touch(time);
+	}
+}
+
+void artdaq::touchAll(FragmentPtrs& frags)
+{
+	if (TimeUtils::getAccessTimeClock() == TimeUtils::AccessTimeClock::Disabled) return;
+	auto time = TimeUtils::get_access_time();
+	for (auto& frag : frags)
+	{
+		frag->touch(time);
+	}
+}
+
 artdaq::Fragment::Fragment()
     : vals_(RawFragmentHeader::num_words(), -1)
 {
@@ -73,6 +131,27 @@ void artdaq::Fragment::print(std::ostream& os) const
 	   << '\n';
 }
 
+void artdaq::Fragment::RegisterUserTypeName(type_t type, std::string const& name)
+{
+	if (!isUserFragmentType(type))
+	{
+		throw cet::exception("InvalidValue")  // NOLINT(cert-err60-cpp)
+		    << "Only user types (" << static_cast<int>(RawFragmentHeader::FIRST_USER_TYPE) << " to "
+		    << static_cast<int>(RawFragmentHeader::LAST_USER_TYPE) << ") can be given a name (bad type is "
+		    << static_cast<int>(type) << ").";
+	}
+	std::lock_guard<std::mutex> lk(user_type_name_mutex);
+	auto& storage = user_type_name_storage();
+	storage.push_back(name);
+	user_type_names[type].store(storage.back().c_str(), std::memory_order_release);
+}
+
+char const* artdaq::Fragment::TypeName(type_t type)
+{
+	if (isSystemFragmentType(type)) return RawFragmentHeader::SystemTypeName(type);
+	return user_type_names[type].load(std::memory_order_acquire);
+}
+
 artdaq::FragmentPtr
 artdaq::Fragment::eodFrag(size_t nFragsToExpect)
 {
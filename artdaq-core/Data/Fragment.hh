@@ -66,6 +66,22 @@ typedef std::list<FragmentPtr> FragmentPtrs;
  */
 bool fragmentSequenceIDCompare(const Fragment& i, const Fragment& j);
 
+/**
+ * \brief Inlinable comparator for Fragment objects, based on their sequence_id
+ *
+ * Equivalent to fragmentSequenceIDCompare, but lets std::sort and similar algorithms inline the comparison.
+ */
+struct FragmentSequenceIDLess
+{
+	/**
+	 * \brief Compare two Fragments by sequence ID
+	 * \param i First Fragment to compare
+	 * \param j Second Fragment to compare
+	 * \return i.sequenceID() < j.sequenceID()
+	 */
+	inline bool operator()(const Fragment& i, const Fragment& j) const;
+};
+
 /**
  * \brief Prints the given Fragment to the stream
  * \param os Stream to print Fragment to
@@ -73,6 +89,37 @@ bool fragmentSequenceIDCompare(const Fragment& i, const Fragment& j);
  * \return Reference to the stream
  */
 std::ostream& operator<<(std::ostream& os, Fragment const& f);
+
+/**
+ * \brief Upgrade the headers of all given Fragments to RawFragmentHeader::CurrentVersion, in place
+ * \param frags Fragments to upgrade
+ * \return The number of Fragments whose headers were rewritten
+ * \exception cet::exception if any Fragment has an unknown header version
+ *
+ * Intended to be run once over Fragments read from older data, so that subsequent
+ * header accesses operate directly on the current-version header.
+ */
+size_t upgradeAll(Fragments& frags);
+
+/**
+ * \brief Upgrade the headers of all given Fragments to RawFragmentHeader::CurrentVersion, in place
+ * \param frags FragmentPtrs to upgrade
+ * \return The number of Fragments whose headers were rewritten
+ * \exception cet::exception if any Fragment has an unknown header version
+ */
+size_t upgradeAll(FragmentPtrs& frags);
+
+/**
+ * \brief Set the access time of all given Fragments using a single read of the access-time clock
+ * \param frags Fragments to touch
+ */
+void touchAll(Fragments& frags);
+
+/**
+ * \brief Set the access time of all given Fragments using a single read of the access-time clock
+ * \param frags FragmentPtrs to touch
+ */
+void touchAll(FragmentPtrs& frags);
 }  // namespace artdaq
 
 /**
@@ -179,6 +226,21 @@ public:
 		return detail::RawFragmentHeader::MakeSystemTypeMap();
 	}
 
+	/**
+	 * \brief Register a name for a user type, which will be used by typeString() and TypeName()
+	 * \param type The user type to name
+	 * \param name Name of the type. Re-registering a type replaces its name.
+	 * \exception cet::exception if type is not a user type
+	 */
+	static void RegisterUserTypeName(type_t type, std::string const& name);
+
+	/**
+	 * \brief Look up the name of a type, without allocating
+	 * \param type Type to look up
+	 * \return The name of the system type, or the registered name of the user type, or nullptr if the type has no name
+	 */
+	static char const* TypeName(type_t type);
+
 	typedef DATAVEC_T::reference reference;              ///< Alias reference type from QuickVec<RawDataType>
 	typedef DATAVEC_T::iterator iterator;                ///< Alias iterator type from QuickVec<RawDataType>
 	typedef DATAVEC_T::const_iterator const_iterator;    ///< Alias const_iterator type from QuickVec<RawDataType>
@@ -283,7 +345,7 @@ public:
 
 	/**
 	 * \brief Print the type of the Fragment
-	 * \return String representation of the Fragment type. For system types, the name will be included in parentheses
+	 * \return String representation of the Fragment type. For system types, and user types with a registered name, the name will be included in parentheses
 	 */
 	std::string typeString() const;
 
@@ -340,6 +402,12 @@ public:
 	 */
 	void touch();
 
+	/**
+	 * \brief Set the access time of the Fragment to the given time
+	 * \param time Access time to record
+	 */
+	void touch(struct timespec const& time);
+
 	/**
 	 * \brief Get the last access time of the Fragment
 	 * \return struct timespec with last access time of the Fragment
@@ -741,10 +809,17 @@ public:
 	 */
 	detail::RawFragmentHeader const fragmentHeader() const;
 
-	~Fragment()
-	{
-		if (upgraded_header_ != nullptr) delete upgraded_header_;
-	}
+	/**
+	 * \brief Rewrite an older-version header as a current-version RawFragmentHeader, in place
+	 * \return Whether the header was rewritten (false if it was already current, or is InvalidVersion)
+	 * \exception cet::exception if the header has an unknown version
+	 *
+	 * The metadata and payload are shifted once to make room for the larger header, so
+	 * iterators and pointers into this Fragment are invalidated if this returns true.
+	 * Non-const operations which modify the header perform this upgrade automatically;
+	 * const accessors decode older headers on each call without modifying the Fragment.
+	 */
+	bool upgradeHeader();
 #endif
 
 private:
@@ -757,9 +832,22 @@ private:
 
 #if HIDE_FROM_ROOT
 
-	mutable detail::RawFragmentHeader* upgraded_header_{nullptr};
+	detail::RawFragmentHeader* fragmentHeaderPtr();
 
-	detail::RawFragmentHeader* fragmentHeaderPtr() const;
+	/**
+	 * \brief Get the header stored in vals_, if (and only if) it is a current-version header
+	 * \return Pointer to the in-place header, or nullptr if the header must be decoded via fragmentHeader()
+	 *
+	 * This is the fast path for header accessors: Fragments created by this class, or
+	 * normalized by upgradeHeader(), only pay a single well-predicted comparison per access.
+	 */
+	detail::RawFragmentHeader const* currentHeaderPtr_() const;
+
+	/**
+	 * \brief Get the metadata word count from the header, using the current-version fast path when possible
+	 * \return Number of RawDataType words of metadata in this Fragment
+	 */
+	std::size_t metadataWordCount_() const;
 
 #endif
 };
@@ -768,22 +856,19 @@ private:
 
 // http://stackoverflow.com/questions/33939687
 // This should generate an exception if artdaq::Fragment is not move-constructible
-inline artdaq::Fragment::Fragment(artdaq::Fragment&& of) noexcept  : vals_(std::move(of.vals_)), upgraded_header_(of.upgraded_header_) {
-	of.upgraded_header_ = nullptr;
-}
+inline artdaq::Fragment::Fragment(artdaq::Fragment&& of) noexcept
+    : vals_(std::move(of.vals_)) {}
 inline artdaq::Fragment& artdaq::Fragment::operator=(artdaq::Fragment&& of) noexcept
 {
 	vals_ = std::move(of.vals_);
-	upgraded_header_ = of.upgraded_header_;
-	of.upgraded_header_ = nullptr;
 	return *this;
 }
 
-
-inline artdaq::Fragment::Fragment(const artdaq::Fragment& f) : vals_(f.vals_), upgraded_header_(nullptr) {}
-inline artdaq::Fragment& artdaq::Fragment::operator=(const artdaq::Fragment& f) {
+inline artdaq::Fragment::Fragment(const artdaq::Fragment& f)
+    : vals_(f.vals_) {}
+inline artdaq::Fragment& artdaq::Fragment::operator=(const artdaq::Fragment& f)
+{
 	vals_ = f.vals_;
-	upgraded_header_ = nullptr;
 	return *this;
 }
 
@@ -862,7 +947,8 @@ artdaq::Fragment::
 inline std::size_t
 artdaq::Fragment::size() const
 {
-	return fragmentHeader().word_count;
+	auto hdr = currentHeaderPtr_();
+	return hdr != nullptr ? hdr->word_count : fragmentHeader().word_count;
 }
 
 inline artdaq::Fragment::version_t
@@ -875,31 +961,42 @@ artdaq::Fragment::version() const
 inline artdaq::Fragment::type_t
 artdaq::Fragment::type() const
 {
-	return static_cast<type_t>(fragmentHeader().type);
+	auto hdr = currentHeaderPtr_();
+	return static_cast<type_t>(hdr != nullptr ? hdr->type : fragmentHeader().type);
 }
 
 inline std::string
 artdaq::Fragment::typeString() const
 {
-	return std::to_string(type()) + (isSystemFragmentType(type()) ? " (" + detail::RawFragmentHeader::SystemTypeToString(type()) + ")" : "");
+	auto fragType = type();
+	if (isSystemFragmentType(fragType))
+	{
+		auto name = detail::RawFragmentHeader::SystemTypeName(fragType);
+		return std::to_string(fragType) + " (" + (name != nullptr ? name : "Unknown") + ")";
+	}
+	auto name = isUserFragmentType(fragType) ? TypeName(fragType) : nullptr;
+	return name != nullptr ? std::to_string(fragType) + " (" + name + ")" : std::to_string(fragType);
 }
 
 inline artdaq::Fragment::sequence_id_t
 artdaq::Fragment::sequenceID() const
 {
-	return fragmentHeader().sequence_id;
+	auto hdr = currentHeaderPtr_();
+	return hdr != nullptr ? hdr->sequence_id : fragmentHeader().sequence_id;
 }
 
 inline artdaq::Fragment::fragment_id_t
 artdaq::Fragment::fragmentID() const
 {
-	return fragmentHeader().fragment_id;
+	auto hdr = currentHeaderPtr_();
+	return hdr != nullptr ? hdr->fragment_id : fragmentHeader().fragment_id;
 }
 
 inline artdaq::Fragment::timestamp_t
 artdaq::Fragment::timestamp() const
 {
-	return fragmentHeader().timestamp;
+	auto hdr = currentHeaderPtr_();
+	return hdr != nullptr ? hdr->timestamp : fragmentHeader().timestamp;
 }
 
 inline void
@@ -938,6 +1035,11 @@ inline void artdaq::Fragment::touch()
 	fragmentHeaderPtr()->touch();
 }
 
+inline void artdaq::Fragment::touch(struct timespec const& time)
+{
+	fragmentHeaderPtr()->touch(time);
+}
+
 inline struct timespec artdaq::Fragment::atime() const
 {
 	return fragmentHeader().atime();
@@ -962,19 +1064,19 @@ inline std::size_t
 artdaq::Fragment::dataSize() const
 {
 	return vals_.size() - headerSizeWords() -
-	       fragmentHeader().metadata_word_count;
+	       metadataWordCount_();
 }
 
 inline bool
 artdaq::Fragment::hasMetadata() const
 {
-	return fragmentHeader().metadata_word_count != 0;
+	return metadataWordCount_() != 0;
 }
 
 template<class T>
 T* artdaq::Fragment::metadata()
 {
-	if (fragmentHeader().metadata_word_count == 0)
+	if (metadataWordCount_() == 0)
 	{
 		throw cet::exception("InvalidRequest")  // NOLINT(cert-err60-cpp)
 		    << "No metadata has been stored in this Fragment.";
@@ -987,7 +1089,7 @@ template<class T>
 T const*
 artdaq::Fragment::metadata() const
 {
-	if (fragmentHeader().metadata_word_count == 0)
+	if (metadataWordCount_() == 0)
 	{
 		throw cet::exception("InvalidRequest")  // NOLINT(cert-err60-cpp)
 		    << "No metadata has been stored in this Fragment.";
@@ -998,7 +1100,7 @@ artdaq::Fragment::metadata() const
 template<class T>
 void artdaq::Fragment::setMetadata(const T& metadata)
 {
-	if (fragmentHeader().metadata_word_count != 0)
+	if (metadataWordCount_() != 0)
 	{
 		throw cet::exception("InvalidRequest")  // NOLINT(cert-err60-cpp)
 		    << "Metadata has already been stored in this Fragment.";
@@ -1014,7 +1116,7 @@ void artdaq::Fragment::setMetadata(const T& metadata)
 template<class T>
 void artdaq::Fragment::updateMetadata(const T& metadata)
 {
-	if (fragmentHeader().metadata_word_count == 0)
+	if (metadataWordCount_() == 0)
 	{
 		throw cet::exception("InvalidRequest")  // NOLINT(cert-err60-cpp)
 		    << "No metadata in fragment; please use Fragment::setMetadata instead of Fragment::updateMetadata";
@@ -1022,7 +1124,7 @@ void artdaq::Fragment::updateMetadata(const T& metadata)
 
 	auto const mdSize = validatedMetadataSize_<T>();
 
-	if (fragmentHeader().metadata_word_count != mdSize)
+	if (metadataWordCount_() != mdSize)
 	{
 		throw cet::exception("InvalidRequest")  // NOLINT(cert-err60-cpp)
 		    << "Mismatch between type of metadata struct passed to updateMetadata and existing metadata struct";
@@ -1034,17 +1136,17 @@ void artdaq::Fragment::updateMetadata(const T& metadata)
 inline void
 artdaq::Fragment::resize(std::size_t sz)
 {
-	vals_.resize(sz + fragmentHeaderPtr()->metadata_word_count +
-	             headerSizeWords());
+	// Upgrading an old-format header changes headerSizeWords(), so it must happen first
+	auto metadata_words = fragmentHeaderPtr()->metadata_word_count;
+	vals_.resize(sz + metadata_words + headerSizeWords());
 	updateFragmentHeaderWC_();
 }
 
 inline void
 artdaq::Fragment::resize(std::size_t sz, RawDataType v)
 {
-	vals_.resize(sz + fragmentHeaderPtr()->metadata_word_count +
-	                 headerSizeWords(),
-	             v);
+	auto metadata_words = fragmentHeaderPtr()->metadata_word_count;
+	vals_.resize(sz + metadata_words + headerSizeWords(), v);
 	updateFragmentHeaderWC_();
 }
 
@@ -1059,9 +1161,8 @@ inline void
 artdaq::Fragment::resizeBytesWithCushion(std::size_t szbytes, double growthFactor)
 {
 	RawDataType nwords = ceil(szbytes / static_cast<double>(sizeof(RawDataType)));
-	vals_.resizeWithCushion(nwords + fragmentHeaderPtr()->metadata_word_count +
-	                            headerSizeWords(),
-	                        growthFactor);
+	auto metadata_words = fragmentHeaderPtr()->metadata_word_count;
+	vals_.resizeWithCushion(nwords + metadata_words + headerSizeWords(), growthFactor);
 	updateFragmentHeaderWC_();
 }
 
@@ -1093,7 +1194,7 @@ inline artdaq::Fragment::iterator
 artdaq::Fragment::dataBegin()
 {
 	return vals_.begin() + headerSizeWords() +
-	       fragmentHeader().metadata_word_count;
+	       metadataWordCount_();
 }
 
 inline artdaq::Fragment::iterator
@@ -1112,7 +1213,7 @@ inline artdaq::Fragment::const_iterator
 artdaq::Fragment::dataBegin() const
 {
 	return vals_.begin() + headerSizeWords() +
-	       fragmentHeader().metadata_word_count;
+	       metadataWordCount_();
 }
 
 inline artdaq::Fragment::const_iterator
@@ -1138,14 +1239,14 @@ inline bool
 artdaq::Fragment::empty()
 {
 	return (vals_.size() - headerSizeWords() -
-	        fragmentHeader().metadata_word_count) == 0;
+	        metadataWordCount_()) == 0;
 }
 
 inline void
 artdaq::Fragment::reserve(std::size_t cap)
 {
 	vals_.reserve(cap + headerSizeWords() +
-	              fragmentHeader().metadata_word_count);
+	              metadataWordCount_());
 }
 
 inline void
@@ -1158,13 +1259,13 @@ inline artdaq::RawDataType*
 artdaq::Fragment::dataAddress()
 {
 	return &vals_[0] + headerSizeWords() +  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-	       fragmentHeader().metadata_word_count;
+	       metadataWordCount_();
 }
 
 inline artdaq::RawDataType*
 artdaq::Fragment::metadataAddress()
 {
-	if (fragmentHeader().metadata_word_count == 0)
+	if (metadataWordCount_() == 0)
 	{
 		throw cet::exception("InvalidRequest")  // NOLINT(cert-err60-cpp)
 		    << "No metadata has been stored in this Fragment.";
@@ -1178,9 +1279,27 @@ artdaq::Fragment::headerAddress()
 	return &vals_[0];
 }
 
+inline artdaq::detail::RawFragmentHeader const*
+artdaq::Fragment::currentHeaderPtr_() const
+{
+	// Skip reinterpret_cast_checked here: this is called for every header access, and the
+	// same cast is verified by fragmentHeader() and the test suite.
+	auto hdr = reinterpret_cast<detail::RawFragmentHeader const*>(&vals_[0]);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+	return __builtin_expect(hdr->version == detail::RawFragmentHeader::CurrentVersion, 1) ? hdr : nullptr;
+}
+
+inline std::size_t
+artdaq::Fragment::metadataWordCount_() const
+{
+	auto hdr = currentHeaderPtr_();
+	return hdr != nullptr ? hdr->metadata_word_count : fragmentHeader().metadata_word_count;
+}
+
 inline size_t
 artdaq::Fragment::headerSizeWords() const
 {
+	if (currentHeaderPtr_() != nullptr) return detail::RawFragmentHeader::num_words();
+
 	auto hdr = reinterpret_cast_checked<detail::RawFragmentHeader const*>(&vals_[0]);
 	if (hdr->version != detail::RawFragmentHeader::CurrentVersion)
 	{
@@ -1207,10 +1326,54 @@ artdaq::Fragment::headerSizeWords() const
 	return hdr->num_words();
 }
 
+inline bool
+artdaq::Fragment::upgradeHeader()
+{
+	auto hdr = reinterpret_cast_checked<detail::RawFragmentHeader*>(&vals_[0]);
+	if (hdr->version == detail::RawFragmentHeader::CurrentVersion) return false;
+
+	detail::RawFragmentHeader upgraded;
+	size_t old_words = 0;
+	switch (hdr->version)
+	{
+		case 0xFFFF:
+			TLOG(51, "Fragment") << "Not upgrading InvalidVersion Fragment";
+			return false;
+		case 0: {
+			TLOG(52, "Fragment") << "Upgrading RawFragmentHeaderV0 in place";
+			upgraded = reinterpret_cast_checked<detail::RawFragmentHeaderV0*>(&vals_[0])->upgrade();
+			old_words = detail::RawFragmentHeaderV0::num_words();
+			break;
+		}
+		case 1: {
+			TLOG(52, "Fragment") << "Upgrading RawFragmentHeaderV1 in place";
+			upgraded = reinterpret_cast_checked<detail::RawFragmentHeaderV1*>(&vals_[0])->upgrade();
+			old_words = detail::RawFragmentHeaderV1::num_words();
+			break;
+		}
+		default:
+			throw cet::exception("Fragment") << "A Fragment with an unknown version (" << std::to_string(hdr->version) << ") was received!";  // NOLINT(cert-err60-cpp)
+	}
+
+	// Headers may only grow between versions (see RawFragmentHeaderV1::upgrade), so the
+	// metadata and payload are moved back by the difference, once.
+	auto extra_words = detail::RawFragmentHeader::num_words() - old_words;
+	vals_.insert(vals_.begin() + old_words, extra_words, 0);
+	upgraded.word_count = upgraded.word_count + extra_words;
+	memcpy(&vals_[0], &upgraded, sizeof(upgraded));
+	return true;
+}
+
 inline artdaq::detail::RawFragmentHeader*
-artdaq::Fragment::fragmentHeaderPtr() const
+artdaq::Fragment::fragmentHeaderPtr()
+{
+	upgradeHeader();
+	return reinterpret_cast_checked<detail::RawFragmentHeader*>(&vals_[0]);
+}
+
+inline artdaq::detail::RawFragmentHeader const
+artdaq::Fragment::fragmentHeader() const
 {
-	if (upgraded_header_ != nullptr) return upgraded_header_;
 	auto hdr = reinterpret_cast_checked<detail::RawFragmentHeader const*>(&vals_[0]);
 	if (hdr->version != detail::RawFragmentHeader::CurrentVersion)
 	{
@@ -1220,31 +1383,25 @@ artdaq::Fragment::fragmentHeaderPtr() const
 				TLOG(51, "Fragment") << "Not upgrading InvalidVersion Fragment";
 				break;
 			case 0: {
-				TLOG(52, "Fragment") << "Upgrading RawFragmentHeaderV0 (non const)";
-				auto old_hdr = reinterpret_cast_checked<detail::RawFragmentHeaderV0 const*>(&vals_[0]);
-				upgraded_header_ = new detail::RawFragmentHeader(old_hdr->upgrade());
-				return upgraded_header_;
-				break;
+				TLOG(52, "Fragment") << "Upgrading RawFragmentHeaderV0 (const)";
+				return reinterpret_cast_checked<detail::RawFragmentHeaderV0 const*>(&vals_[0])->upgrade();
 			}
 			case 1: {
-				TLOG(52, "Fragment") << "Upgrading RawFragmentHeaderV1 (non const)";
-				auto old_hdr = reinterpret_cast_checked<detail::RawFragmentHeaderV1 const*>(&vals_[0]);
-				upgraded_header_ = new detail::RawFragmentHeader(old_hdr->upgrade());
-				return upgraded_header_;
-				break;
+				TLOG(52, "Fragment") << "Upgrading RawFragmentHeaderV1 (const)";
+				return reinterpret_cast_checked<detail::RawFragmentHeaderV1 const*>(&vals_[0])->upgrade();
 			}
 			default:
 				throw cet::exception("Fragment") << "A Fragment with an unknown version (" << std::to_string(hdr->version) << ") was received!";  // NOLINT(cert-err60-cpp)
 				break;
 		}
 	}
-	return const_cast<detail::RawFragmentHeader*>(hdr);
+	return *hdr;
 }
 
-inline artdaq::detail::RawFragmentHeader const
-artdaq::Fragment::fragmentHeader() const
+inline bool
+artdaq::FragmentSequenceIDLess::operator()(const Fragment& i, const Fragment& j) const
 {
-	return *fragmentHeaderPtr();
+	return i.sequenceID() < j.sequenceID();
 }
 
 inline void
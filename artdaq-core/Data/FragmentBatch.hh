@@ -0,0 +1,257 @@
+#ifndef artdaq_core_Data_FragmentBatch_hh
+#define artdaq_core_Data_FragmentBatch_hh
+
+////////////////////////////////////////////////////////////////////////
+// FragmentBatch
+//
+// Many Fragments laid out back-to-back (header + metadata + payload
+// each) in a single contiguous buffer, in the same layout used for the
+// payload of a ContainerFragment. Intended for FragmentGenerators which
+// produce large numbers of small Fragments per call, so that they do not
+// need to allocate one Fragment (and one buffer) per datum.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "artdaq-core/Data/ContainerFragmentLoader.hh"
+#include "artdaq-core/Data/Fragment.hh"
+#include "artdaq-core/Data/FragmentView.hh"
+
+#include "cetlib_except/exception.h"
+
+#include <vector>
+
+namespace artdaq {
+class FragmentBatch;
+}
+
+/**
+ * \brief A set of Fragments stored back-to-back in one contiguous buffer
+ *
+ * Each entry in the FragmentBatch is a current-version RawFragmentHeader followed by its
+ * metadata and payload, exactly as it would appear in a Fragment or in the payload of a
+ * ContainerFragment. Entries are accessed through lightweight FragmentView objects,
+ * and are only copied into Fragment objects or a ContainerFragment when requested.
+ */
+class artdaq::FragmentBatch
+{
+public:
+	typedef FragmentView View;                   ///< Read-only view of a single Fragment in the FragmentBatch. Invalidated by any operation which appends to or clears the FragmentBatch.
+	typedef FragmentViewIterator const_iterator;  ///< Forward iterator over the Fragments in the FragmentBatch, yielding View objects
+
+	/**
+	 * \brief Construct a FragmentBatch, optionally pre-allocating space
+	 * \param expected_fragments Number of Fragments to reserve index space for
+	 * \param expected_words Total size (headers + metadata + payloads) to reserve, in RawDataType words
+	 */
+	explicit FragmentBatch(std::size_t expected_fragments = 0, std::size_t expected_words = 0)
+	{
+		reserve(expected_fragments, expected_words);
+	}
+
+	/**
+	 * \brief Pre-allocate space in the FragmentBatch
+	 * \param expected_fragments Number of Fragments to reserve index space for
+	 * \param expected_words Total size (headers + metadata + payloads) to reserve, in RawDataType words
+	 */
+	void reserve(std::size_t expected_fragments, std::size_t expected_words)
+	{
+		offsets_.reserve(expected_fragments);
+		data_.reserve(expected_words);
+	}
+
+	/**
+	 * \brief Remove all Fragments from the FragmentBatch, keeping the allocated storage for reuse
+	 */
+	void clear()
+	{
+		offsets_.clear();
+		data_.clear();
+	}
+
+	/**
+	 * \brief Append a new Fragment with the given payload size to the FragmentBatch
+	 * \param payload_words Size of the payload, in RawDataType words
+	 * \param sequence_id Sequence ID of the new Fragment
+	 * \param fragment_id Fragment ID of the new Fragment
+	 * \param type Type of the new Fragment (Fragment::DataFragmentType or a user type, as for the Fragment constructor)
+	 * \param timestamp Timestamp of the new Fragment
+	 * \return Pointer to the (zero-initialized) payload of the new Fragment. Valid until the FragmentBatch is next modified.
+	 * \exception cet::exception if type is not a valid user type; the FragmentBatch is left unchanged
+	 */
+	RawDataType* append(std::size_t payload_words,
+	                    Fragment::sequence_id_t sequence_id,
+	                    Fragment::fragment_id_t fragment_id,
+	                    Fragment::type_t type,
+	                    Fragment::timestamp_t timestamp = Fragment::InvalidTimestamp);
+
+	/**
+	 * \brief Append a copy of a Fragment to the FragmentBatch
+	 * \param frag Fragment to copy. Old-version headers are stored as current-version headers.
+	 */
+	void append(Fragment const& frag);
+
+	/**
+	 * \brief Number of Fragments in the FragmentBatch
+	 * \return The number of Fragments in the FragmentBatch
+	 */
+	std::size_t size() const { return offsets_.size(); }
+	/**
+	 * \brief Whether the FragmentBatch contains no Fragments
+	 * \return Whether the FragmentBatch contains no Fragments
+	 */
+	bool empty() const { return offsets_.empty(); }
+	/**
+	 * \brief Total size of the FragmentBatch, in RawDataType words
+	 * \return The total size of all Fragments in the FragmentBatch, in RawDataType words
+	 */
+	std::size_t sizeWords() const { return data_.size(); }
+	/**
+	 * \brief Total size of the FragmentBatch, in bytes
+	 * \return The total size of all Fragments in the FragmentBatch, in bytes
+	 */
+	std::size_t sizeBytes() const { return data_.size() * sizeof(RawDataType); }
+	/**
+	 * \brief Address of the contiguous buffer holding all Fragments
+	 * \return Pointer to the header of the first Fragment
+	 */
+	RawDataType const* data() const { return data_.data(); }
+
+	/**
+	 * \brief Get a View of the Fragment at the given position
+	 * \param index Position of the Fragment in the FragmentBatch
+	 * \return View of the requested Fragment
+	 */
+	View operator[](std::size_t index) const { return View(data_.data() + offsets_[index]); }  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+
+	/**
+	 * \brief Get a View of the Fragment at the given position
+	 * \param index Position of the Fragment in the FragmentBatch
+	 * \return View of the requested Fragment
+	 * \exception cet::exception if the index is out-of-range
+	 */
+	View at(std::size_t index) const
+	{
+		if (index >= size())
+		{
+			throw cet::exception("ArgumentOutOfRange") << "FragmentBatch::at was asked for a non-existent Fragment (index " << index << ", size " << size() << ")!";  // NOLINT(cert-err60-cpp)
+		}
+		return (*this)[index];
+	}
+
+	/**
+	 * \brief Get a mutable pointer to the payload of the Fragment at the given position
+	 * \param index Position of the Fragment in the FragmentBatch
+	 * \return Pointer to the payload of the requested Fragment. Valid until the FragmentBatch is next modified.
+	 */
+	RawDataType* dataBegin(std::size_t index)
+	{
+		return const_cast<RawDataType*>((*this)[index].dataBegin());  // NOLINT(cppcoreguidelines-pro-type-const-cast)
+	}
+
+	/**
+	 * \brief Iterator to the first Fragment in the FragmentBatch
+	 * \return Iterator to the first Fragment in the FragmentBatch
+	 */
+	const_iterator begin() const { return const_iterator(data_.data()); }
+	/**
+	 * \brief Iterator one past the last Fragment in the FragmentBatch
+	 * \return Iterator one past the last Fragment in the FragmentBatch
+	 */
+	const_iterator end() const { return const_iterator(data_.data() + data_.size()); }  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+
+	/**
+	 * \brief Copy all Fragments in the FragmentBatch into individual Fragment objects
+	 * \param out FragmentPtrs to which the copies will be appended
+	 */
+	void toFragments(FragmentPtrs& out) const;
+
+	/**
+	 * \brief Copy all Fragments in the FragmentBatch into a single ContainerFragment
+	 * \param sequence_id Sequence ID of the ContainerFragment
+	 * \param fragment_id Fragment ID of the ContainerFragment
+	 * \param timestamp Timestamp of the ContainerFragment
+	 * \param allowDifferentTypes Whether the FragmentBatch may contain Fragments of different types
+	 * \return FragmentPtr holding the ContainerFragment
+	 * \exception cet::exception if allowDifferentTypes is false and the Fragments have different types
+	 */
+	FragmentPtr toContainerFragment(Fragment::sequence_id_t sequence_id,
+	                                Fragment::fragment_id_t fragment_id,
+	                                Fragment::timestamp_t timestamp = Fragment::InvalidTimestamp,
+	                                bool allowDifferentTypes = false) const;
+
+private:
+	std::vector<RawDataType> data_;
+	std::vector<std::size_t> offsets_;
+};
+
+inline artdaq::RawDataType* artdaq::FragmentBatch::append(std::size_t payload_words,
+                                                           Fragment::sequence_id_t sequence_id,
+                                                           Fragment::fragment_id_t fragment_id,
+                                                           Fragment::type_t type,
+                                                           Fragment::timestamp_t timestamp)
+{
+	if (type != Fragment::DataFragmentType && !Fragment::isUserFragmentType(type))
+	{
+		throw cet::exception("InvalidValue")  // NOLINT(cert-err60-cpp)
+		    << "RawFragmentHeader user types must be in the range of "
+		    << static_cast<int>(detail::RawFragmentHeader::FIRST_USER_TYPE) << " to " << static_cast<int>(detail::RawFragmentHeader::LAST_USER_TYPE)
+		    << " (bad type is " << static_cast<int>(type) << ").";
+	}
+
+	auto offset = data_.size();
+	auto words = detail::RawFragmentHeader::num_words() + payload_words;
+	data_.resize(offset + words, 0);
+	offsets_.push_back(offset);
+
+	auto hdr = reinterpret_cast<detail::RawFragmentHeader*>(data_.data() + offset);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	hdr->word_count = words;
+	hdr->version = detail::RawFragmentHeader::CurrentVersion;
+	hdr->type = type;
+	hdr->metadata_word_count = 0;
+	hdr->sequence_id = sequence_id;
+	hdr->fragment_id = fragment_id;
+	hdr->timestamp = timestamp;
+	hdr->valid = true;
+	hdr->complete = true;
+	hdr->touch();
+
+	return data_.data() + offset + detail::RawFragmentHeader::num_words();  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+}
+
+inline void artdaq::FragmentBatch::append(Fragment const& frag)
+{
+	auto offset = data_.size();
+	auto hdr = frag.fragmentHeader();
+	auto body_words = frag.size() - frag.headerSizeWords();
+	hdr.word_count = detail::RawFragmentHeader::num_words() + body_words;
+
+	data_.resize(offset + hdr.word_count);
+	offsets_.push_back(offset);
+	memcpy(data_.data() + offset, &hdr, sizeof(detail::RawFragmentHeader));                                                                           // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	memcpy(data_.data() + offset + detail::RawFragmentHeader::num_words(), frag.headerBegin() + frag.headerSizeWords(), body_words * sizeof(RawDataType));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+}
+
+inline void artdaq::FragmentBatch::toFragments(FragmentPtrs& out) const
+{
+	for (auto view : *this)
+	{
+		out.push_back(view.toFragment());
+	}
+}
+
+inline artdaq::FragmentPtr artdaq::FragmentBatch::toContainerFragment(Fragment::sequence_id_t sequence_id,
+                                                                      Fragment::fragment_id_t fragment_id,
+                                                                      Fragment::timestamp_t timestamp,
+                                                                      bool allowDifferentTypes) const
+{
+	auto frag = std::make_unique<Fragment>(0);
+	frag->setSequenceID(sequence_id);
+	frag->setFragmentID(fragment_id);
+	frag->setTimestamp(timestamp);
+
+	ContainerFragmentLoader cfl(*frag, empty() ? Fragment::EmptyFragmentType : (*this)[0].type());
+	cfl.addFragments(reinterpret_cast<detail::RawFragmentHeader const*>(data_.data()), size(), allowDifferentTypes);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+	return frag;
+}
+
+#endif /* artdaq_core_Data_FragmentBatch_hh */
@@ -0,0 +1,259 @@
+#ifndef artdaq_core_Data_FragmentView_hh
+#define artdaq_core_Data_FragmentView_hh
+
+////////////////////////////////////////////////////////////////////////
+// FragmentView
+//
+// Non-owning, read-only view of a Fragment stored in someone else's
+// memory (a FragmentBatch, or the payload of a ContainerFragment), and
+// an iterator over Fragments stored back-to-back.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "artdaq-core/Data/Fragment.hh"
+
+#include "cetlib_except/exception.h"
+
+#include <iterator>
+
+namespace artdaq {
+class FragmentView;
+class FragmentViewIterator;
+}  // namespace artdaq
+
+/**
+ * \brief Read-only view of a Fragment (header + metadata + payload) stored in external memory
+ *
+ * A FragmentView does not own or copy the Fragment; it is invalidated when the underlying
+ * storage is modified or released. Fragments with older header versions are decoded on access.
+ */
+class artdaq::FragmentView
+{
+public:
+	/**
+	 * \brief Construct a View of the Fragment whose header starts at the given address
+	 * \param header Pointer to the first word of the Fragment
+	 */
+	explicit FragmentView(RawDataType const* header)
+	    : header_(header) {}
+
+	/**
+	 * \brief Get the RawFragmentHeader of the Fragment, upgraded to the current version if necessary
+	 * \return The RawFragmentHeader of the Fragment
+	 * \exception cet::exception if the header has an unknown version
+	 */
+	detail::RawFragmentHeader header() const;
+
+	/**
+	 * \brief Version of the Fragment header
+	 * \return The version of the Fragment header, as stored
+	 */
+	Fragment::version_t version() const { return rawHeader_()->version; }
+	/**
+	 * \brief Size of the Fragment (header + metadata + payload) in RawDataType words
+	 * \return The number of RawDataType words in the Fragment
+	 */
+	std::size_t size() const { return rawHeader_()->word_count; }
+	/**
+	 * \brief Size of the Fragment (header + metadata + payload) in bytes
+	 * \return The number of bytes in the Fragment
+	 */
+	std::size_t sizeBytes() const { return size() * sizeof(RawDataType); }
+	/**
+	 * \brief Sequence ID of the Fragment
+	 * \return The Sequence ID of the Fragment
+	 */
+	Fragment::sequence_id_t sequenceID() const { return rawHeader_()->sequence_id; }
+	/**
+	 * \brief Fragment ID of the Fragment
+	 * \return The Fragment ID of the Fragment
+	 */
+	Fragment::fragment_id_t fragmentID() const { return rawHeader_()->fragment_id; }
+	/**
+	 * \brief Type of the Fragment
+	 * \return The type of the Fragment
+	 */
+	Fragment::type_t type() const { return rawHeader_()->type; }
+	/**
+	 * \brief Timestamp of the Fragment
+	 * \return The Timestamp of the Fragment
+	 */
+	Fragment::timestamp_t timestamp() const
+	{
+		auto hdr = currentHeaderPtr_();
+		return hdr != nullptr ? hdr->timestamp : header().timestamp;
+	}
+	/**
+	 * \brief Whether the Fragment has metadata
+	 * \return Whether the Fragment has metadata
+	 */
+	bool hasMetadata() const { return rawHeader_()->metadata_word_count != 0; }
+	/**
+	 * \brief Size of the Fragment header in RawDataType words, which depends on the header version
+	 * \return The number of RawDataType words in the Fragment header
+	 */
+	std::size_t headerSizeWords() const;
+
+	/**
+	 * \brief Address of the first word of the Fragment (its RawFragmentHeader)
+	 * \return Pointer to the start of the Fragment
+	 */
+	RawDataType const* headerAddress() const { return header_; }
+	/**
+	 * \brief Address of the metadata of the Fragment
+	 * \return Pointer to the start of the Fragment metadata
+	 */
+	RawDataType const* metadataAddress() const { return header_ + headerSizeWords(); }  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	/**
+	 * \brief Get a pointer to the metadata of the Fragment, interpreted as the given type
+	 * \tparam T Metadata type
+	 * \return Pointer to the metadata, or nullptr if the Fragment has no metadata
+	 */
+	template<class T>
+	T const* metadata() const
+	{
+		return hasMetadata() ? reinterpret_cast<T const*>(metadataAddress()) : nullptr;  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+	}
+	/**
+	 * \brief Address of the payload of the Fragment
+	 * \return Pointer to the start of the Fragment payload
+	 */
+	RawDataType const* dataBegin() const { return metadataAddress() + rawHeader_()->metadata_word_count; }  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	/**
+	 * \brief Address one past the end of the payload of the Fragment
+	 * \return Pointer to the end of the Fragment payload
+	 */
+	RawDataType const* dataEnd() const { return header_ + size(); }  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	/**
+	 * \brief Size of the payload of the Fragment, in RawDataType words
+	 * \return The number of RawDataType words in the Fragment payload
+	 */
+	std::size_t dataSize() const { return dataEnd() - dataBegin(); }
+	/**
+	 * \brief Size of the payload of the Fragment, in bytes
+	 * \return The number of bytes in the Fragment payload
+	 */
+	std::size_t dataSizeBytes() const { return dataSize() * sizeof(RawDataType); }
+
+	/**
+	 * \brief Copy the viewed Fragment into a new Fragment object
+	 * \return FragmentPtr holding a copy of the viewed Fragment
+	 */
+	FragmentPtr toFragment() const;
+
+private:
+	// Fields up to and including fragment_id have the same layout in all header versions
+	detail::RawFragmentHeader const* rawHeader_() const { return reinterpret_cast<detail::RawFragmentHeader const*>(header_); }  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+
+	detail::RawFragmentHeader const* currentHeaderPtr_() const
+	{
+		auto hdr = rawHeader_();
+		return __builtin_expect(hdr->version == detail::RawFragmentHeader::CurrentVersion, 1) ? hdr : nullptr;
+	}
+
+	RawDataType const* header_;
+};
+
+/**
+ * \brief Forward iterator over Fragments stored back-to-back in memory, yielding FragmentView objects
+ */
+class artdaq::FragmentViewIterator
+{
+public:
+	typedef std::forward_iterator_tag iterator_category;  ///< Iterator category
+	typedef FragmentView value_type;                      ///< Iterator value type
+	typedef std::ptrdiff_t difference_type;               ///< Iterator difference type
+	typedef FragmentView const* pointer;                  ///< Iterator pointer type
+	typedef FragmentView reference;                       ///< Iterator reference type (FragmentViews are returned by value)
+
+	/**
+	 * \brief Construct an iterator pointing at the given word
+	 * \param pos Pointer to the header of a Fragment, or one past the end of the last Fragment
+	 */
+	explicit FragmentViewIterator(RawDataType const* pos)
+	    : pos_(pos) {}
+
+	/**
+	 * \brief Get a FragmentView of the current Fragment
+	 * \return FragmentView of the current Fragment
+	 */
+	FragmentView operator*() const { return FragmentView(pos_); }
+
+	/**
+	 * \brief Advance to the next Fragment
+	 * \return Reference to this iterator
+	 */
+	FragmentViewIterator& operator++()
+	{
+		pos_ += FragmentView(pos_).size();  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		return *this;
+	}
+
+	/**
+	 * \brief Advance to the next Fragment
+	 * \return Copy of the iterator before it was advanced
+	 */
+	FragmentViewIterator operator++(int)
+	{
+		auto tmp = *this;
+		++*this;
+		return tmp;
+	}
+
+	/**
+	 * \brief Compare two iterators
+	 * \param other Iterator to compare to
+	 * \return Whether the two iterators point to the same Fragment
+	 */
+	bool operator==(FragmentViewIterator const& other) const { return pos_ == other.pos_; }
+	/**
+	 * \brief Compare two iterators
+	 * \param other Iterator to compare to
+	 * \return Whether the two iterators point to different Fragments
+	 */
+	bool operator!=(FragmentViewIterator const& other) const { return pos_ != other.pos_; }
+
+private:
+	RawDataType const* pos_;
+};
+
+inline artdaq::detail::RawFragmentHeader artdaq::FragmentView::header() const
+{
+	auto hdr = currentHeaderPtr_();
+	if (hdr != nullptr) return *hdr;
+
+	switch (version())
+	{
+		case 0:
+			return reinterpret_cast<detail::RawFragmentHeaderV0 const*>(header_)->upgrade();  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+		case 1:
+			return reinterpret_cast<detail::RawFragmentHeaderV1 const*>(header_)->upgrade();  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+		case detail::RawFragmentHeader::InvalidVersion:
+			return *rawHeader_();
+		default:
+			throw cet::exception("FragmentView") << "A FragmentView's header gave an unknown version number: " << version();  // NOLINT(cert-err60-cpp)
+	}
+}
+
+inline std::size_t artdaq::FragmentView::headerSizeWords() const
+{
+	switch (version())
+	{
+		case 0:
+			return detail::RawFragmentHeaderV0::num_words();
+		case 1:
+			return detail::RawFragmentHeaderV1::num_words();
+		default:
+			return detail::RawFragmentHeader::num_words();
+	}
+}
+
+inline artdaq::FragmentPtr artdaq::FragmentView::toFragment() const
+{
+	// Fragment(n) allocates n + RawFragmentHeader::num_words() words; the copied header determines the layout
+	auto frag = std::make_unique<Fragment>(size() > detail::RawFragmentHeader::num_words() ? size() - detail::RawFragmentHeader::num_words() : 0);
+	memcpy(frag->headerAddress(), header_, sizeBytes());
+	return frag;
+}
+
+#endif /* artdaq_core_Data_FragmentView_hh */
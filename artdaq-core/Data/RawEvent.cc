@@ -26,9 +26,9 @@ void RawEvent::print(std::ostream& os) const
 	   << ", WordCount " << wordCount()
 	   << ", Complete? " << isComplete()
 	   << '\n';
-	for (auto const& frag : fragments_)
+	for (auto pos : positions_())
 	{
-		os << *frag << '\n';
+		os << fragments_[pos] << '\n';
 	}
 }
 }  // namespace artdaq
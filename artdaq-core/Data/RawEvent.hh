@@ -6,9 +6,13 @@
 
 #include "cetlib_except/exception.h"
 
+#include <sys/uio.h>
 #include <algorithm>
+#include <cstring>
+#include <map>
 #include <memory>
 #include <ostream>
+#include <vector>
 
 namespace artdaq {
 /**
@@ -134,6 +138,18 @@ public:
 	 */
 	void insertFragment(FragmentPtr&& pfrag);
 
+	/**
+	 * \brief Insert the given Fragment into this RawEvent, taking its data by move
+	 * \param frag The Fragment to move into the RawEvent
+	 */
+	void insertFragment(Fragment&& frag);
+
+	/**
+	 * \brief Pre-allocate space for the given number of Fragments
+	 * \param n Number of Fragment objects expected in this RawEvent
+	 */
+	void reserveFragments(size_t n);
+
 	/**
 	 * \brief Mark the event as complete
 	 */
@@ -223,21 +239,61 @@ public:
 	 */
 	std::unique_ptr<Fragments> releaseProduct(Fragment::type_t type);
 
+	/**
+	 * \brief Size of this RawEvent when laid out as a RawEventHeader followed by its Fragments
+	 * \return The number of bytes needed by serializeTo
+	 */
+	size_t serializedSize() const;
+
+	/**
+	 * \brief Write the RawEventHeader followed by all unreleased Fragments, back-to-back, into the given memory
+	 * \param dest Destination for the serialized RawEvent
+	 * \param size Number of bytes available at dest
+	 * \return The number of bytes written
+	 * \exception cet::exception if size is smaller than serializedSize()
+	 *
+	 * This is the layout that SharedMemoryEventReceiver expects to find in a shared memory buffer.
+	 */
+	size_t serializeTo(void* dest, size_t size) const;
+
+	/**
+	 * \brief Get the pieces of the serialized RawEvent (RawEventHeader, then each unreleased Fragment) without copying them
+	 * \return A list of pointers and sizes suitable for SharedMemoryManager::WriteScatter
+	 *
+	 * The returned pointers are invalidated by any operation which modifies the RawEvent.
+	 */
+	std::vector<struct iovec> scatterList() const;
+
 #endif
 
 private:
+#if HIDE_FROM_ROOT
+	// Positions in fragments_ of the Fragments which have not been released, in insertion order
+	std::vector<size_t> positions_() const;
+	// Pointers to and sizes of the unreleased Fragments, in insertion order, optionally preceded by the RawEventHeader
+	std::vector<struct iovec> scatterList_(bool include_header) const;
+#endif
+
 	detail::RawEventHeader header_;
-	FragmentPtrs fragments_;
+	Fragments fragments_;                                               // Fragments are stored contiguously, and left in place (moved-from) when released by type
+	std::vector<Fragment::type_t> types_;                               // Fragment types present in the RawEvent, in order of first appearance
+	std::map<Fragment::type_t, std::vector<size_t>> fragments_by_type_;  // Positions in fragments_ of the unreleased Fragments of each type
+	size_t fragment_count_;
+	size_t word_count_;
 };
 
 typedef std::shared_ptr<RawEvent> RawEvent_ptr;  ///< A shared_ptr to a RawEvent
 
 inline RawEvent::RawEvent(run_id_t run, subrun_id_t subrun, event_id_t event, sequence_id_t seq, timestamp_t ts)
     : header_(run, subrun, event, seq, ts)
-    , fragments_() {}
+    , fragments_()
+    , types_()
+    , fragments_by_type_()
+    , fragment_count_(0)
+    , word_count_(0) {}
 
 inline RawEvent::RawEvent(detail::RawEventHeader hdr)
-    : header_(hdr), fragments_()
+    : header_(hdr), fragments_(), types_(), fragments_by_type_(), fragment_count_(0), word_count_(0)
 {}
 
 #if HIDE_FROM_ROOT
@@ -248,21 +304,39 @@ inline void RawEvent::insertFragment(FragmentPtr&& pfrag)
 		throw cet::exception("LogicError")  // NOLINT(cert-err60-cpp)
 		    << "Attempt to insert a null FragmentPtr into a RawEvent detected.\n";
 	}
-	fragments_.emplace_back(std::move(pfrag));
+	insertFragment(std::move(*pfrag));
+	pfrag.reset();
+}
+
+inline void RawEvent::insertFragment(Fragment&& frag)
+{
+	auto type = frag.type();
+	auto& positions = fragments_by_type_[type];
+	if (positions.empty() && std::find(types_.begin(), types_.end(), type) == types_.end())
+	{
+		types_.push_back(type);
+	}
+	positions.push_back(fragments_.size());
+	word_count_ += frag.size();
+	++fragment_count_;
+	fragments_.emplace_back(std::move(frag));
+}
+
+inline void RawEvent::reserveFragments(size_t n)
+{
+	fragments_.reserve(n);
 }
 
 inline void RawEvent::markComplete() { header_.is_complete = true; }
 
 inline size_t RawEvent::numFragments() const
 {
-	return fragments_.size();
+	return fragment_count_;
 }
 
 inline size_t RawEvent::wordCount() const
 {
-	size_t sum = 0;
-	for (auto const& frag : fragments_) { sum += frag->size(); }
-	return sum;
+	return word_count_;
 }
 
 inline RawEvent::run_id_t RawEvent::runID() const { return header_.run_id; }
@@ -272,57 +346,126 @@ inline RawEvent::sequence_id_t RawEvent::sequenceID() const { return header_.seq
 inline RawEvent::timestamp_t RawEvent::timestamp() const { return header_.timestamp; }
 inline bool RawEvent::isComplete() const { return header_.is_complete; }
 
+inline std::vector<size_t> RawEvent::positions_() const
+{
+	std::vector<size_t> positions;
+	positions.reserve(fragment_count_);
+	for (auto const& type_positions : fragments_by_type_)
+	{
+		positions.insert(positions.end(), type_positions.second.begin(), type_positions.second.end());
+	}
+	std::sort(positions.begin(), positions.end());
+	return positions;
+}
+
 inline std::unique_ptr<Fragments> RawEvent::releaseProduct()
 {
 	std::unique_ptr<Fragments> result(new Fragments);
-	result->reserve(fragments_.size());
-	// 03/08/2016 ELF: Moving to range-for for STL compatibility
-	// for (size_t i = 0, sz = fragments_.size(); i < sz; ++i) {
-	for (auto& i : fragments_)
+	if (fragment_count_ == fragments_.size())
+	{
+		// Nothing has been released by type, so the whole vector can be handed over
+		result->swap(fragments_);
+	}
+	else
 	{
-		result->emplace_back(std::move(*i));
+		result->reserve(fragment_count_);
+		for (auto pos : positions_())
+		{
+			result->emplace_back(std::move(fragments_[pos]));
+		}
 	}
+
 	// It seems more hygenic to clear fragments_ rather than to leave
-	// it full of unique_ptrs to Fragments that have been plundered by
-	// the move.
+	// it full of Fragments that have been plundered by the move.
 	fragments_.clear();
+	types_.clear();
+	fragments_by_type_.clear();
+	fragment_count_ = 0;
+	word_count_ = 0;
 	return result;
 }
 
 inline void RawEvent::fragmentTypes(std::vector<Fragment::type_t>& type_list)
 {
-	// 03/08/2016 ELF: Moving to range-for for STL compatibility
-	// for (size_t i = 0, sz = fragments_.size(); i < sz; ++i) {
-	for (auto& i : fragments_)
+	for (auto type : types_)
 	{
-		auto fragType = i->type();  // fragments_[i]->type();
-		if (std::find(type_list.begin(), type_list.end(), fragType) == type_list.end())
+		if (fragments_by_type_.count(type) != 0 && std::find(type_list.begin(), type_list.end(), type) == type_list.end())
 		{
-			type_list.push_back(fragType);
+			type_list.push_back(type);
 		}
 	}
-	// std::sort(type_list.begin(), type_list.end());
-	// std::unique(type_list.begin(), type_list.end());
 }
 
 inline std::unique_ptr<Fragments>
 RawEvent::releaseProduct(Fragment::type_t fragment_type)
 {
 	std::unique_ptr<Fragments> result(new Fragments);
-	auto iter = fragments_.begin();
-	do
+	auto it = fragments_by_type_.find(fragment_type);
+	if (it == fragments_by_type_.end()) return result;
+
+	result->reserve(it->second.size());
+	for (auto pos : it->second)
 	{
-		if ((*iter)->type() == fragment_type)
-		{
-			result->push_back(std::move(*(*iter)));
-			iter = fragments_.erase(iter);
-		}
-		else
+		word_count_ -= fragments_[pos].size();
+		result->emplace_back(std::move(fragments_[pos]));
+	}
+	fragment_count_ -= it->second.size();
+	fragments_by_type_.erase(it);
+	return result;
+}
+
+inline size_t RawEvent::serializedSize() const
+{
+	return sizeof(detail::RawEventHeader) + word_count_ * sizeof(RawDataType);
+}
+
+inline size_t RawEvent::serializeTo(void* dest, size_t size) const
+{
+	auto total = serializedSize();
+	if (size < total)
+	{
+		throw cet::exception("ArgumentOutOfRange")  // NOLINT(cert-err60-cpp)
+		    << "RawEvent::serializeTo needs " << total << " bytes, but only " << size << " are available!";
+	}
+
+	auto pos = static_cast<uint8_t*>(dest);
+	memcpy(pos, &header_, sizeof(detail::RawEventHeader));
+	pos += sizeof(detail::RawEventHeader);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	for (auto const& piece : scatterList_(false))
+	{
+		memcpy(pos, piece.iov_base, piece.iov_len);
+		pos += piece.iov_len;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	}
+	return total;
+}
+
+inline std::vector<struct iovec> RawEvent::scatterList() const
+{
+	return scatterList_(true);
+}
+
+inline std::vector<struct iovec> RawEvent::scatterList_(bool include_header) const
+{
+	std::vector<struct iovec> pieces;
+	pieces.reserve(fragment_count_ + 1);
+	if (include_header)
+	{
+		pieces.push_back({const_cast<detail::RawEventHeader*>(&header_), sizeof(detail::RawEventHeader)});  // NOLINT(cppcoreguidelines-pro-type-const-cast)
+	}
+
+	auto add = [&](Fragment const& frag) { pieces.push_back({const_cast<Fragment::byte_t*>(frag.headerBeginBytes()), frag.sizeBytes()}); };  // NOLINT(cppcoreguidelines-pro-type-const-cast)
+	if (fragment_count_ == fragments_.size())
+	{
+		std::for_each(fragments_.begin(), fragments_.end(), add);
+	}
+	else
+	{
+		for (auto pos : positions_())
 		{
-			++iter;
+			add(fragments_[pos]);
 		}
-	} while (iter != fragments_.end());
-	return result;
+	}
+	return pieces;
 }
 
 /**
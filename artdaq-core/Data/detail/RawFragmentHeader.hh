@@ -6,6 +6,7 @@
 // of Fragment is intended to be used to access the data.
 
 // #include <cstddef>
+#include <array>
 #include <map>
 #include "artdaq-core/Data/dictionarycontrol.hh"
 #include "artdaq-core/Utilities/TimeUtils.hh"
@@ -63,18 +64,75 @@ struct artdaq::detail::RawFragmentHeader
 	static constexpr type_t ContainerFragmentType = FIRST_SYSTEM_TYPE + 7;    ///< This Fragment is a ContainerFragment and analysis code should unpack it
 	static constexpr type_t ErrorFragmentType = FIRST_SYSTEM_TYPE + 8;        ///< This Fragment has experienced some error, and no attempt should be made to read it
 
+	typedef std::array<char const*, 256> TypeNameTable;  ///< Names of Fragment types, indexed by type (nullptr for types without a name)
+
+	/**
+	 * \brief Build a table of the most-commonly used system types
+	 * \return A TypeNameTable containing the system types used in the _artdaq_ data stream
+	 */
+	static constexpr TypeNameTable MakeSystemTypeNameTable()
+	{
+		TypeNameTable table{};
+		table[DataFragmentType] = "Data";
+		table[EmptyFragmentType] = "Empty";
+		table[ErrorFragmentType] = "Error";
+		table[InvalidFragmentType] = "Invalid";
+		table[ContainerFragmentType] = "Container";
+		return table;
+	}
+
+	/**
+	 * \brief Build a table of all system types
+	 * \return A TypeNameTable containing all defined system types
+	 */
+	static constexpr TypeNameTable MakeVerboseSystemTypeNameTable()
+	{
+		TypeNameTable table{};
+		table[INVALID_TYPE] = "INVALID";
+		table[EndOfDataFragmentType] = "EndOfData";
+		table[DataFragmentType] = "Data";
+		table[InitFragmentType] = "Init";
+		table[EndOfRunFragmentType] = "EndOfRun";
+		table[EndOfSubrunFragmentType] = "EndOfSubrun";
+		table[ShutdownFragmentType] = "Shutdown";
+		table[EmptyFragmentType] = "Empty";
+		table[ContainerFragmentType] = "Container";
+		table[ErrorFragmentType] = "Error";
+		return table;
+	}
+
+	static const TypeNameTable SystemTypeNames;         ///< The most-commonly used system types (see MakeSystemTypeNameTable)
+	static const TypeNameTable VerboseSystemTypeNames;  ///< All defined system types (see MakeVerboseSystemTypeNameTable)
+
+	/**
+	 * \brief Look up the name of a system type, without allocating
+	 * \param type Type to look up
+	 * \return The name of the type, or nullptr if it is not a defined system type
+	 */
+	static constexpr char const* SystemTypeName(type_t type);
+
+	/**
+	 * \brief Convert a TypeNameTable to a map, for code which expects one
+	 * \param table Table to convert
+	 * \return A map of each type in the table which has a name to that name
+	 */
+	static std::map<type_t, std::string> TypeNameTableToMap(TypeNameTable const& table)
+	{
+		std::map<type_t, std::string> output;
+		for (size_t ii = 0; ii < table.size(); ++ii)
+		{
+			if (table[ii] != nullptr) output.emplace(static_cast<type_t>(ii), table[ii]);
+		}
+		return output;
+	}
+
 	/**
 	 * \brief Returns a map of the most-commonly used system types
 	 * \return A map of the system types used in the _artdaq_ data stream
 	 */
 	static std::map<type_t, std::string> MakeSystemTypeMap()
 	{
-		return std::map<type_t, std::string>{
-		    {type_t(DataFragmentType), "Data"},
-		    {type_t(EmptyFragmentType), "Empty"},
-		    {type_t(ErrorFragmentType), "Error"},
-		    {type_t(InvalidFragmentType), "Invalid"},
-		    {232, "Container"}};
+		return TypeNameTableToMap(SystemTypeNames);
 	}
 
 	/**
@@ -83,16 +141,7 @@ struct artdaq::detail::RawFragmentHeader
 	 */
 	static std::map<type_t, std::string> MakeVerboseSystemTypeMap()
 	{
-		return std::map<type_t, std::string>{
-		    {type_t(INVALID_TYPE), "INVALID"},
-		    {type_t(EndOfDataFragmentType), "EndOfData"},
-		    {type_t(DataFragmentType), "Data"},
-		    {type_t(InitFragmentType), "Init"},
-		    {type_t(EndOfRunFragmentType), "EndOfRun"},
-		    {type_t(EndOfSubrunFragmentType), "EndOfSubrun"},
-		    {type_t(ShutdownFragmentType), "Shutdown"},
-		    {type_t(EmptyFragmentType), "Empty"},
-		    {type_t(ContainerFragmentType), "Container"}};
+		return TypeNameTableToMap(VerboseSystemTypeNames);
 	}
 
 	/**
@@ -102,12 +151,8 @@ struct artdaq::detail::RawFragmentHeader
 	 */
 	static std::string SystemTypeToString(type_t type)
 	{
-		auto map = MakeVerboseSystemTypeMap();
-		if (map.count(type))
-		{
-			return map[type];
-		}
-		return "Unknown";
+		auto name = SystemTypeName(type);
+		return name != nullptr ? name : "Unknown";
 	}
 
 	// Each of the following invalid values is chosen based on the
@@ -161,8 +206,18 @@ struct artdaq::detail::RawFragmentHeader
 
 	/**
 	 * \brief Update the atime fields of the RawFragmentHeader to current time
+	 *
+	 * The time source is selected per process with artdaq::TimeUtils::setAccessTimeClock.
+	 * If the access-time clock is Disabled, this is a no-op.
 	 */
 	void touch();
+	/**
+	 * \brief Set the atime fields of the RawFragmentHeader to the given time
+	 * \param time Access time to record
+	 *
+	 * Use this to stamp many headers with a single clock read.
+	 */
+	void touch(struct timespec const& time);
 	/**
 	 * \brief Get the last access time of this RawFragmentHeader
 	 * \return struct timespec representing last access time of this RawFragmentHeader
@@ -171,7 +226,7 @@ struct artdaq::detail::RawFragmentHeader
 	/**
 	 * \brief Get the elapsed time between now and the last access time of the RawFragmentHeader, optionally resetting it
 	 * \param touch Whether to also update the access time to current time
-	 * \return struct timespec representing interval between now and last access time of this RawFragmentHeader
+	 * \return struct timespec representing interval between now and last access time of this RawFragmentHeader (zero if the access-time clock is Disabled)
 	 */
 	struct timespec getLatency(bool touch);
 
@@ -201,6 +256,17 @@ struct artdaq::detail::RawFragmentHeader
 };
 
 #if HIDE_FROM_ROOT
+inline constexpr artdaq::detail::RawFragmentHeader::TypeNameTable artdaq::detail::RawFragmentHeader::SystemTypeNames =
+    artdaq::detail::RawFragmentHeader::MakeSystemTypeNameTable();
+inline constexpr artdaq::detail::RawFragmentHeader::TypeNameTable artdaq::detail::RawFragmentHeader::VerboseSystemTypeNames =
+    artdaq::detail::RawFragmentHeader::MakeVerboseSystemTypeNameTable();
+
+inline constexpr char const*
+artdaq::detail::RawFragmentHeader::SystemTypeName(type_t type)
+{
+	return VerboseSystemTypeNames[type];
+}
+
 inline constexpr std::size_t
 artdaq::detail::RawFragmentHeader::num_words()
 {
@@ -242,7 +308,12 @@ artdaq::detail::RawFragmentHeader::setSystemType(uint8_t stype)
 
 inline void artdaq::detail::RawFragmentHeader::touch()
 {
-	auto time = artdaq::TimeUtils::get_realtime_clock();
+	if (artdaq::TimeUtils::getAccessTimeClock() == artdaq::TimeUtils::AccessTimeClock::Disabled) return;
+	touch(artdaq::TimeUtils::get_access_time());
+}
+
+inline void artdaq::detail::RawFragmentHeader::touch(struct timespec const& time)
+{
 	atime_ns = time.tv_nsec;
 	atime_s = time.tv_sec;
 }
@@ -257,8 +328,13 @@ inline struct timespec artdaq::detail::RawFragmentHeader::atime() const
 
 inline struct timespec artdaq::detail::RawFragmentHeader::getLatency(bool touch)
 {
+	if (artdaq::TimeUtils::getAccessTimeClock() == artdaq::TimeUtils::AccessTimeClock::Disabled)
+	{
+		return timespec{0, 0};
+	}
+
 	auto a_time = atime();
-	auto time = artdaq::TimeUtils::get_realtime_clock();
+	auto time = artdaq::TimeUtils::get_access_time();
 
 	a_time.tv_sec = time.tv_sec - a_time.tv_sec;
 
@@ -274,8 +350,7 @@ inline struct timespec artdaq::detail::RawFragmentHeader::getLatency(bool touch)
 
 	if (touch)
 	{
-		atime_ns = time.tv_nsec;
-		atime_s = time.tv_sec;
+		this->touch(time);
 	}
 	return a_time;
 }
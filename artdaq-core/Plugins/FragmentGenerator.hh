@@ -8,9 +8,21 @@
 // (non-virtual) functions.
 //
 // getNext() will be called only from a single thread
+//
+// Subclasses must override getNext(FragmentPtrs&); the default
+// getNextBatch(FragmentBatch&) adapts it. Generators which produce
+// FragmentBatches natively should derive from FragmentBatchGenerator
+// instead, which makes getNextBatch pure and adapts getNext.
+//
+// Generators which read several independent sources (e.g. links) may
+// instead override numStreams() and getNextFromStream(); a
+// ParallelGeneratorDriver then calls each stream from its own thread.
 ////////////////////////////////////////////////////////////////////////
 
 #include "artdaq-core/Data/Fragment.hh"
+#include "artdaq-core/Data/FragmentBatch.hh"
+
+#include "cetlib_except/exception.h"
 
 namespace artdaq {
 /**
@@ -43,6 +55,38 @@ public:
 	 */
 	virtual bool getNext(FragmentPtrs& output) = 0;
 
+	/**
+	 * \brief Obtain the next collection of Fragments, stored contiguously in a FragmentBatch
+	 * \param output New Fragments will be appended to this FragmentBatch
+	 * \return False indicates end-of-data
+	 *
+	 * Same semantics as getNext(FragmentPtrs&), but avoids a heap allocation per Fragment.
+	 * Callers should clear() and reuse the same FragmentBatch across calls so that its storage
+	 * is recycled. The default implementation calls getNext(FragmentPtrs&) and copies each
+	 * Fragment into the batch, so generators which produce many small Fragments should
+	 * override this method as well (or derive from FragmentBatchGenerator).
+	 */
+	virtual bool getNextBatch(FragmentBatch& output);
+
+	/**
+	 * \brief Number of independent streams this FragmentGenerator reads from
+	 * \return The number of streams which may be passed to getNextFromStream (default 1)
+	 */
+	virtual size_t numStreams() { return 1; }
+
+	/**
+	 * \brief Obtain the next collection of Fragments from one stream
+	 * \param stream Index of the stream to read, less than numStreams()
+	 * \param output New FragmentPtr objects will be added to this FragmentPtrs object.
+	 * \return False indicates end-of-data on this stream
+	 * \exception cet::exception if stream is out of range
+	 *
+	 * Same semantics as getNext(FragmentPtrs&), but for a single stream. getNextFromStream may be
+	 * called concurrently for different streams, but never concurrently for the same stream.
+	 * The default implementation only supports stream 0, and calls getNext(FragmentPtrs&).
+	 */
+	virtual bool getNextFromStream(size_t stream, FragmentPtrs& output);
+
 	/**
 	 * \brief Which fragment IDs does this FragmentGenerator generate?
 	 * \return A std::vector of fragment_id_t
@@ -58,6 +102,74 @@ private:
 	FragmentGenerator& operator=(FragmentGenerator const&) = delete;
 	FragmentGenerator& operator=(FragmentGenerator&&) = delete;
 };
+
+/**
+ * \brief Base class for FragmentGenerators which produce FragmentBatches natively
+ *
+ * Subclasses must override getNextBatch; getNext(FragmentPtrs&) copies each Fragment out of the batch.
+ */
+class FragmentBatchGenerator : public FragmentGenerator
+{
+public:
+	/**
+	 * \brief Default Constructor
+	 */
+	FragmentBatchGenerator() = default;
+
+	~FragmentBatchGenerator() override = default;
+
+	/**
+	 * \brief Obtain the next collection of Fragments.
+	 * \param output New FragmentPtr objects will be added to this FragmentPtrs object.
+	 * \return False indicates end-of-data
+	 *
+	 * Calls getNextBatch and copies each Fragment out of the batch.
+	 */
+	bool getNext(FragmentPtrs& output) override;
+
+	/**
+	 * \brief Obtain the next collection of Fragments, stored contiguously in a FragmentBatch
+	 * \param output New Fragments will be appended to this FragmentBatch
+	 * \return False indicates end-of-data
+	 */
+	bool getNextBatch(FragmentBatch& output) override = 0;
+
+private:
+	FragmentBatchGenerator(FragmentBatchGenerator const&) = delete;
+	FragmentBatchGenerator(FragmentBatchGenerator&&) = delete;
+	FragmentBatchGenerator& operator=(FragmentBatchGenerator const&) = delete;
+	FragmentBatchGenerator& operator=(FragmentBatchGenerator&&) = delete;
+
+	FragmentBatch adapter_batch_;
+};
 }  // namespace artdaq
 
+inline bool artdaq::FragmentGenerator::getNextBatch(FragmentBatch& output)
+{
+	FragmentPtrs frags;
+	auto sts = getNext(frags);
+	for (auto& frag : frags)
+	{
+		output.append(*frag);
+	}
+	return sts;
+}
+
+inline bool artdaq::FragmentBatchGenerator::getNext(FragmentPtrs& output)
+{
+	adapter_batch_.clear();
+	auto sts = getNextBatch(adapter_batch_);
+	adapter_batch_.toFragments(output);
+	return sts;
+}
+
+inline bool artdaq::FragmentGenerator::getNextFromStream(size_t stream, FragmentPtrs& output)
+{
+	if (stream != 0)
+	{
+		throw cet::exception("ArgumentOutOfRange") << "FragmentGenerator was asked for stream " << stream << ", but only has a single stream! Subclasses with more streams must override getNextFromStream.";  // NOLINT(cert-err60-cpp)
+	}
+	return getNext(output);
+}
+
 #endif /* artdaq_core_Plugins_FragmentGenerator_hh */
@@ -1,8 +1,11 @@
 #ifndef _artdaq_core_Plugins_FragmentNameHelper_hh_
 #define _artdaq_core_Plugins_FragmentNameHelper_hh_
 
+#include <array>
+#include <map>
 #include <set>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <cetlib/BasicPluginFactory.h>
@@ -65,6 +68,7 @@ public:
 		{
 			type_map_[type_pair.first] = type_pair.second;
 		}
+		UpdateNameTable_();
 	}
 
 	/**
@@ -73,6 +77,7 @@ public:
 	void AddExtraType(artdaq::Fragment::type_t type_id, std::string const& type_name)
 	{
 		type_map_[type_id] = type_name;
+		UpdateNameTable_();
 	}
 
 	/**
@@ -81,13 +86,27 @@ public:
 	 */
 	std::string GetUnidentifiedInstanceName() const { return unidentified_instance_name_; }
 
+	/**
+	 * \brief Look up the instance name for a Fragment type in the precomputed name table
+	 * \param type_id Type of the Fragment
+	 * \param contained_type_id Type of the Fragments in the ContainerFragment, if type_id is the ContainerFragmentType (ignored otherwise)
+	 * \return Whether a mapping was found, and the interned instance name (the unidentified_instance_name if no mapping was found).
+	 * The string_view is valid until the next call to SetBasicTypes(), AddExtraType() or UpdateNameTable_().
+	 */
+	std::pair<bool, std::string_view> LookupInstanceName(artdaq::Fragment::type_t type_id, artdaq::Fragment::type_t contained_type_id = 0) const
+	{
+		auto name_id = type_id == artdaq::Fragment::ContainerFragmentType ? container_name_ids_[contained_type_id] : type_name_ids_[type_id];
+		if (name_id == NO_NAME) return {false, unidentified_instance_name_};
+		return {true, instance_names_[name_id]};
+	}
+
 	/**
 	 * \brief Returns the basic translation for the specified type. Must be implemented by derived classes
 	 */
 	virtual std::string GetInstanceNameForType(artdaq::Fragment::type_t type_id) const
 	{
-		if (type_map_.count(type_id) > 0) { return type_map_.at(type_id); }
-		return unidentified_instance_name_;
+		auto name_id = type_name_ids_[type_id];
+		return name_id != NO_NAME ? instance_names_[name_id] : unidentified_instance_name_;
 	}
 
 	/**
@@ -99,27 +118,16 @@ public:
 	virtual std::set<std::string> GetAllProductInstanceNames() const
 	{
 		std::set<std::string> output;
-		for (const auto& map_iter : type_map_)
+		for (auto const& name_ids : {type_name_ids_, container_name_ids_})
 		{
-			std::string instance_name = map_iter.second;
-			if (output.count(instance_name) == 0u)
+			for (auto name_id : name_ids)
 			{
-				output.insert(instance_name);
-				TLOG(TLVL_DEBUG + 33) << "Adding product instance name \"" << map_iter.second << "\" to list of expected names";
-			}
-		}
-
-		auto container_type = type_map_.find(artdaq::Fragment::type_t(artdaq::Fragment::ContainerFragmentType));
-		if (container_type != type_map_.end())
-		{
-			std::string container_type_name = container_type->second;
-			std::set<std::string> tmp_copy = output;
-			for (const auto& set_iter : tmp_copy)
-			{
-				output.insert(container_type_name + set_iter);
+				if (name_id != NO_NAME && output.insert(instance_names_[name_id]).second)
+				{
+					TLOG(TLVL_DEBUG + 33) << "Adding product instance name \"" << instance_names_[name_id] << "\" to list of expected names";
+				}
 			}
 		}
-
 		return output;
 	}
 
@@ -133,43 +141,73 @@ public:
 	virtual std::pair<bool, std::string>
 	GetInstanceNameForFragment(artdaq::Fragment const& fragment) const
 	{
-		auto type_map_end = type_map_.end();
-		bool success_code = true;
-		std::string instance_name;
+		auto type = fragment.type();
+		artdaq::Fragment::type_t contained_type = 0;
+		if (type == artdaq::Fragment::ContainerFragmentType && type_name_ids_[type] != NO_NAME)
+		{
+			contained_type = artdaq::ContainerFragment(fragment).fragment_type();
+		}
 
-		auto primary_type = type_map_.find(fragment.type());
-		if (primary_type != type_map_end)
+		auto result = LookupInstanceName(type, contained_type);
+		if (result.first)
 		{
-			TLOG(TLVL_DEBUG + 33) << "Found matching instance name " << primary_type->second << " for Fragment type " << static_cast<int>(fragment.type());
-			instance_name = primary_type->second;
-			if (fragment.type() == artdaq::Fragment::ContainerFragmentType)
-			{
-				artdaq::ContainerFragment cf(fragment);
-				auto contained_type = type_map_.find(cf.fragment_type());
-				if (contained_type != type_map_end)
-				{
-					instance_name += contained_type->second;
-				}
-			}
+			TLOG(TLVL_DEBUG + 33) << "Found matching instance name " << result.second << " for Fragment type " << static_cast<int>(type);
 		}
 		else
 		{
-			TLOG(TLVL_DEBUG + 33) << "Could not find match for Fragment type " << static_cast<int>(fragment.type()) << ", returning " << unidentified_instance_name_;
-			instance_name = unidentified_instance_name_;
-			success_code = false;
+			TLOG(TLVL_DEBUG + 33) << "Could not find match for Fragment type " << static_cast<int>(type) << ", returning " << unidentified_instance_name_;
 		}
-
-		return std::make_pair(success_code, instance_name);
+		return std::make_pair(result.first, std::string(result.second));
 	}
 
 protected:
+	/**
+	 * \brief Rebuild the instance name table from type_map_. Derived classes which modify type_map_ directly must call this afterwards.
+	 */
+	void UpdateNameTable_()
+	{
+		instance_names_.assign(1, std::string());
+		std::map<std::string, uint16_t> interned;
+		auto intern = [&](std::string const& name) {
+			auto it = interned.find(name);
+			if (it != interned.end()) return it->second;
+			instance_names_.push_back(name);
+			return interned[name] = static_cast<uint16_t>(instance_names_.size() - 1);
+		};
+
+		type_name_ids_.fill(NO_NAME);
+		container_name_ids_.fill(NO_NAME);
+		for (auto const& type_pair : type_map_)
+		{
+			type_name_ids_[type_pair.first] = intern(type_pair.second);
+		}
+
+		// Containers are named by concatenating the container name with the name of the contained type, if it has one
+		auto container_type = type_map_.find(artdaq::Fragment::ContainerFragmentType);
+		if (container_type != type_map_.end())
+		{
+			for (size_t contained_type = 0; contained_type < container_name_ids_.size(); ++contained_type)
+			{
+				auto contained_name_id = type_name_ids_[contained_type];
+				container_name_ids_[contained_type] = intern(container_type->second + (contained_name_id != NO_NAME ? instance_names_[contained_name_id] : std::string()));
+			}
+		}
+	}
+
 	std::map<artdaq::Fragment::type_t, std::string> type_map_;  ///< Map relating Fragment Type to strings
 	std::string unidentified_instance_name_;                    ///< The name to use for unknown Fragment types
+
 private:
 	FragmentNameHelper(FragmentNameHelper const&) = default;
 	FragmentNameHelper(FragmentNameHelper&&) = default;
 	FragmentNameHelper& operator=(FragmentNameHelper const&) = default;
 	FragmentNameHelper& operator=(FragmentNameHelper&&) = default;
+
+	static constexpr uint16_t NO_NAME = 0;  // Entry in the name tables for types without a mapping
+
+	std::vector<std::string> instance_names_;       // Interned instance names, indexed by the IDs in the name tables
+	std::array<uint16_t, 256> type_name_ids_;       // Instance name ID for each Fragment type
+	std::array<uint16_t, 256> container_name_ids_;  // Instance name ID for a ContainerFragment holding each Fragment type
 };
 
 /**
@@ -0,0 +1,195 @@
+#define TRACE_NAME "ParallelGeneratorDriver"
+#include "artdaq-core/Plugins/ParallelGeneratorDriver.hh"
+
+#include <pthread.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "TRACE/tracemf.h"
+
+artdaq::ParallelGeneratorDriver::ParallelGeneratorDriver(std::unique_ptr<FragmentGenerator> generator, size_t threads, size_t queue_capacity)
+    : generator_(std::move(generator))
+{
+	if (!generator_)
+	{
+		throw cet::exception("ParallelGeneratorDriver") << "ParallelGeneratorDriver requires a FragmentGenerator!";  // NOLINT(cert-err60-cpp)
+	}
+	auto stream_count = generator_->numStreams();
+	if (stream_count == 0)
+	{
+		throw cet::exception("ParallelGeneratorDriver") << "FragmentGenerator has no streams to read!";  // NOLINT(cert-err60-cpp)
+	}
+
+	if (threads == 0)
+	{
+		threads = std::max(1u, boost::thread::hardware_concurrency());
+	}
+	thread_count_ = std::min(threads, stream_count);
+
+	for (size_t ii = 0; ii < stream_count; ++ii)
+	{
+		streams_.push_back(std::make_unique<Stream>(queue_capacity));
+	}
+	TLOG(TLVL_DEBUG) << "Reading " << stream_count << " streams with " << thread_count_ << " threads, buffering up to " << streams_[0]->queue.capacity() << " Fragments per stream";
+}
+
+artdaq::ParallelGeneratorDriver::~ParallelGeneratorDriver()
+{
+	stop();
+}
+
+void artdaq::ParallelGeneratorDriver::start()
+{
+	if (started_) return;
+	started_ = true;
+
+	for (size_t ii = 0; ii < thread_count_; ++ii)
+	{
+		try
+		{
+			workers_.push_back(std::make_unique<boost::thread>([this, ii] { runWorker_(ii); }));
+			auto tname = "GenStream" + std::to_string(ii);
+			auto handle = workers_.back()->native_handle();
+			pthread_setname_np(handle, tname.substr(0, 15).c_str());  // Size 16 including the terminator - see man page pthread_setname_np(3)
+		}
+		catch (const boost::exception& e)
+		{
+			TLOG(TLVL_ERROR) << "Caught boost::exception starting generator stream thread: " << boost::diagnostic_information(e) << ", errno=" << errno;
+			stop();
+			throw cet::exception("ParallelGeneratorDriver") << "Could not start generator stream thread: " << boost::diagnostic_information(e);  // NOLINT(cert-err60-cpp)
+		}
+	}
+}
+
+void artdaq::ParallelGeneratorDriver::stop()
+{
+	stop_requested_ = true;
+	notifyConsumer_();
+	for (auto& worker : workers_)
+	{
+		if (worker->joinable() && worker->get_id() != boost::this_thread::get_id())
+		{
+			worker->join();
+		}
+	}
+	workers_.clear();
+}
+
+bool artdaq::ParallelGeneratorDriver::getNext(FragmentPtrs& output)
+{
+	start();
+
+	while (true)
+	{
+		{
+			std::lock_guard<std::mutex> lk(error_mutex_);
+			if (error_) std::rethrow_exception(error_);
+		}
+		if (stop_requested_) return false;
+
+		size_t received = 0;
+		bool all_done = true;
+		for (auto& stream : streams_)
+		{
+			// Read the done flag before draining, so that any Fragment queued before it was set is seen
+			auto done = stream->done.load(std::memory_order_acquire);
+			FragmentPtr frag;
+			while (stream->queue.pop(frag))
+			{
+				output.push_back(std::move(frag));
+				++received;
+			}
+			if (!done) all_done = false;
+		}
+
+		if (received > 0) return true;
+		if (all_done) return false;
+
+		// Nothing available: sleep until a worker queues something. The timeout bounds the latency of a missed wakeup.
+		std::unique_lock<std::mutex> lk(wait_mutex_);
+		consumer_waiting_ = true;
+		if (std::all_of(streams_.begin(), streams_.end(), [](auto const& stream) { return stream->queue.empty(); }))
+		{
+			wait_cv_.wait_for(lk, std::chrono::milliseconds(1));
+		}
+		consumer_waiting_ = false;
+	}
+}
+
+void artdaq::ParallelGeneratorDriver::runWorker_(size_t worker)
+{
+	TLOG(TLVL_DEBUG + 33) << "Generator stream thread " << worker << " starting";
+	try
+	{
+		while (!stop_requested_)
+		{
+			bool active = false;
+			bool progressed = false;
+			for (size_t ii = worker; ii < streams_.size(); ii += thread_count_)
+			{
+				auto& stream = *streams_[ii];
+				if (stream.done.load(std::memory_order_relaxed)) continue;
+				active = true;
+
+				// Do not read more from a stream whose queue is full
+				if (!flush_(stream)) continue;
+
+				if (!stream.ended)
+				{
+					stream.ended = !generator_->getNextFromStream(ii, stream.pending);
+					progressed = true;
+					if (stream.ended)
+					{
+						TLOG(TLVL_DEBUG + 33) << "Stream " << ii << " reached end-of-data";
+					}
+				}
+				if (flush_(stream) && stream.ended)
+				{
+					stream.done.store(true, std::memory_order_release);
+					notifyConsumer_();
+				}
+			}
+
+			if (!active) break;
+			if (!progressed)
+			{
+				// All of this worker's queues are full; wait for getNext to drain them
+				std::this_thread::sleep_for(std::chrono::microseconds(50));
+			}
+		}
+	}
+	catch (...)
+	{
+		TLOG(TLVL_ERROR) << "Generator stream thread " << worker << " caught an exception, stopping";
+		{
+			std::lock_guard<std::mutex> lk(error_mutex_);
+			if (!error_) error_ = std::current_exception();
+		}
+		stop_requested_ = true;
+		notifyConsumer_();
+	}
+	TLOG(TLVL_DEBUG + 33) << "Generator stream thread " << worker << " exiting";
+}
+
+bool artdaq::ParallelGeneratorDriver::flush_(Stream& stream)
+{
+	bool pushed = false;
+	while (!stream.pending.empty() && stream.queue.push(std::move(stream.pending.front())))
+	{
+		stream.pending.pop_front();
+		pushed = true;
+	}
+	if (pushed) notifyConsumer_();
+	return stream.pending.empty();
+}
+
+void artdaq::ParallelGeneratorDriver::notifyConsumer_()
+{
+	if (consumer_waiting_)
+	{
+		std::lock_guard<std::mutex> lk(wait_mutex_);
+		wait_cv_.notify_one();
+	}
+}
@@ -0,0 +1,213 @@
+#ifndef artdaq_core_Plugins_ParallelGeneratorDriver_hh
+#define artdaq_core_Plugins_ParallelGeneratorDriver_hh
+
+////////////////////////////////////////////////////////////////////////
+// ParallelGeneratorDriver runs the streams of a FragmentGenerator on a
+// pool of threads, and presents the merged output through the usual
+// single-threaded FragmentGenerator interface:
+//
+//   auto gen = artdaq::makeFragmentGenerator("MyMultiLinkReader", ps);
+//   artdaq::ParallelGeneratorDriver driver(std::move(gen), 4);
+//   artdaq::FragmentPtrs frags;
+//   while (driver.getNext(frags)) { ... }
+//
+// Each stream is always read by the same worker thread, which pushes
+// its Fragments into a per-stream lock-free queue; getNext() drains all
+// of the queues.
+////////////////////////////////////////////////////////////////////////
+
+#include "artdaq-core/Plugins/FragmentGenerator.hh"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <boost/thread.hpp>
+
+namespace artdaq {
+namespace detail {
+/**
+ * \brief A bounded, lock-free queue for exactly one producer thread and one consumer thread
+ * \tparam T Type of the queued values (must be default-constructible and movable)
+ */
+template<typename T>
+class SPSCQueue
+{
+public:
+	/**
+	 * \brief SPSCQueue Constructor
+	 * \param capacity Minimum number of values the queue can hold (rounded up to a power of two)
+	 */
+	explicit SPSCQueue(size_t capacity)
+	    : slots_(round_up_(capacity))
+	    , mask_(slots_.size() - 1)
+	{}
+
+	/**
+	 * \brief Add a value to the queue. Must only be called from the producer thread.
+	 * \param value Value to add. It is only moved from if the push succeeds.
+	 * \return Whether the value was added (false if the queue is full)
+	 */
+	bool push(T&& value)
+	{
+		auto head = head_.load(std::memory_order_relaxed);
+		if (head - tail_cache_ == slots_.size())
+		{
+			tail_cache_ = tail_.load(std::memory_order_acquire);
+			if (head - tail_cache_ == slots_.size()) return false;
+		}
+		slots_[head & mask_] = std::move(value);
+		head_.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * \brief Remove a value from the queue. Must only be called from the consumer thread.
+	 * \param value Set to the removed value
+	 * \return Whether a value was removed (false if the queue is empty)
+	 */
+	bool pop(T& value)
+	{
+		auto tail = tail_.load(std::memory_order_relaxed);
+		if (tail == head_cache_)
+		{
+			head_cache_ = head_.load(std::memory_order_acquire);
+			if (tail == head_cache_) return false;
+		}
+		value = std::move(slots_[tail & mask_]);
+		tail_.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * \brief Check whether the queue is empty
+	 * \return Whether the queue was empty at the time of the call
+	 */
+	bool empty() const { return tail_.load(std::memory_order_acquire) == head_.load(std::memory_order_acquire); }
+
+	/**
+	 * \brief Get the number of values the queue can hold
+	 * \return The capacity of the queue
+	 */
+	size_t capacity() const { return slots_.size(); }
+
+private:
+	static size_t round_up_(size_t capacity)
+	{
+		size_t size = 1;
+		while (size < capacity) size <<= 1;
+		return size;
+	}
+
+	std::vector<T> slots_;
+	size_t mask_;
+
+	// Producer and consumer indices are kept on separate cache lines, each with a cached copy of the other's
+	alignas(64) std::atomic<size_t> head_{0};
+	size_t tail_cache_{0};
+	alignas(64) std::atomic<size_t> tail_{0};
+	size_t head_cache_{0};
+};
+}  // namespace detail
+
+/**
+ * \brief Runs the streams of a FragmentGenerator (see FragmentGenerator::numStreams) in parallel
+ *
+ * The ParallelGeneratorDriver is itself a FragmentGenerator, so it can be used anywhere a single-threaded
+ * generator is expected. Worker threads are started by the first call to getNext(), and stream s is
+ * always read by worker (s % threadCount()). Each worker pushes the Fragments from its streams into
+ * per-stream lock-free queues; when a queue is full, that stream is not read again until it drains.
+ * getNext() returns the Fragments available from all streams, and returns false once every stream has
+ * reached end-of-data and all of its Fragments have been returned.
+ */
+class ParallelGeneratorDriver : public FragmentGenerator
+{
+public:
+	/**
+	 * \brief ParallelGeneratorDriver Constructor
+	 * \param generator FragmentGenerator whose streams should be read
+	 * \param threads Number of worker threads (0 for one per stream, up to the number of hardware threads)
+	 * \param queue_capacity Number of Fragments which may be buffered for each stream
+	 * \exception cet::exception if the generator has no streams
+	 */
+	explicit ParallelGeneratorDriver(std::unique_ptr<FragmentGenerator> generator, size_t threads = 0, size_t queue_capacity = 1024);
+
+	/**
+	 * \brief ParallelGeneratorDriver Destructor. Stops and joins the worker threads
+	 */
+	~ParallelGeneratorDriver() override;
+
+	/**
+	 * \brief Obtain the Fragments which have been read from any stream, waiting until at least one is available
+	 * \param output New FragmentPtr objects will be added to this FragmentPtrs object.
+	 * \return False once all streams have reached end-of-data, or stop() has been called
+	 * \exception Rethrows any exception thrown by the generator on a worker thread
+	 */
+	bool getNext(FragmentPtrs& output) override;
+
+	/**
+	 * \brief Which fragment IDs does the underlying FragmentGenerator generate?
+	 * \return The fragment IDs of the underlying FragmentGenerator
+	 */
+	std::vector<Fragment::fragment_id_t> fragmentIDs() override { return generator_->fragmentIDs(); }
+
+	/**
+	 * \brief Start the worker threads, if they are not already running. Called automatically by getNext().
+	 */
+	void start();
+
+	/**
+	 * \brief Stop the worker threads. Fragments which were already queued are discarded.
+	 *
+	 * Workers finish their current call to getNextFromStream before stopping.
+	 */
+	void stop();
+
+	/**
+	 * \brief Get the number of worker threads
+	 * \return The number of worker threads used to read streams
+	 */
+	size_t threadCount() const { return thread_count_; }
+
+private:
+	ParallelGeneratorDriver(ParallelGeneratorDriver const&) = delete;
+	ParallelGeneratorDriver(ParallelGeneratorDriver&&) = delete;
+	ParallelGeneratorDriver& operator=(ParallelGeneratorDriver const&) = delete;
+	ParallelGeneratorDriver& operator=(ParallelGeneratorDriver&&) = delete;
+
+	struct Stream
+	{
+		explicit Stream(size_t capacity)
+		    : queue(capacity) {}
+
+		detail::SPSCQueue<FragmentPtr> queue;  // Written by the worker, read by getNext
+		std::atomic<bool> done{false};          // Set once the stream has reached end-of-data and all of its Fragments are queued
+		FragmentPtrs pending;                   // Fragments read by the worker which did not yet fit in the queue
+		bool ended{false};                      // Worker-side end-of-data flag
+	};
+
+	void runWorker_(size_t worker);
+	bool flush_(Stream& stream);
+	void notifyConsumer_();
+
+	std::unique_ptr<FragmentGenerator> generator_;
+	size_t thread_count_;
+	std::vector<std::unique_ptr<Stream>> streams_;
+	std::vector<std::unique_ptr<boost::thread>> workers_;
+	bool started_{false};
+
+	std::atomic<bool> stop_requested_{false};
+	std::atomic<bool> consumer_waiting_{false};
+	std::mutex wait_mutex_;
+	std::condition_variable wait_cv_;
+
+	std::mutex error_mutex_;
+	std::exception_ptr error_;
+};
+}  // namespace artdaq
+
+#endif /* artdaq_core_Plugins_ParallelGeneratorDriver_hh */
@@ -0,0 +1,168 @@
+#ifndef artdaq_core_Plugins_SyntheticFragmentGenerator_hh
+#define artdaq_core_Plugins_SyntheticFragmentGenerator_hh
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "artdaq-core/Data/Fragment.hh"
+#include "artdaq-core/Data/FragmentBatch.hh"
+#include "artdaq-core/Plugins/FragmentGenerator.hh"
+
+namespace fhicl {
+class ParameterSet;
+}
+
+namespace artdaq {
+/**
+ * \brief A FragmentGenerator which generates synthetic data, for testing the throughput of the data chain without hardware
+ *
+ * Each "event" is one sequence ID, for which one Fragment is generated for each configured Fragment ID. The
+ * Fragment IDs are divided between numStreams() streams, so that the generator can be run by a
+ * ParallelGeneratorDriver; getNext() and getNextBatch() generate the next event(s) of every stream in turn.
+ *
+ * Payload contents are generated without per-word random number generation, so that generation is
+ * limited by memory bandwidth rather than by the generator.
+ */
+class SyntheticFragmentGenerator : public FragmentGenerator
+{
+public:
+	/**
+	 * \brief How the payload size of each Fragment is chosen
+	 */
+	enum class SizeDistribution
+	{
+		Fixed,       ///< Every payload is payload_size_bytes
+		Uniform,     ///< Payloads are uniformly distributed between payload_size_min_bytes and payload_size_max_bytes
+		Exponential  ///< Payloads are exponentially distributed with mean payload_size_bytes, limited to payload_size_min_bytes to payload_size_max_bytes
+	};
+
+	/**
+	 * \brief What the payload of each Fragment contains
+	 */
+	enum class PayloadPattern
+	{
+		None,     ///< Payload is left uninitialized (fastest; contents are undefined)
+		Zero,     ///< Payload is all zeros
+		Counter,  ///< Word i of the payload is sequence_id + i
+		Random    ///< Payload is copied from a block of pseudo-random data, starting at a varying offset
+	};
+
+	/**
+	 * \brief SyntheticFragmentGenerator Constructor
+	 * \param ps ParameterSet used to configure the SyntheticFragmentGenerator
+	 *
+	 * \verbatim
+	 SyntheticFragmentGenerator accepts the following Parameters:
+	 "fragment_ids" (Default: []): List of Fragment IDs to generate. If empty, "fragment_id_count" IDs starting at "first_fragment_id" are generated
+	 "first_fragment_id" (Default: 0): First Fragment ID to generate, if "fragment_ids" is empty
+	 "fragment_id_count" (Default: 1): Number of Fragment IDs to generate, if "fragment_ids" is empty
+	 "streams" (Default: 1): Number of streams to divide the Fragment IDs between (see ParallelGeneratorDriver)
+	 "fragment_type" (Default: 1): Type of the generated Fragments (must be a user type)
+	 "size_distribution" (Default: "fixed"): How payload sizes are chosen: "fixed", "uniform" or "exponential"
+	 "payload_size_bytes" (Default: 1024): Payload size of each Fragment (mean payload size for "exponential")
+	 "payload_size_min_bytes" (Default: 0): Smallest payload size for "uniform" and "exponential"
+	 "payload_size_max_bytes" (Default: 2 * payload_size_bytes): Largest payload size for "uniform" and "exponential"
+	 "payload_pattern" (Default: "counter"): Payload contents: "none", "zero", "counter" or "random"
+	 "fragments_per_container" (Default: 0): If non-zero, each generated Fragment is a ContainerFragment holding this many Fragments of the configured type
+	 "events_per_call" (Default: 1): Number of sequence IDs generated by each call to getNext, per stream
+	 "rate_hz" (Default: 0): Maximum number of sequence IDs generated per second, per stream (0 for no limit)
+	 "max_events" (Default: 0): Number of sequence IDs to generate before signaling end-of-data (0 for no limit)
+	 "first_sequence_id" (Default: 1): Sequence ID of the first event
+	 "timestamp_scale" (Default: 1): Timestamps are set to the sequence ID multiplied by this value
+	 "random_seed" (Default: 1): Seed for payload sizes and "random" payload data
+	 \endverbatim
+	 * \exception cet::exception if the configuration is inconsistent
+	 */
+	explicit SyntheticFragmentGenerator(fhicl::ParameterSet const& ps);
+
+	/**
+	 * \brief SyntheticFragmentGenerator Destructor
+	 */
+	~SyntheticFragmentGenerator() override;
+
+	/**
+	 * \brief Generate the next event(s) of every stream
+	 * \param output Generated Fragments will be added to this FragmentPtrs object
+	 * \return False once max_events events have been generated on every stream
+	 */
+	bool getNext(FragmentPtrs& output) override;
+
+	/**
+	 * \brief Generate the next event(s) of every stream into a FragmentBatch
+	 * \param output Generated Fragments will be appended to this FragmentBatch
+	 * \return False once max_events events have been generated on every stream
+	 */
+	bool getNextBatch(FragmentBatch& output) override;
+
+	/**
+	 * \brief Get the number of streams the Fragment IDs are divided between
+	 * \return The configured number of streams
+	 */
+	size_t numStreams() override { return streams_.size(); }
+
+	/**
+	 * \brief Generate the next event(s) of one stream
+	 * \param stream Stream to generate
+	 * \param output Generated Fragments will be added to this FragmentPtrs object
+	 * \return False once max_events events have been generated on this stream
+	 * \exception cet::exception if stream is out of range
+	 */
+	bool getNextFromStream(size_t stream, FragmentPtrs& output) override;
+
+	/**
+	 * \brief Get the Fragment IDs generated by the SyntheticFragmentGenerator
+	 * \return All configured Fragment IDs
+	 */
+	std::vector<Fragment::fragment_id_t> fragmentIDs() override { return fragment_ids_; }
+
+private:
+	SyntheticFragmentGenerator(SyntheticFragmentGenerator const&) = delete;
+	SyntheticFragmentGenerator(SyntheticFragmentGenerator&&) = delete;
+	SyntheticFragmentGenerator& operator=(SyntheticFragmentGenerator const&) = delete;
+	SyntheticFragmentGenerator& operator=(SyntheticFragmentGenerator&&) = delete;
+
+	struct StreamState
+	{
+		std::vector<Fragment::fragment_id_t> fragment_ids;
+		Fragment::sequence_id_t next_sequence_id{0};
+		uint64_t events_generated{0};
+		uint64_t rng_state{0};
+		std::chrono::steady_clock::time_point start_time;
+		FragmentBatch container_scratch;  // Fragments being packed into a ContainerFragment
+		Fragment container;               // ContainerFragment being built for a FragmentBatch, reused so that it keeps its capacity
+	};
+
+	// Generate the next events_per_call events of the stream into output. getNext, getNextFromStream and
+	// getNextBatch all use this, so they generate the same events. Returns false once the stream has generated max_events events.
+	template<class Output>
+	bool generateEvents_(StreamState& stream, Output& output);
+	// Returns false if the stream has generated max_events events
+	bool beginEvent_(StreamState& stream);
+	// Generate one Fragment (or ContainerFragment) and add it to the output
+	void appendFragment_(StreamState& stream, Fragment::sequence_id_t sequence_id, Fragment::fragment_id_t fragment_id, FragmentPtrs& output);
+	void appendFragment_(StreamState& stream, Fragment::sequence_id_t sequence_id, Fragment::fragment_id_t fragment_id, FragmentBatch& output);
+	size_t nextPayloadWords_(StreamState& stream);
+	void fillPayload_(StreamState& stream, RawDataType* payload, size_t words, Fragment::sequence_id_t sequence_id);
+	// Generate the contained Fragments into frag, which must hold only a Fragment header
+	void fillContainer_(StreamState& stream, Fragment& frag);
+
+	std::vector<Fragment::fragment_id_t> fragment_ids_;
+	std::vector<StreamState> streams_;
+	Fragment::type_t fragment_type_;
+	SizeDistribution size_distribution_;
+	size_t payload_words_;
+	size_t payload_min_words_;
+	size_t payload_max_words_;
+	PayloadPattern payload_pattern_;
+	size_t fragments_per_container_;
+	size_t events_per_call_;
+	double rate_hz_;
+	uint64_t max_events_;
+	Fragment::timestamp_t timestamp_scale_;
+	std::vector<RawDataType> random_block_;  // Source of "random" payloads, a few thousand words longer than the largest payload
+};
+}  // namespace artdaq
+
+#endif /* artdaq_core_Plugins_SyntheticFragmentGenerator_hh */
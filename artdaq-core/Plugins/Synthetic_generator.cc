@@ -0,0 +1,306 @@
+#define TRACE_NAME "SyntheticGenerator"
+#include "artdaq-core/Plugins/SyntheticFragmentGenerator.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+#include "TRACE/tracemf.h"
+#include "artdaq-core/Data/ContainerFragmentLoader.hh"
+#include "artdaq-core/Plugins/GeneratorMacros.hh"
+#include "fhiclcpp/ParameterSet.h"
+
+namespace {
+// Number of distinct starting offsets into the block of random data used for "random" payloads
+constexpr size_t RANDOM_OFFSETS = 4096;
+
+// xorshift64*: fast, and plenty for choosing sizes and generating filler data
+uint64_t next_random(uint64_t& state)
+{
+	state ^= state >> 12;
+	state ^= state << 25;
+	state ^= state >> 27;
+	return state * 0x2545F4914F6CDD1DULL;
+}
+
+size_t bytes_to_words(size_t bytes)
+{
+	return (bytes + sizeof(artdaq::RawDataType) - 1) / sizeof(artdaq::RawDataType);
+}
+}  // namespace
+
+artdaq::SyntheticFragmentGenerator::SyntheticFragmentGenerator(fhicl::ParameterSet const& ps)
+    : fragment_type_(static_cast<Fragment::type_t>(ps.get<int>("fragment_type", Fragment::FirstUserFragmentType)))
+    , payload_words_(bytes_to_words(ps.get<size_t>("payload_size_bytes", 1024)))
+    , payload_min_words_(bytes_to_words(ps.get<size_t>("payload_size_min_bytes", 0)))
+    , payload_max_words_(bytes_to_words(ps.get<size_t>("payload_size_max_bytes", 2 * ps.get<size_t>("payload_size_bytes", 1024))))
+    , fragments_per_container_(ps.get<size_t>("fragments_per_container", 0))
+    , events_per_call_(ps.get<size_t>("events_per_call", 1))
+    , rate_hz_(ps.get<double>("rate_hz", 0.0))
+    , max_events_(ps.get<uint64_t>("max_events", 0))
+    , timestamp_scale_(ps.get<Fragment::timestamp_t>("timestamp_scale", 1))
+{
+	auto ids = ps.get<std::vector<int>>("fragment_ids", std::vector<int>());
+	if (ids.empty())
+	{
+		auto first = ps.get<int>("first_fragment_id", 0);
+		auto count = ps.get<int>("fragment_id_count", 1);
+		for (int ii = 0; ii < count; ++ii)
+		{
+			ids.push_back(first + ii);
+		}
+	}
+	for (auto id : ids)
+	{
+		fragment_ids_.push_back(static_cast<Fragment::fragment_id_t>(id));
+	}
+
+	auto stream_count = ps.get<size_t>("streams", 1);
+	if (fragment_ids_.empty() || stream_count == 0 || stream_count > fragment_ids_.size())
+	{
+		throw cet::exception("SyntheticFragmentGenerator") << "Cannot divide " << fragment_ids_.size() << " Fragment IDs between " << stream_count << " streams!";  // NOLINT(cert-err60-cpp)
+	}
+	if (!Fragment::isUserFragmentType(fragment_type_))
+	{
+		throw cet::exception("SyntheticFragmentGenerator") << "fragment_type must be a user type, not " << static_cast<int>(fragment_type_) << "!";  // NOLINT(cert-err60-cpp)
+	}
+	if (events_per_call_ == 0)
+	{
+		throw cet::exception("SyntheticFragmentGenerator") << "events_per_call must be at least 1!";  // NOLINT(cert-err60-cpp)
+	}
+
+	auto distribution = ps.get<std::string>("size_distribution", "fixed");
+	if (distribution == "fixed")
+	{
+		size_distribution_ = SizeDistribution::Fixed;
+		payload_min_words_ = payload_max_words_ = payload_words_;
+	}
+	else if (distribution == "uniform")
+	{
+		size_distribution_ = SizeDistribution::Uniform;
+	}
+	else if (distribution == "exponential")
+	{
+		size_distribution_ = SizeDistribution::Exponential;
+	}
+	else
+	{
+		throw cet::exception("SyntheticFragmentGenerator") << "Unknown size_distribution \"" << distribution << "\"! Must be \"fixed\", \"uniform\" or \"exponential\".";  // NOLINT(cert-err60-cpp)
+	}
+	if (payload_min_words_ > payload_max_words_)
+	{
+		throw cet::exception("SyntheticFragmentGenerator") << "payload_size_min_bytes must not be larger than payload_size_max_bytes!";  // NOLINT(cert-err60-cpp)
+	}
+
+	auto pattern = ps.get<std::string>("payload_pattern", "counter");
+	if (pattern == "none")
+	{
+		payload_pattern_ = PayloadPattern::None;
+	}
+	else if (pattern == "zero")
+	{
+		payload_pattern_ = PayloadPattern::Zero;
+	}
+	else if (pattern == "counter")
+	{
+		payload_pattern_ = PayloadPattern::Counter;
+	}
+	else if (pattern == "random")
+	{
+		payload_pattern_ = PayloadPattern::Random;
+	}
+	else
+	{
+		throw cet::exception("SyntheticFragmentGenerator") << "Unknown payload_pattern \"" << pattern << "\"! Must be \"none\", \"zero\", \"counter\" or \"random\".";  // NOLINT(cert-err60-cpp)
+	}
+
+	auto seed = ps.get<uint64_t>("random_seed", 1);
+	if (payload_pattern_ == PayloadPattern::Random)
+	{
+		uint64_t state = seed | 1;
+		random_block_.resize(payload_max_words_ + RANDOM_OFFSETS);
+		for (auto& word : random_block_)
+		{
+			word = next_random(state);
+		}
+	}
+
+	streams_.resize(stream_count);
+	for (size_t ii = 0; ii < fragment_ids_.size(); ++ii)
+	{
+		streams_[ii % stream_count].fragment_ids.push_back(fragment_ids_[ii]);
+	}
+	auto first_sequence_id = ps.get<Fragment::sequence_id_t>("first_sequence_id", 1);
+	for (size_t ii = 0; ii < stream_count; ++ii)
+	{
+		streams_[ii].next_sequence_id = first_sequence_id;
+		streams_[ii].rng_state = (seed + ii * 0x9E3779B97F4A7C15ULL) | 1;
+	}
+
+	TLOG(TLVL_INFO) << "Generating " << fragment_ids_.size() << " Fragment IDs in " << stream_count << " streams, payload " << distribution << " " << payload_min_words_ * sizeof(RawDataType) << "-" << payload_max_words_ * sizeof(RawDataType)
+	                << " bytes (" << pattern << "), " << fragments_per_container_ << " Fragments per container, rate limit " << rate_hz_ << " Hz";
+}
+
+artdaq::SyntheticFragmentGenerator::~SyntheticFragmentGenerator() = default;
+
+bool artdaq::SyntheticFragmentGenerator::getNext(FragmentPtrs& output)
+{
+	bool more = false;
+	for (size_t ii = 0; ii < streams_.size(); ++ii)
+	{
+		more = getNextFromStream(ii, output) || more;
+	}
+	return more;
+}
+
+bool artdaq::SyntheticFragmentGenerator::getNextFromStream(size_t stream, FragmentPtrs& output)
+{
+	if (stream >= streams_.size())
+	{
+		throw cet::exception("ArgumentOutOfRange") << "SyntheticFragmentGenerator was asked for stream " << stream << ", but only has " << streams_.size() << " streams!";  // NOLINT(cert-err60-cpp)
+	}
+	return generateEvents_(streams_[stream], output);
+}
+
+bool artdaq::SyntheticFragmentGenerator::getNextBatch(FragmentBatch& output)
+{
+	bool more = false;
+	for (auto& state : streams_)
+	{
+		more = generateEvents_(state, output) || more;
+	}
+	return more;
+}
+
+template<class Output>
+bool artdaq::SyntheticFragmentGenerator::generateEvents_(StreamState& stream, Output& output)
+{
+	for (size_t ii = 0; ii < events_per_call_; ++ii)
+	{
+		if (!beginEvent_(stream)) break;
+		auto sequence_id = stream.next_sequence_id++;
+		for (auto fragment_id : stream.fragment_ids)
+		{
+			appendFragment_(stream, sequence_id, fragment_id, output);
+		}
+		++stream.events_generated;
+	}
+	return max_events_ == 0 || stream.events_generated < max_events_;
+}
+
+bool artdaq::SyntheticFragmentGenerator::beginEvent_(StreamState& stream)
+{
+	if (max_events_ != 0 && stream.events_generated >= max_events_) return false;
+
+	if (rate_hz_ > 0)
+	{
+		auto now = std::chrono::steady_clock::now();
+		if (stream.events_generated == 0) stream.start_time = now;
+		auto due = stream.start_time + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(stream.events_generated / rate_hz_));
+		if (now < due) std::this_thread::sleep_until(due);
+	}
+	return true;
+}
+
+size_t artdaq::SyntheticFragmentGenerator::nextPayloadWords_(StreamState& stream)
+{
+	switch (size_distribution_)
+	{
+		case SizeDistribution::Fixed:
+			return payload_words_;
+		case SizeDistribution::Uniform:
+			return payload_min_words_ + next_random(stream.rng_state) % (payload_max_words_ - payload_min_words_ + 1);
+		case SizeDistribution::Exponential:
+		{
+			// Uniform in (0, 1], from the top 53 bits
+			auto uniform = static_cast<double>((next_random(stream.rng_state) >> 11) + 1) * 0x1.0p-53;
+			auto words = static_cast<size_t>(-std::log(uniform) * static_cast<double>(payload_words_));
+			return std::min(std::max(words, payload_min_words_), payload_max_words_);
+		}
+	}
+	return payload_words_;
+}
+
+void artdaq::SyntheticFragmentGenerator::fillPayload_(StreamState& stream, RawDataType* payload, size_t words, Fragment::sequence_id_t sequence_id)
+{
+	switch (payload_pattern_)
+	{
+		case PayloadPattern::None:
+			break;
+		case PayloadPattern::Zero:
+			memset(payload, 0, words * sizeof(RawDataType));
+			break;
+		case PayloadPattern::Counter:
+			for (size_t ii = 0; ii < words; ++ii)
+			{
+				payload[ii] = sequence_id + ii;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+			}
+			break;
+		case PayloadPattern::Random:
+			memcpy(payload, random_block_.data() + next_random(stream.rng_state) % RANDOM_OFFSETS, words * sizeof(RawDataType));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+			break;
+	}
+}
+
+void artdaq::SyntheticFragmentGenerator::appendFragment_(StreamState& stream, Fragment::sequence_id_t sequence_id, Fragment::fragment_id_t fragment_id, FragmentPtrs& output)
+{
+	if (fragments_per_container_ > 0)
+	{
+		auto frag = std::make_unique<Fragment>(sequence_id, fragment_id);
+		frag->setTimestamp(sequence_id * timestamp_scale_);
+		fillContainer_(stream, *frag);
+		output.push_back(std::move(frag));
+		return;
+	}
+	auto words = nextPayloadWords_(stream);
+	auto frag = std::make_unique<Fragment>(words);
+	frag->setSequenceID(sequence_id);
+	frag->setFragmentID(fragment_id);
+	frag->setUserType(fragment_type_);
+	frag->setTimestamp(sequence_id * timestamp_scale_);
+	fillPayload_(stream, frag->dataAddress(), words, sequence_id);
+	output.push_back(std::move(frag));
+}
+
+void artdaq::SyntheticFragmentGenerator::appendFragment_(StreamState& stream, Fragment::sequence_id_t sequence_id, Fragment::fragment_id_t fragment_id, FragmentBatch& output)
+{
+	if (fragments_per_container_ > 0)
+	{
+		// Reset the per-stream container to a bare header; copy-assignment keeps its capacity
+		static Fragment const header_only;
+		auto& frag = stream.container;
+		frag = header_only;
+		frag.setSequenceID(sequence_id);
+		frag.setFragmentID(fragment_id);
+		frag.setTimestamp(sequence_id * timestamp_scale_);
+		frag.touch();
+		fillContainer_(stream, frag);
+		output.append(frag);
+		return;
+	}
+	auto words = nextPayloadWords_(stream);
+	auto payload = output.append(words, sequence_id, fragment_id, fragment_type_, sequence_id * timestamp_scale_);
+	fillPayload_(stream, payload, words, sequence_id);
+}
+
+void artdaq::SyntheticFragmentGenerator::fillContainer_(StreamState& stream, Fragment& frag)
+{
+	auto sequence_id = frag.sequenceID();
+	auto fragment_id = frag.fragmentID();
+
+	// Generate the contained Fragments back-to-back, so that they can be added to the container with a single copy
+	auto& scratch = stream.container_scratch;
+	scratch.clear();
+	for (size_t ii = 0; ii < fragments_per_container_; ++ii)
+	{
+		auto words = nextPayloadWords_(stream);
+		auto payload = scratch.append(words, sequence_id, fragment_id, fragment_type_, sequence_id * timestamp_scale_);
+		fillPayload_(stream, payload, words, sequence_id);
+	}
+
+	ContainerFragmentLoader cfl(frag, fragment_type_, scratch.sizeBytes(), scratch.size());
+	cfl.addFragments(reinterpret_cast<detail::RawFragmentHeader const*>(scratch.data()), scratch.size());  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+}
+
+DEFINE_ARTDAQ_GENERATOR(artdaq::SyntheticFragmentGenerator)
@@ -1,8 +1,119 @@
 #include "artdaq-core/Utilities/TimeUtils.hh"
 #include <boost/date_time/posix_time/posix_time.hpp>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+
 namespace BPT = boost::posix_time;
 
+namespace {
+// Set once before first use of the access-time clock; -1 means "not yet configured"
+std::atomic<int> access_time_clock{-1};
+
+// TSC calibrations are published through tsc_calibration and never modified afterwards. Re-anchoring
+// writes the next slot of a ring, so a retired calibration is only overwritten after
+// TSC_CALIBRATION_SLOTS - 1 further re-anchors (at least that many seconds), long after any reader
+// that loaded it has finished with it.
+constexpr size_t TSC_CALIBRATION_SLOTS = 16;
+constexpr int64_t TSC_REANCHOR_INTERVAL_NS = 1000000000;
+std::array<artdaq::TimeUtils::TSCCalibration, TSC_CALIBRATION_SLOTS> tsc_calibrations;
+std::atomic<artdaq::TimeUtils::TSCCalibration const*> tsc_calibration{nullptr};
+std::once_flag tsc_calibrated;
+std::mutex tsc_reanchor_mutex;
+size_t tsc_next_slot = 0;                       // Guarded by tsc_reanchor_mutex
+artdaq::TimeUtils::TSCCalibration tsc_origin;  // First anchor, written once under tsc_calibrated
+
+bool tsc_is_invariant()
+{
+#if defined(__x86_64__) || defined(__i386__)
+	unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+	if (__get_cpuid_max(0x80000000, nullptr) < 0x80000007) return false;
+	__cpuid(0x80000007, eax, ebx, ecx, edx);
+	return (edx & (1 << 8)) != 0;
+#else
+	return false;
+#endif
+}
+
+int64_t realtime_ns()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_REALTIME, &ts);
+	return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+void measure_tsc()
+{
+	if (!tsc_is_invariant()) return;
+
+	auto start_ns = realtime_ns();
+	auto start_ticks = artdaq::TimeUtils::read_tsc();
+	std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	auto end_ns = realtime_ns();
+	auto end_ticks = artdaq::TimeUtils::read_tsc();
+
+	if (end_ticks <= start_ticks || end_ns <= start_ns) return;
+
+	tsc_origin.base_ticks = end_ticks;
+	tsc_origin.base_ns = end_ns;
+	tsc_origin.ns_per_tick = static_cast<double>(end_ns - start_ns) / static_cast<double>(end_ticks - start_ticks);
+
+	std::lock_guard<std::mutex> lk(tsc_reanchor_mutex);
+	tsc_calibrations[0] = tsc_origin;
+	tsc_next_slot = 1;
+	tsc_calibration.store(&tsc_calibrations[0], std::memory_order_release);
+}
+
+// Publish a new anchor at the current time. Only one thread re-anchors at a time; the others keep
+// using the calibration they already have.
+artdaq::TimeUtils::TSCCalibration const* reanchor_tsc(artdaq::TimeUtils::TSCCalibration const* current)
+{
+	std::unique_lock<std::mutex> lk(tsc_reanchor_mutex, std::try_to_lock);
+	if (!lk.owns_lock()) return current;
+	auto latest = tsc_calibration.load(std::memory_order_acquire);
+	if (latest != current) return latest;
+
+	auto now_ns = realtime_ns();
+	auto now_ticks = artdaq::TimeUtils::read_tsc();
+
+	auto& next = tsc_calibrations[tsc_next_slot];
+	tsc_next_slot = (tsc_next_slot + 1) % TSC_CALIBRATION_SLOTS;
+	next.base_ticks = now_ticks;
+	next.base_ns = now_ns;
+	next.ns_per_tick = current->ns_per_tick;
+
+	// Refine the tick length over the whole time since calibration, unless CLOCK_REALTIME has been stepped
+	if (now_ticks > tsc_origin.base_ticks && now_ns > tsc_origin.base_ns)
+	{
+		auto ns_per_tick = static_cast<double>(now_ns - tsc_origin.base_ns) / static_cast<double>(now_ticks - tsc_origin.base_ticks);
+		if (std::fabs(ns_per_tick / current->ns_per_tick - 1.0) < 0.001) next.ns_per_tick = ns_per_tick;
+	}
+
+	tsc_calibration.store(&next, std::memory_order_release);
+	return &next;
+}
+
+artdaq::TimeUtils::AccessTimeClock access_time_clock_from_environment()
+{
+	auto env = getenv("ARTDAQ_ACCESS_TIME_CLOCK");
+	if (env == nullptr) return artdaq::TimeUtils::AccessTimeClock::Realtime;
+	if (strcasecmp(env, "coarse") == 0) return artdaq::TimeUtils::AccessTimeClock::Coarse;
+	if (strcasecmp(env, "tsc") == 0) return artdaq::TimeUtils::AccessTimeClock::TSC;
+	if (strcasecmp(env, "disabled") == 0) return artdaq::TimeUtils::AccessTimeClock::Disabled;
+	return artdaq::TimeUtils::AccessTimeClock::Realtime;
+}
+}  // namespace
+
 std::string artdaq::TimeUtils::
     convertUnixTimeToString(time_t inputUnixTime)
 {
@@ -62,6 +173,91 @@ struct timespec artdaq::TimeUtils::get_realtime_clock()
 	return ts;
 }
 
+uint64_t artdaq::TimeUtils::read_tsc()
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return 0;
+#endif
+}
+
+artdaq::TimeUtils::TSCCalibration const* artdaq::TimeUtils::calibrate_tsc()
+{
+	std::call_once(tsc_calibrated, measure_tsc);
+	return tsc_calibration.load(std::memory_order_acquire);
+}
+
+artdaq::TimeUtils::TSCCalibration const* artdaq::TimeUtils::get_tsc_calibration()
+{
+	return tsc_calibration.load(std::memory_order_acquire);
+}
+
+void artdaq::TimeUtils::setAccessTimeClock(AccessTimeClock clock)
+{
+	if (clock == AccessTimeClock::TSC && calibrate_tsc() == nullptr)
+	{
+		clock = AccessTimeClock::Realtime;
+	}
+	access_time_clock.store(static_cast<int>(clock), std::memory_order_release);
+}
+
+artdaq::TimeUtils::AccessTimeClock artdaq::TimeUtils::getAccessTimeClock()
+{
+	auto clock = access_time_clock.load(std::memory_order_acquire);
+	if (clock < 0)
+	{
+		auto configured = access_time_clock_from_environment();
+		if (configured == AccessTimeClock::TSC && calibrate_tsc() == nullptr)
+		{
+			configured = AccessTimeClock::Realtime;
+		}
+		// Do not override a clock selected with setAccessTimeClock while the environment was being read
+		auto expected = -1;
+		access_time_clock.compare_exchange_strong(expected, static_cast<int>(configured), std::memory_order_acq_rel);
+		clock = access_time_clock.load(std::memory_order_acquire);
+	}
+	return static_cast<AccessTimeClock>(clock);
+}
+
+struct timespec artdaq::TimeUtils::get_access_time()
+{
+	struct timespec ts = {0, 0};
+	switch (getAccessTimeClock())
+	{
+		case AccessTimeClock::Realtime:
+			clock_gettime(CLOCK_REALTIME, &ts);
+			break;
+		case AccessTimeClock::Coarse:
+			clock_gettime(CLOCK_REALTIME_COARSE, &ts);
+			break;
+		case AccessTimeClock::TSC: {
+			auto calibration = tsc_calibration.load(std::memory_order_acquire);
+			auto ticks = read_tsc();
+			// Signed, so that a counter slightly behind the anchor (e.g. read on another socket) clamps to the anchor instead of wrapping
+			auto elapsed_ticks = std::max(static_cast<int64_t>(ticks - calibration->base_ticks), int64_t{0});
+			auto elapsed_ns = static_cast<int64_t>(static_cast<double>(elapsed_ticks) * calibration->ns_per_tick);
+			if (elapsed_ns > TSC_REANCHOR_INTERVAL_NS)
+			{
+				auto reanchored = reanchor_tsc(calibration);
+				if (reanchored != calibration)
+				{
+					calibration = reanchored;
+					elapsed_ticks = std::max(static_cast<int64_t>(ticks - calibration->base_ticks), int64_t{0});
+					elapsed_ns = static_cast<int64_t>(static_cast<double>(elapsed_ticks) * calibration->ns_per_tick);
+				}
+			}
+			auto ns = calibration->base_ns + elapsed_ns;
+			ts.tv_sec = ns / 1000000000;
+			ts.tv_nsec = ns % 1000000000;
+			break;
+		}
+		case AccessTimeClock::Disabled:
+			break;
+	}
+	return ts;
+}
+
 double artdaq::TimeUtils::
     convertUnixTimeToSeconds(time_t inputUnixTime)
 {
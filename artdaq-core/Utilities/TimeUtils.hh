@@ -3,6 +3,7 @@
 
 #include <sys/time.h>
 #include <chrono>
+#include <cstdint>
 #include <string>
 
 namespace artdaq {
@@ -60,6 +61,80 @@ inline size_t GetElapsedTimeMilliseconds(std::chrono::steady_clock::time_point t
  */
 struct timespec get_realtime_clock();
 
+/**
+ * \brief Clock sources which may be used for Fragment access times (see RawFragmentHeader::touch)
+ *
+ * The access-time clock is selected per process, either with setAccessTimeClock or with the
+ * ARTDAQ_ACCESS_TIME_CLOCK environment variable ("realtime", "coarse", "tsc" or "disabled"),
+ * which is read the first time an access time is requested.
+ */
+enum class AccessTimeClock
+{
+	Realtime,  ///< clock_gettime(CLOCK_REALTIME) (default)
+	Coarse,    ///< clock_gettime(CLOCK_REALTIME_COARSE): kernel-tick resolution (~1-4 ms), but much cheaper to read
+	TSC,       ///< CPU time-stamp counter, calibrated against CLOCK_REALTIME (see calibrate_tsc). Falls back to Realtime if no invariant TSC is available
+	Disabled   ///< Access times are not recorded: get_access_time returns zero, and Fragment latencies are reported as zero
+};
+
+/**
+ * \brief Select the clock used for Fragment access times in this process
+ * \param clock The clock source to use
+ *
+ * The first selection of AccessTimeClock::TSC in a process performs a short (~10 ms) calibration
+ * against CLOCK_REALTIME (see calibrate_tsc); later selections reuse it.
+ */
+void setAccessTimeClock(AccessTimeClock clock);
+
+/**
+ * \brief Get the clock currently used for Fragment access times in this process
+ * \return The AccessTimeClock in use
+ */
+AccessTimeClock getAccessTimeClock();
+
+/**
+ * \brief Calibration of the CPU time-stamp counter against CLOCK_REALTIME
+ *
+ * A published calibration is never modified. Instead, the TSC access-time clock re-anchors itself
+ * to CLOCK_REALTIME about once per second by publishing a new calibration, so that access times
+ * from different processes (and getLatency) stay consistent with CLOCK_REALTIME to within the
+ * drift accumulated over one second.
+ */
+struct TSCCalibration
+{
+	uint64_t base_ticks;  ///< TSC value at the anchor point
+	int64_t base_ns;      ///< CLOCK_REALTIME at the anchor point, in ns since the epoch
+	double ns_per_tick;   ///< Length of one TSC tick, in ns
+};
+
+/**
+ * \brief Read the CPU time-stamp counter
+ * \return The current TSC value (0 on platforms without one)
+ */
+uint64_t read_tsc();
+
+/**
+ * \brief Calibrate the CPU time-stamp counter against CLOCK_REALTIME, once per process
+ * \return The current calibration, or nullptr if there is no invariant TSC
+ *
+ * The first call blocks for ~10 ms while the calibration is measured; concurrent callers wait for it.
+ * Later calls return the current calibration immediately and never re-calibrate.
+ */
+TSCCalibration const* calibrate_tsc();
+
+/**
+ * \brief Get the current TSC calibration, without calibrating
+ * \return The current calibration, or nullptr if calibrate_tsc has not completed successfully
+ *
+ * The returned calibration remains valid for at least several seconds after it is replaced by a re-anchor.
+ */
+TSCCalibration const* get_tsc_calibration();
+
+/**
+ * \brief Get the current time from the configured access-time clock
+ * \return Pair of seconds, nanoseconds wallclock time, or zero if the access-time clock is Disabled
+ */
+struct timespec get_access_time();
+
 /// <summary>
 /// Get the elapsed time between two struct timespec instances.
 ///
@@ -0,0 +1,116 @@
+#include "artdaq-core/Core/LogLinearHistogram.hh"
+
+#define BOOST_TEST_MODULE(LogLinearHistogram_t)
+#include "cetlib/quiet_unit_test.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(LogLinearHistogram_test)
+
+BOOST_AUTO_TEST_CASE(BucketIndex)
+{
+	typedef artdaq::LogLinearHistogram H;
+
+	// Underflow: zero, negative, NaN and values below 2^MIN_EXPONENT
+	BOOST_REQUIRE_EQUAL(H::bucketIndex(0.0), 0);
+	BOOST_REQUIRE_EQUAL(H::bucketIndex(-1.0), 0);
+	BOOST_REQUIRE_EQUAL(H::bucketIndex(std::numeric_limits<double>::quiet_NaN()), 0);
+	BOOST_REQUIRE_EQUAL(H::bucketIndex(std::ldexp(1.0, H::MIN_EXPONENT - 1)), 0);
+	BOOST_REQUIRE_EQUAL(H::bucketIndex(std::ldexp(1.0, H::MIN_EXPONENT)), 0);
+
+	// Overflow
+	BOOST_REQUIRE_EQUAL(H::bucketIndex(std::ldexp(1.0, H::MIN_EXPONENT + static_cast<int>(H::OCTAVES))), H::BUCKET_COUNT - 1);
+	BOOST_REQUIRE_EQUAL(H::bucketIndex(std::numeric_limits<double>::infinity()), H::BUCKET_COUNT - 1);
+
+	// Powers of two start a new octave, and each octave is divided into SUB_BUCKETS
+	auto one = static_cast<size_t>(-H::MIN_EXPONENT) * H::SUB_BUCKETS;
+	BOOST_REQUIRE_EQUAL(H::bucketIndex(1.0), one);
+	BOOST_REQUIRE_EQUAL(H::bucketIndex(1.0 + 1.0 / H::SUB_BUCKETS), one + 1);
+	BOOST_REQUIRE_EQUAL(H::bucketIndex(2.0 - 1e-12), one + H::SUB_BUCKETS - 1);
+	BOOST_REQUIRE_EQUAL(H::bucketIndex(2.0), one + H::SUB_BUCKETS);
+	BOOST_REQUIRE_EQUAL(H::bucketIndex(0.5), one - H::SUB_BUCKETS);
+}
+
+BOOST_AUTO_TEST_CASE(BucketBounds)
+{
+	typedef artdaq::LogLinearHistogram H;
+
+	BOOST_REQUIRE_EQUAL(H::bucketLowerBound(static_cast<size_t>(-H::MIN_EXPONENT) * H::SUB_BUCKETS), 1.0);
+	BOOST_REQUIRE_EQUAL(H::bucketUpperBound(static_cast<size_t>(-H::MIN_EXPONENT) * H::SUB_BUCKETS), 1.0 + 1.0 / H::SUB_BUCKETS);
+	for (size_t bucket = 1; bucket + 1 < H::BUCKET_COUNT; ++bucket)
+	{
+		BOOST_REQUIRE_EQUAL(H::bucketUpperBound(bucket), H::bucketLowerBound(bucket + 1));
+		BOOST_REQUIRE_EQUAL(H::bucketIndex(H::bucketLowerBound(bucket)), bucket);
+	}
+
+	// Every value in range is within its bucket, and the bucket is at most 1/SUB_BUCKETS of the value wide
+	std::mt19937_64 gen(42);
+	std::uniform_real_distribution<double> exponent(-30.0, 30.0);
+	for (int ii = 0; ii < 100000; ++ii)
+	{
+		auto value = std::exp2(exponent(gen));
+		auto bucket = H::bucketIndex(value);
+		BOOST_REQUIRE_LE(H::bucketLowerBound(bucket), value);
+		BOOST_REQUIRE_LT(value, H::bucketUpperBound(bucket));
+		BOOST_REQUIRE_LE(H::bucketUpperBound(bucket) - H::bucketLowerBound(bucket), value / H::SUB_BUCKETS);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(QuantileAccuracy)
+{
+	typedef artdaq::LogLinearHistogram H;
+
+	H histogram;
+	BOOST_REQUIRE_EQUAL(histogram.quantile(0.5), 0.0);
+
+	// Log-normal values, like latencies
+	std::mt19937_64 gen(7);
+	std::lognormal_distribution<double> dist(0.0, 2.0);
+	std::vector<double> values(200000);
+	for (auto& value : values)
+	{
+		value = dist(gen);
+		histogram.record(value);
+	}
+	std::sort(values.begin(), values.end());
+	BOOST_REQUIRE_EQUAL(histogram.totalCount(), values.size());
+
+	for (auto q : {0.0, 0.01, 0.1, 0.25, 0.5, 0.75, 0.9, 0.99, 0.999, 1.0})
+	{
+		auto rank = static_cast<size_t>(std::ceil(q * static_cast<double>(values.size())));
+		auto exact = values[rank == 0 ? 0 : rank - 1];
+		BOOST_REQUIRE_LE(std::fabs(histogram.quantile(q) - exact), exact / H::SUB_BUCKETS);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(MergeAndSubtract)
+{
+	artdaq::LogLinearHistogram a, b;
+	for (int ii = 1; ii <= 100; ++ii)
+	{
+		a.record(ii);
+		b.record(1000.0 * ii);
+	}
+	auto a_median = a.quantile(0.5);
+
+	a.merge(b);
+	BOOST_REQUIRE_EQUAL(a.totalCount(), 200);
+	BOOST_REQUIRE_GT(a.quantile(0.75), 1000.0);
+
+	for (auto const& bucket : b.nonEmptyBuckets())
+	{
+		a.subtract(bucket.first, bucket.second);
+	}
+	BOOST_REQUIRE_EQUAL(a.totalCount(), 100);
+	BOOST_REQUIRE_EQUAL(a.quantile(0.5), a_median);
+
+	a.clear();
+	BOOST_REQUIRE_EQUAL(a.totalCount(), 0);
+	BOOST_REQUIRE_EQUAL(a.quantile(0.5), 0.0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,248 @@
+#include "artdaq-core/Core/MonitoredQuantity.hh"
+
+#define BOOST_TEST_MODULE(MonitoredQuantity_t)
+#include "cetlib/quiet_unit_test.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(MonitoredQuantity_test)
+
+BOOST_AUTO_TEST_CASE(SerialStatistics)
+{
+	artdaq::MonitoredQuantity mq(1.0, 10.0);
+	for (int ii = 1; ii <= 10; ++ii)
+	{
+		mq.addSample(ii);
+	}
+	auto now = artdaq::MonitoredQuantity::getCurrentTime();
+	BOOST_REQUIRE(mq.calculateStatistics(now + 1.0));
+
+	artdaq::MonitoredQuantityStats stats;
+	mq.getStats(stats);
+	BOOST_REQUIRE_EQUAL(stats.getSampleCount(), 10);
+	BOOST_REQUIRE_EQUAL(stats.getValueSum(), 55.0);
+	BOOST_REQUIRE_EQUAL(stats.getValueMin(), 1.0);
+	BOOST_REQUIRE_EQUAL(stats.getValueMax(), 10.0);
+	BOOST_REQUIRE_EQUAL(stats.getValueAverage(), 5.5);
+	BOOST_REQUIRE_EQUAL(stats.getLastSampleValue(), 10.0);
+
+	// Too soon for another calculation
+	BOOST_REQUIRE(!mq.calculateStatistics(now + 1.5));
+}
+
+BOOST_AUTO_TEST_CASE(MultiThreaded)
+{
+	const int threads = 8;
+	const int samples_per_thread = 200000;
+	artdaq::MonitoredQuantity mq(0.001, 1.0);
+
+	// Serial reference. Integer-valued samples keep the floating-point sums exact in any order.
+	size_t expected_count = 0;
+	double expected_sum = 0.0;
+	double expected_min = INFINITY;
+	double expected_max = -INFINITY;
+	auto sample = [](int64_t thread, int64_t ii) { return static_cast<double>((thread * 7919 + ii * 104729) % 100003) - 50000.0; };
+	for (int tt = 0; tt < threads; ++tt)
+	{
+		for (int ii = 0; ii < samples_per_thread; ++ii)
+		{
+			auto value = sample(tt, ii);
+			++expected_count;
+			expected_sum += value;
+			expected_min = std::min(expected_min, value);
+			expected_max = std::max(expected_max, value);
+		}
+	}
+
+	// Calculate statistics while the samples are being added, so that accumulator slots are flushed mid-stream
+	std::atomic<bool> adding(true);
+	std::atomic<int> calculations(0);
+	auto time = artdaq::MonitoredQuantity::getCurrentTime();
+	mq.addSample(0);  // Starts the first calculation interval
+	std::thread calculator([&]() {
+		auto t = time;
+		while (adding)
+		{
+			t += 0.001;
+			if (mq.calculateStatistics(t)) ++calculations;
+			std::this_thread::yield();
+		}
+		mq.calculateStatistics(t + 1.0);
+	});
+
+	std::vector<std::thread> adders;
+	for (int tt = 0; tt < threads; ++tt)
+	{
+		adders.emplace_back([&, tt]() {
+			for (int ii = 0; ii < samples_per_thread; ++ii)
+			{
+				mq.addSample(sample(tt, ii));
+			}
+		});
+	}
+	for (auto& adder : adders)
+	{
+		adder.join();
+	}
+	adding = false;
+	calculator.join();
+	BOOST_REQUIRE_GT(calculations.load(), 1);
+	BOOST_REQUIRE(mq.waitUntilAccumulatorsHaveBeenFlushed(0.01));
+
+	artdaq::MonitoredQuantityStats stats;
+	mq.getStats(stats);
+	BOOST_REQUIRE_EQUAL(stats.getSampleCount(), expected_count + 1);
+	BOOST_REQUIRE_EQUAL(stats.getValueSum(), expected_sum);
+	BOOST_REQUIRE_EQUAL(stats.getValueMin(), std::min(expected_min, 0.0));
+	BOOST_REQUIRE_EQUAL(stats.getValueMax(), std::max(expected_max, 0.0));
+	BOOST_REQUIRE_EQUAL(mq.getFullSampleCount(), expected_count + 1);
+}
+
+BOOST_AUTO_TEST_CASE(WaitUntilFlushed)
+{
+	artdaq::MonitoredQuantity mq(0.001, 1.0);
+	BOOST_REQUIRE(mq.waitUntilAccumulatorsHaveBeenFlushed(0.01));
+
+	mq.addSample(1.0);
+	BOOST_REQUIRE(!mq.waitUntilAccumulatorsHaveBeenFlushed(0.01));
+
+	std::thread flusher([&]() {
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		mq.calculateStatistics(artdaq::MonitoredQuantity::getCurrentTime() + 1.0);
+	});
+	BOOST_REQUIRE(mq.waitUntilAccumulatorsHaveBeenFlushed(1.0));
+	flusher.join();
+	BOOST_REQUIRE_EQUAL(mq.getFullSampleCount(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(Quantiles)
+{
+	artdaq::MonitoredQuantity mq(1.0, 3.0, true);
+	BOOST_REQUIRE(mq.tracksQuantiles());
+	for (int ii = 1; ii <= 1000; ++ii)
+	{
+		mq.addSample(ii);
+	}
+	auto time = artdaq::MonitoredQuantity::getCurrentTime() + 1.0;
+	BOOST_REQUIRE(mq.calculateStatistics(time));
+
+	artdaq::MonitoredQuantityStats stats;
+	mq.getStats(stats);
+	for (auto q : {0.01, 0.5, 0.9, 0.99})
+	{
+		auto exact = std::ceil(q * 1000);
+		BOOST_REQUIRE_LE(std::fabs(stats.getValueQuantile(q) - exact), exact / artdaq::LogLinearHistogram::SUB_BUCKETS);
+		BOOST_REQUIRE_EQUAL(stats.getValueQuantile(q, artdaq::MonitoredQuantityStats::DataSetType::RECENT), stats.getValueQuantile(q));
+	}
+	BOOST_REQUIRE_EQUAL(stats.getValueQuantile(1.0), 1000.0);  // Clamped to the largest sample
+
+	// Without quantile tracking, quantiles are reported as zero
+	artdaq::MonitoredQuantity untracked(1.0, 3.0);
+	untracked.addSample(5.0);
+	untracked.calculateStatistics(time + 1.0);
+	untracked.getStats(stats);
+	BOOST_REQUIRE_EQUAL(stats.getValueQuantile(0.5), 0.0);
+}
+
+BOOST_AUTO_TEST_CASE(RecentQuantilesForgetOldBins)
+{
+	// Three calculation intervals make up the recent window
+	artdaq::MonitoredQuantity mq(1.0, 3.0, true);
+	for (int ii = 0; ii < 100; ++ii)
+	{
+		mq.addSample(1000.0);
+	}
+	auto time = artdaq::MonitoredQuantity::getCurrentTime() + 1.0;
+	BOOST_REQUIRE(mq.calculateStatistics(time));
+
+	artdaq::MonitoredQuantityStats stats;
+	for (int interval = 1; interval <= 3; ++interval)
+	{
+		for (int ii = 0; ii < 10; ++ii)
+		{
+			mq.addSample(10.0);
+		}
+		time += 1.0;
+		BOOST_REQUIRE(mq.calculateStatistics(time));
+		mq.getStats(stats);
+		if (interval < 3)
+		{
+			// The large samples are still in the recent window
+			BOOST_REQUIRE_EQUAL(stats.getValueQuantile(1.0, artdaq::MonitoredQuantityStats::DataSetType::RECENT), 1000.0);
+		}
+	}
+
+	// The first bin has been reused, so only the small samples remain recent
+	BOOST_REQUIRE_EQUAL(stats.getSampleCount(artdaq::MonitoredQuantityStats::DataSetType::RECENT), 30);
+	BOOST_REQUIRE_LE(std::fabs(stats.getValueQuantile(1.0, artdaq::MonitoredQuantityStats::DataSetType::RECENT) - 10.0), 10.0 / artdaq::LogLinearHistogram::SUB_BUCKETS);
+	BOOST_REQUIRE_LE(std::fabs(stats.getValueQuantile(0.5, artdaq::MonitoredQuantityStats::DataSetType::RECENT) - 10.0), 10.0 / artdaq::LogLinearHistogram::SUB_BUCKETS);
+	BOOST_REQUIRE_EQUAL(stats.getValueQuantile(1.0), 1000.0);
+	BOOST_REQUIRE_LE(std::fabs(stats.getValueQuantile(0.5) - 1000.0), 1000.0 / artdaq::LogLinearHistogram::SUB_BUCKETS);
+}
+
+BOOST_AUTO_TEST_CASE(ConcurrentReaders)
+{
+	// Readers see whole results from some calculation while new ones are being published
+	artdaq::MonitoredQuantity mq(0.001, 1.0);
+	std::atomic<bool> running(true);
+	auto time = artdaq::MonitoredQuantity::getCurrentTime();
+	mq.addSample(2.0);
+	std::thread writer([&]() {
+		auto t = time;
+		while (running)
+		{
+			for (int ii = 0; ii < 100; ++ii)
+			{
+				mq.addSample(2.0);
+			}
+			t += 0.001;
+			mq.calculateStatistics(t);
+		}
+	});
+
+	std::atomic<size_t> inconsistent(0);
+	std::vector<std::thread> readers;
+	for (int tt = 0; tt < 4; ++tt)
+	{
+		readers.emplace_back([&]() {
+			size_t last_count = 0;
+			double last_time = 0.0;
+			for (int ii = 0; ii < 20000; ++ii)
+			{
+				auto count = mq.getFullSampleCount();
+				auto calculation_time = mq.getLastCalculationTime();
+				if (count < last_count || calculation_time < last_time) ++inconsistent;
+				last_count = count;
+				last_time = calculation_time;
+
+				auto snapshot = mq.getSnapshot();
+				if (snapshot->fullValueSum != 2.0 * static_cast<double>(snapshot->fullSampleCount)) ++inconsistent;
+			}
+		});
+	}
+	for (auto& reader : readers)
+	{
+		reader.join();
+	}
+	running = false;
+	writer.join();
+	BOOST_REQUIRE_EQUAL(inconsistent.load(), 0);
+
+	// A snapshot is immutable; later calculations publish a new one
+	auto snapshot = mq.getSnapshot();
+	auto count = snapshot->fullSampleCount;
+	mq.addSample(2.0);
+	BOOST_REQUIRE(mq.calculateStatistics(time + 1000.0));
+	BOOST_REQUIRE_EQUAL(snapshot->fullSampleCount, count);
+	BOOST_REQUIRE_EQUAL(mq.getSnapshot()->fullSampleCount, count + 1);
+	BOOST_REQUIRE_EQUAL(mq.getFullSampleCount(), count + 1);
+	BOOST_REQUIRE_EQUAL(mq.getLastCalculationTime(), time + 1000.0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -113,6 +113,58 @@ BOOST_AUTO_TEST_CASE(DataFlow)
 	TLOG(TLVL_DEBUG) << "END TEST DataFlow";
 }
 
+BOOST_AUTO_TEST_CASE(WriteScatter)
+{
+	TLOG(TLVL_DEBUG) << "BEGIN TEST WriteScatter";
+	uint32_t key = GetRandomKey(0x7357);
+	artdaq::SharedMemoryManager man(key, 10, 0x1000);
+	artdaq::SharedMemoryManager man2(key);
+
+	int buf = man.GetBufferForWriting(false);
+	uint8_t n = 0;
+	uint8_t data[0x1000];
+	std::generate_n(data, 0x1000, [&]() { return ++n; });
+	std::vector<struct iovec> pieces{{data, 0x10}, {data + 0x10, 0}, {data + 0x10, 0x7F0}, {data + 0x800, 0x400}};
+	BOOST_REQUIRE_EQUAL(man.WriteScatter(buf, pieces), 0xC00);
+	BOOST_REQUIRE_EQUAL(man.BufferDataSize(buf), 0xC00);
+	BOOST_REQUIRE_EQUAL(memcmp(man.GetBufferStart(buf), data, 0xC00), 0);
+
+	// The total size of the pieces is checked before anything is copied
+	pieces = {{data, 0x200}, {data, 0x300}};
+	BOOST_REQUIRE_EXCEPTION(man.WriteScatter(buf, pieces), cet::exception, [&](cet::exception e) { return e.category() == "SharedMemoryWrite"; });
+	TLOG(TLVL_DEBUG) << "END TEST WriteScatter";
+}
+
+BOOST_AUTO_TEST_CASE(Vectored)
+{
+	TLOG(TLVL_DEBUG) << "BEGIN TEST Vectored";
+	uint32_t key = GetRandomKey(0x7357);
+	const size_t large = artdaq::SharedMemoryManager::NON_TEMPORAL_COPY_THRESHOLD + 13;
+	artdaq::SharedMemoryManager man(key, 2, 2 * large);
+	artdaq::SharedMemoryManager man2(key);
+
+	std::vector<uint8_t> data(2 * large);
+	uint8_t n = 0;
+	std::generate(data.begin(), data.end(), [&]() { return ++n * 7; });
+
+	// A small unaligned piece, then one large enough to be streamed
+	int buf = man.GetBufferForWriting(false);
+	std::vector<struct iovec> pieces{{data.data(), 3}, {data.data() + 3, large}, {data.data() + 3 + large, 100}};
+	BOOST_REQUIRE_EQUAL(man.Writev(buf, pieces.data(), pieces.size()), large + 103);
+	BOOST_REQUIRE_EQUAL(man.BufferDataSize(buf), large + 103);
+	man.MarkBufferFull(buf, 1);
+
+	auto readbuf = man2.GetBufferForReading();
+	std::vector<uint8_t> head(50), rest(large + 53);
+	std::vector<struct iovec> out{{head.data(), head.size()}, {rest.data(), rest.size()}};
+	BOOST_REQUIRE_EQUAL(man2.Readv(readbuf, out.data(), out.size()), true);
+	BOOST_REQUIRE(std::equal(head.begin(), head.end(), data.begin()));
+	BOOST_REQUIRE(std::equal(rest.begin(), rest.end(), data.begin() + head.size()));
+	BOOST_REQUIRE_EQUAL(man2.MoreDataInBuffer(readbuf), false);
+	man2.MarkBufferEmpty(readbuf);
+	TLOG(TLVL_DEBUG) << "END TEST Vectored";
+}
+
 BOOST_AUTO_TEST_CASE(Exceptions)
 {
 	artdaq::configureMessageFacility("SharedMemoryManager_t", true, true);
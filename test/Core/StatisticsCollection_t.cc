@@ -0,0 +1,167 @@
+#include "artdaq-core/Core/StatisticsCollection.hh"
+
+#define BOOST_TEST_MODULE(StatisticsCollection_t)
+#include "cetlib/quiet_unit_test.hpp"
+
+#include <sys/wait.h>
+#include <unistd.h>
+#include <chrono>
+#include <iostream>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace {
+// Count the calculations the StatisticsCollection thread makes for each quantity over the given time
+std::vector<size_t> CountCalculations(std::vector<artdaq::MonitoredQuantityPtr> const& quantities, std::chrono::milliseconds duration)
+{
+	std::vector<std::set<double>> calculation_times(quantities.size());
+	std::vector<double> initial_times;
+	for (auto const& quantity : quantities)
+	{
+		initial_times.push_back(quantity->getLastCalculationTime());
+	}
+	auto end = std::chrono::steady_clock::now() + duration;
+	while (std::chrono::steady_clock::now() < end)
+	{
+		for (size_t ii = 0; ii < quantities.size(); ++ii)
+		{
+			quantities[ii]->addSample(1.0);
+			auto time = quantities[ii]->getLastCalculationTime();
+			if (time != initial_times[ii]) calculation_times[ii].insert(time);
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	std::vector<size_t> counts;
+	for (auto const& times : calculation_times)
+	{
+		counts.push_back(times.size());
+	}
+	return counts;
+}
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(StatisticsCollection_test)
+
+BOOST_AUTO_TEST_CASE(PromptStop)
+{
+	// Must run before anything else uses the StatisticsCollection, so that the child process creates its own.
+	// A child process registers a quantity which is not due for a long time, then exits. The
+	// StatisticsCollection destructor stops and joins the calculation thread, which must not wait until it is due.
+	auto start = std::chrono::steady_clock::now();
+	std::cout.flush();
+	auto pid = fork();
+	BOOST_REQUIRE_GE(pid, 0);
+	if (pid == 0)
+	{
+		artdaq::StatisticsCollection::getInstance().addMonitoredQuantity("PromptStop", std::make_shared<artdaq::MonitoredQuantity>(100.0, 100.0));
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		exit(0);
+	}
+	int status = 0;
+	BOOST_REQUIRE_EQUAL(waitpid(pid, &status, 0), pid);
+	BOOST_REQUIRE(WIFEXITED(status));
+	BOOST_REQUIRE_EQUAL(WEXITSTATUS(status), 0);
+	BOOST_REQUIRE_LT(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(), 1.0);
+}
+
+BOOST_AUTO_TEST_CASE(Registration)
+{
+	auto& stats = artdaq::StatisticsCollection::getInstance();
+	auto mq = std::make_shared<artdaq::MonitoredQuantity>(0.02, 1.0);
+	stats.addMonitoredQuantity("Registration", mq);
+	stats.addMonitoredQuantity("Registration", mq);  // No effect
+	stats.addMonitoredQuantity("Null", nullptr);
+	BOOST_REQUIRE_EQUAL(stats.getMonitoredQuantity("Registration"), mq);
+	BOOST_REQUIRE(stats.getMonitoredQuantity("Null") == nullptr);
+	BOOST_REQUIRE(stats.getMonitoredQuantity("Unknown") == nullptr);
+
+	// The calculation thread picks up the new quantity and calculates its statistics
+	mq->addSample(5.0);
+	auto end = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+	while (mq->getFullSampleCount() == 0 && std::chrono::steady_clock::now() < end)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	BOOST_REQUIRE_EQUAL(mq->getFullSampleCount(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(CalculationIntervals)
+{
+	// Each quantity is calculated at its own interval, and registering one with a short interval
+	// wakes the calculation thread even while it is waiting for a quantity with a long interval
+	auto& stats = artdaq::StatisticsCollection::getInstance();
+	auto slow = std::make_shared<artdaq::MonitoredQuantity>(0.25, 1.0);
+	slow->addSample(1.0);  // Starts the first calculation interval
+	stats.addMonitoredQuantity("Slow", slow);
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	auto fast = std::make_shared<artdaq::MonitoredQuantity>(0.02, 1.0);
+	fast->addSample(1.0);
+	stats.addMonitoredQuantity("Fast", fast);
+
+	auto counts = CountCalculations({fast, slow}, std::chrono::milliseconds(1000));
+	BOOST_TEST_MESSAGE("Fast quantity calculated " << counts[0] << " times, slow quantity " << counts[1] << " times in 1 s");
+	BOOST_REQUIRE_GE(counts[0], 25);
+	BOOST_REQUIRE_LE(counts[0], 51);
+	BOOST_REQUIRE_GE(counts[1], 3);
+	BOOST_REQUIRE_LE(counts[1], 5);
+}
+
+BOOST_AUTO_TEST_CASE(Replacement)
+{
+	// Replacing a quantity unschedules it, also if it is then registered again (A, B, A)
+	auto& stats = artdaq::StatisticsCollection::getInstance();
+	auto a = std::make_shared<artdaq::MonitoredQuantity>(0.1, 1.0);
+	auto b = std::make_shared<artdaq::MonitoredQuantity>(0.1, 1.0);
+	stats.addMonitoredQuantity("Replacement", a);
+	stats.addMonitoredQuantity("Replacement", b);
+	auto counts = CountCalculations({a, b}, std::chrono::milliseconds(300));
+	BOOST_REQUIRE_EQUAL(counts[0], 0);
+	BOOST_REQUIRE_GE(counts[1], 1);
+
+	stats.addMonitoredQuantity("Replacement", a);
+	BOOST_REQUIRE_EQUAL(stats.getMonitoredQuantity("Replacement"), a);
+	auto b_time = b->getLastCalculationTime();
+	counts = CountCalculations({a, b}, std::chrono::milliseconds(1000));
+	BOOST_REQUIRE_GE(counts[0], 5);
+	BOOST_REQUIRE_LE(counts[0], 11);
+	BOOST_REQUIRE_EQUAL(b->getLastCalculationTime(), b_time);
+}
+
+BOOST_AUTO_TEST_CASE(SnapshotAll)
+{
+	auto& stats = artdaq::StatisticsCollection::getInstance();
+	auto mq = std::make_shared<artdaq::MonitoredQuantity>(1000.0, 1000.0);
+	stats.addMonitoredQuantity("SnapshotAll", mq);
+	mq->addSample(2.0);
+	mq->addSample(4.0);
+	BOOST_REQUIRE(mq->calculateStatistics(artdaq::MonitoredQuantity::getCurrentTime() + 1000.0));
+
+	auto snapshots = stats.snapshotAll();
+	BOOST_REQUIRE_EQUAL(snapshots.count("SnapshotAll"), 1);
+	BOOST_REQUIRE_EQUAL(snapshots.count("Registration"), 1);
+	auto snapshot = snapshots["SnapshotAll"];
+	BOOST_REQUIRE_EQUAL(snapshot->getSampleCount(), 2);
+	BOOST_REQUIRE_EQUAL(snapshot->getValueAverage(), 3.0);
+
+	// Snapshots are not changed by later calculations or resets
+	mq->addSample(6.0);
+	BOOST_REQUIRE(mq->calculateStatistics(artdaq::MonitoredQuantity::getCurrentTime() + 3000.0));
+	BOOST_REQUIRE_EQUAL(stats.snapshotAll()["SnapshotAll"]->getSampleCount(), 3);
+	stats.reset();
+	BOOST_REQUIRE_EQUAL(snapshot->getSampleCount(), 2);
+	BOOST_REQUIRE_EQUAL(stats.snapshotAll()["SnapshotAll"]->getSampleCount(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(RequestStop)
+{
+	// Stops the calculation thread of this process, so must run last
+	auto& stats = artdaq::StatisticsCollection::getInstance();
+	stats.requestStop();
+	auto mq = std::make_shared<artdaq::MonitoredQuantity>(0.01, 1.0);
+	stats.addMonitoredQuantity("AfterStop", mq);
+	auto counts = CountCalculations({mq}, std::chrono::milliseconds(100));
+	BOOST_REQUIRE_EQUAL(counts[0], 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,277 @@
+#include "artdaq-core/Core/StatisticsExporter.hh"
+
+#define BOOST_TEST_MODULE(StatisticsExporter_t)
+#include "cetlib/quiet_unit_test.hpp"
+#include "cetlib_except/exception.h"
+
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+// One sample line of Prometheus text, with the label values unescaped
+struct Sample
+{
+	std::string metric;
+	std::map<std::string, std::string> labels;
+	double value;
+};
+
+std::vector<Sample> ParsePrometheus(std::string const& text)
+{
+	std::vector<Sample> samples;
+	std::istringstream is(text);
+	std::string line;
+	while (std::getline(is, line))
+	{
+		if (line.empty() || line[0] == '#') continue;
+		Sample sample;
+		auto pos = line.find('{');
+		BOOST_REQUIRE(pos != std::string::npos);
+		sample.metric = line.substr(0, pos++);
+		while (line[pos] != '}')
+		{
+			auto eq = line.find("=\"", pos);
+			BOOST_REQUIRE(eq != std::string::npos);
+			auto name = line.substr(pos, eq - pos);
+			std::string value;
+			for (pos = eq + 2; line[pos] != '"'; ++pos)
+			{
+				if (line[pos] == '\\')
+				{
+					++pos;
+					value += line[pos] == 'n' ? '\n' : line[pos];
+				}
+				else
+				{
+					value += line[pos];
+				}
+			}
+			sample.labels[name] = value;
+			++pos;
+			if (line[pos] == ',') ++pos;
+		}
+		sample.value = std::stod(line.substr(pos + 2));
+		samples.push_back(sample);
+	}
+	return samples;
+}
+
+artdaq::MonitoredQuantityStatsPtr MakeSnapshot(bool track_quantiles)
+{
+	artdaq::MonitoredQuantity mq(1.0, 10.0, track_quantiles);
+	for (int ii = 1; ii <= 100; ++ii)
+	{
+		mq.addSample(ii);
+	}
+	mq.calculateStatistics(artdaq::MonitoredQuantity::getCurrentTime() + 1.0);
+	return mq.getSnapshot();
+}
+
+// Read one entry of a StatisticsTable the way a reader in another process does
+bool ReadEntry(artdaq::StatisticsTable::Entry const& shared, artdaq::StatisticsTable::Entry& copy)
+{
+	for (int attempt = 0; attempt < 1000; ++attempt)
+	{
+		auto before = shared.sequence.load(std::memory_order_acquire);
+		if (before % 2 != 0) continue;
+		memcpy(&copy.name[0], &shared.name[0], sizeof(copy.name));
+		copy.type = shared.type;
+		copy.enabled = shared.enabled;
+		memcpy(&copy.values[0], &shared.values[0], sizeof(copy.values));
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (shared.sequence.load(std::memory_order_relaxed) == before) return true;
+	}
+	return false;
+}
+
+uint32_t TestKey(uint32_t offset) { return 0x53540000 + ((static_cast<uint32_t>(getpid()) & 0xFFF) << 4) + offset; }
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(StatisticsExporter_test)
+
+BOOST_AUTO_TEST_CASE(RenderPrometheus)
+{
+	std::string const awkward = "say \"hi\"\\now\nplease";
+	std::map<std::string, artdaq::MonitoredQuantityStatsPtr> snapshots;
+	snapshots[awkward] = MakeSnapshot(true);
+	snapshots["Plain"] = MakeSnapshot(false);
+
+	auto samples = ParsePrometheus(artdaq::StatisticsExporter::RenderPrometheus(snapshots));
+	std::map<std::string, std::map<std::string, double>> values;  // quantity, metric (with quantile) -> value
+	for (auto const& sample : samples)
+	{
+		BOOST_REQUIRE_EQUAL(sample.labels.count("quantity"), 1);
+		auto metric = sample.metric;
+		if (sample.labels.count("quantile") != 0) metric += "/" + sample.labels.at("quantile");
+		values[sample.labels.at("quantity")][metric] = sample.value;
+	}
+
+	// The label round-trips through escaping
+	BOOST_REQUIRE_EQUAL(values.size(), 2);
+	BOOST_REQUIRE_EQUAL(values.count(awkward), 1);
+	for (auto const& quantity : values)
+	{
+		BOOST_REQUIRE_EQUAL(quantity.second.at("artdaq_monitored_sample_count"), 100.0);
+		BOOST_REQUIRE_EQUAL(quantity.second.at("artdaq_monitored_value_sum"), 5050.0);
+		BOOST_REQUIRE_EQUAL(quantity.second.at("artdaq_monitored_value_max"), 100.0);
+		BOOST_REQUIRE_EQUAL(quantity.second.at("artdaq_monitored_last_value"), 100.0);
+	}
+
+	// Only the quantity which tracks quantiles has quantile lines
+	auto const& tracked = values[awkward];
+	BOOST_REQUIRE_EQUAL(tracked.size(), 12);
+	BOOST_REQUIRE_EQUAL(values["Plain"].size(), 9);
+	BOOST_REQUIRE_EQUAL(tracked.at("artdaq_monitored_value_quantile/0.5"), snapshots[awkward]->getValueQuantile(0.5, artdaq::MonitoredQuantityStats::DataSetType::RECENT));
+	BOOST_REQUIRE_EQUAL(tracked.at("artdaq_monitored_value_quantile/0.99"), snapshots[awkward]->getValueQuantile(0.99, artdaq::MonitoredQuantityStats::DataSetType::RECENT));
+	BOOST_REQUIRE_EQUAL(tracked.at("artdaq_monitored_value_quantile/0.999"), snapshots[awkward]->getValueQuantile(0.999, artdaq::MonitoredQuantityStats::DataSetType::RECENT));
+
+	snapshots.erase(awkward);
+	BOOST_REQUIRE(artdaq::StatisticsExporter::RenderPrometheus(snapshots).find("quantile") == std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(SharedMemoryTable)
+{
+	// Every sample is 2, so a consistent entry always has a sum of twice its count. The quantity is
+	// only calculated by the writer thread, so that no samples are in flight during a calculation.
+	auto mq = std::make_shared<artdaq::MonitoredQuantity>(1000.0, 1000.0);
+	artdaq::StatisticsCollection::getInstance().addMonitoredQuantity("Exported", mq);
+	artdaq::StatisticsExporter exporter(0.001, TestKey(0), 16);
+
+	auto table = static_cast<artdaq::StatisticsTable::Header const*>(shmat(exporter.GetShmSegmentId(), nullptr, SHM_RDONLY));
+	BOOST_REQUIRE(table != reinterpret_cast<void*>(-1));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast,performance-no-int-to-ptr)
+	BOOST_REQUIRE_EQUAL(table->magic.load(), artdaq::StatisticsTable::MAGIC);
+	BOOST_REQUIRE_EQUAL(table->version, artdaq::StatisticsTable::VERSION);
+	BOOST_REQUIRE_EQUAL(table->entry_capacity, 16);
+	auto entries = reinterpret_cast<artdaq::StatisticsTable::Entry const*>(table + 1);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+
+	// Exports from another thread are serialized with those of the export thread
+	std::atomic<bool> running(true);
+	std::thread writer([&]() {
+		auto time = artdaq::MonitoredQuantity::getCurrentTime();
+		while (running)
+		{
+			for (int ii = 0; ii < 100; ++ii)
+			{
+				mq->addSample(2.0);
+			}
+			time += 1000.0;
+			mq->calculateStatistics(time);
+			exporter.exportNow();
+		}
+	});
+
+	size_t reads = 0, inconsistent = 0;
+	double last_count = 0.0;
+	auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(500);
+	while (std::chrono::steady_clock::now() < end)
+	{
+		for (uint32_t ii = 0; ii < table->entry_count.load(); ++ii)
+		{
+			artdaq::StatisticsTable::Entry entry;
+			if (!ReadEntry(entries[ii], entry) || strcmp(&entry.name[0], "Exported") != 0) continue;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+			++reads;
+			auto count = entry.values[artdaq::StatisticsTable::FullSampleCount];
+			if (entry.values[artdaq::StatisticsTable::FullValueSum] != 2.0 * count || count < last_count) ++inconsistent;
+			last_count = count;
+		}
+	}
+	running = false;
+	writer.join();
+	shmdt(table);
+
+	BOOST_TEST_MESSAGE("Read " << reads << " entries, last sample count " << last_count);
+	BOOST_REQUIRE_GT(reads, 0);
+	BOOST_REQUIRE_GT(last_count, 0.0);
+	BOOST_REQUIRE_EQUAL(inconsistent, 0);
+}
+
+BOOST_AUTO_TEST_CASE(ExistingSegment)
+{
+	// A segment in use by another exporter is not taken over
+	{
+		artdaq::StatisticsExporter exporter(1.0, TestKey(1), 4);
+		BOOST_REQUIRE_THROW(artdaq::StatisticsExporter(1.0, TestKey(1), 4), cet::exception);
+	}
+
+	// Neither is a segment which is not a StatisticsTable
+	auto id = shmget(TestKey(2), 4096, IPC_CREAT | IPC_EXCL | 0666);
+	BOOST_REQUIRE_NE(id, -1);
+	auto ptr = static_cast<char*>(shmat(id, nullptr, 0));
+	memset(ptr, 0x5A, 4096);
+	shmdt(ptr);
+	BOOST_REQUIRE_THROW(artdaq::StatisticsExporter(1.0, TestKey(2), 4), cet::exception);
+	ptr = static_cast<char*>(shmat(id, nullptr, SHM_RDONLY));
+	BOOST_REQUIRE_EQUAL(ptr[0], 0x5A);
+	BOOST_REQUIRE_EQUAL(ptr[4095], 0x5A);
+	shmdt(ptr);
+	shmctl(id, IPC_RMID, nullptr);
+
+	// A StatisticsTable which nothing is attached to was left behind, and is replaced
+	id = shmget(TestKey(3), sizeof(artdaq::StatisticsTable::Header), IPC_CREAT | IPC_EXCL | 0666);
+	BOOST_REQUIRE_NE(id, -1);
+	auto stale = static_cast<artdaq::StatisticsTable::Header*>(shmat(id, nullptr, 0));
+	stale->magic = artdaq::StatisticsTable::MAGIC;
+	shmdt(stale);
+	artdaq::StatisticsExporter exporter(1.0, TestKey(3), 4);
+	BOOST_REQUIRE_NE(exporter.GetShmSegmentId(), id);
+	BOOST_REQUIRE_EQUAL(shmget(TestKey(3), 0, 0), exporter.GetShmSegmentId());
+}
+
+BOOST_AUTO_TEST_CASE(SlowSocketClient)
+{
+	// Enough quantities that the Prometheus text does not fit in the socket buffer
+	for (int ii = 0; ii < 2000; ++ii)
+	{
+		artdaq::StatisticsCollection::getInstance().addMonitoredQuantity("SlowSocketClient_" + std::to_string(ii), std::make_shared<artdaq::MonitoredQuantity>(1.0, 10.0));
+	}
+	auto path = "/tmp/StatisticsExporter_t_" + std::to_string(getpid()) + ".sock";
+	sockaddr_un addr{};
+	addr.sun_family = AF_UNIX;
+	strncpy(&addr.sun_path[0], path.c_str(), sizeof(addr.sun_path) - 1);
+	auto connect_client = [&]() {
+		auto fd = socket(AF_UNIX, SOCK_STREAM, 0);
+		BOOST_REQUIRE_NE(fd, -1);
+		BOOST_REQUIRE_EQUAL(connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+		return fd;
+	};
+
+	auto start = std::chrono::steady_clock::now();
+	{
+		artdaq::StatisticsExporter exporter(0.05, 0, 0, "", path);
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+		// A client which never reads does not stop others from being served
+		auto stuck = connect_client();
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		auto reader = connect_client();
+		timeval timeout{5, 0};
+		setsockopt(reader, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+		std::string text;
+		char buffer[65536];
+		ssize_t sts;
+		while ((sts = recv(reader, &buffer[0], sizeof(buffer), 0)) > 0)
+		{
+			text.append(&buffer[0], sts);
+		}
+		BOOST_REQUIRE_EQUAL(sts, 0);
+		BOOST_REQUIRE_GT(text.size(), 1000000);
+		BOOST_REQUIRE_EQUAL(text.back(), '\n');
+		BOOST_REQUIRE(text.find("quantity=\"SlowSocketClient_1999\"") != std::string::npos);
+		close(reader);
+		close(stuck);
+	}
+	BOOST_REQUIRE_LT(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(), 2.0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,30 @@
+#define ARTDAQ_DISABLE_TIMING_PROBES
+#include "artdaq-core/Core/TimingProbe.hh"
+
+#define BOOST_TEST_MODULE(TimingProbeDisabled_t)
+#include "cetlib/quiet_unit_test.hpp"
+
+namespace {
+int Probed(int value)
+{
+	ARTDAQ_TIMING_PROBE("TimingProbeDisabled_t.Probed");
+	return value + 1;
+}
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(TimingProbeDisabled_test)
+
+BOOST_AUTO_TEST_CASE(CompiledOut)
+{
+	// With ARTDAQ_DISABLE_TIMING_PROBES, probes are statements with no effect, even when sampling every pass
+	artdaq::TimingProbe::SetSampleInterval(1);
+	if (true) ARTDAQ_TIMING_PROBE("TimingProbeDisabled_t.Branch");
+	for (int ii = 0; ii < 100; ++ii)
+	{
+		BOOST_REQUIRE_EQUAL(Probed(ii), ii + 1);
+	}
+	BOOST_REQUIRE(artdaq::StatisticsCollection::getInstance().getMonitoredQuantity("TimingProbeDisabled_t.Probed") == nullptr);
+	BOOST_REQUIRE(artdaq::StatisticsCollection::getInstance().getMonitoredQuantity("TimingProbeDisabled_t.Branch") == nullptr);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,106 @@
+#include "artdaq-core/Core/TimingProbe.hh"
+
+#define BOOST_TEST_MODULE(TimingProbe_t)
+#include "cetlib/quiet_unit_test.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+namespace {
+void Sampled() { ARTDAQ_TIMING_PROBE("TimingProbe_t.Sampled"); }
+
+void Lazy() { ARTDAQ_TIMING_PROBE("TimingProbe_t.Lazy"); }
+
+void Existing() { ARTDAQ_TIMING_PROBE("TimingProbe_t.Existing"); }
+
+void Sleeping()
+{
+	ARTDAQ_TIMING_PROBE("TimingProbe_t.Sleeping");
+	std::this_thread::sleep_for(std::chrono::milliseconds(5));
+}
+
+// Call a function on a new thread, whose sampling countdown starts from the beginning
+void CallOnNewThread(void (*function)(), int passes)
+{
+	std::thread thread([&]() {
+		for (int ii = 0; ii < passes; ++ii)
+		{
+			function();
+		}
+	});
+	thread.join();
+}
+
+// Calculate the statistics of the probe's MonitoredQuantity, and get its sample count
+size_t SampleCount(std::string const& name)
+{
+	static double offset = 0.0;  // Each calculation must be later than the last
+	offset += 1000.0;
+	auto quantity = artdaq::StatisticsCollection::getInstance().getMonitoredQuantity(name);
+	BOOST_REQUIRE(quantity != nullptr);
+	quantity->calculateStatistics(artdaq::MonitoredQuantity::getCurrentTime() + offset);
+	return quantity->getFullSampleCount();
+}
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(TimingProbe_test)
+
+BOOST_AUTO_TEST_CASE(LazyRegistration)
+{
+	// Nothing is registered until a pass through the probe is timed
+	auto& collection = artdaq::StatisticsCollection::getInstance();
+	artdaq::TimingProbe::SetSampleInterval(0);
+	CallOnNewThread(Lazy, 100);
+	BOOST_REQUIRE(collection.getMonitoredQuantity("TimingProbe_t.Lazy") == nullptr);
+
+	artdaq::TimingProbe::SetSampleInterval(1);
+	CallOnNewThread(Lazy, 10);
+	BOOST_REQUIRE(collection.getMonitoredQuantity("TimingProbe_t.Lazy") != nullptr);
+	BOOST_REQUIRE(collection.getMonitoredQuantity("TimingProbe_t.Lazy")->tracksQuantiles());
+	BOOST_REQUIRE_EQUAL(SampleCount("TimingProbe_t.Lazy"), 10);
+
+	// A quantity which is already registered under the probe's name is reported to
+	auto existing = std::make_shared<artdaq::MonitoredQuantity>(1000.0, 1000.0);
+	collection.addMonitoredQuantity("TimingProbe_t.Existing", existing);
+	CallOnNewThread(Existing, 10);
+	BOOST_REQUIRE_EQUAL(collection.getMonitoredQuantity("TimingProbe_t.Existing"), existing);
+	BOOST_REQUIRE_EQUAL(SampleCount("TimingProbe_t.Existing"), 10);
+}
+
+BOOST_AUTO_TEST_CASE(Sampling)
+{
+	// One in every interval passes is timed, per thread
+	artdaq::TimingProbe::SetSampleInterval(4);
+	BOOST_REQUIRE_EQUAL(artdaq::TimingProbe::SampleInterval(), 4);
+	CallOnNewThread(Sampled, 100);
+	BOOST_REQUIRE_EQUAL(SampleCount("TimingProbe_t.Sampled"), 25);
+	CallOnNewThread(Sampled, 101);
+	BOOST_REQUIRE_EQUAL(SampleCount("TimingProbe_t.Sampled"), 51);
+
+	// Disabling sampling stops timing immediately
+	artdaq::TimingProbe::SetSampleInterval(0);
+	CallOnNewThread(Sampled, 100);
+	BOOST_REQUIRE_EQUAL(SampleCount("TimingProbe_t.Sampled"), 51);
+}
+
+BOOST_AUTO_TEST_CASE(Durations)
+{
+	// Enabling sampling selected the clock, so timed passes are converted to seconds without calibrating
+	artdaq::TimingProbe::SetSampleInterval(1);
+	BOOST_REQUIRE_GT(artdaq::TimingProbe::SecondsPerTick(), 0.0);
+	auto start = artdaq::TimingProbe::Now();
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	auto seconds = static_cast<double>(artdaq::TimingProbe::Now() - start) * artdaq::TimingProbe::SecondsPerTick();
+	BOOST_REQUIRE_GE(seconds, 0.019);
+	BOOST_REQUIRE_LT(seconds, 0.5);
+
+	CallOnNewThread(Sleeping, 10);
+	BOOST_REQUIRE_EQUAL(SampleCount("TimingProbe_t.Sleeping"), 10);
+	artdaq::MonitoredQuantityStats stats;
+	artdaq::StatisticsCollection::getInstance().getMonitoredQuantity("TimingProbe_t.Sleeping")->getStats(stats);
+	BOOST_REQUIRE_GE(stats.getValueMin(), 0.0049);
+	BOOST_REQUIRE_LT(stats.getValueAverage(), 0.5);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
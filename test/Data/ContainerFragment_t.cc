@@ -195,6 +195,640 @@ BOOST_AUTO_TEST_CASE(Performance)
 	TLOG(TLVL_INFO, "ContainerFragment_t") << "Adding " << PERF_TEST_FRAGMENT_COUNT << " Fragments in a group took " << artdaq::TimeUtils::GetElapsedTimeMicroseconds(start_time, end_time) << " us";
 }
 
+#define LARGE_CONTAINER_BLOCK_COUNT 10000
+BOOST_AUTO_TEST_CASE(LargeContainer)
+{
+	std::vector<artdaq::Fragment::value_type> fakeData{1, 2, 3, 4};
+	artdaq::Fragment frag(1, 0, artdaq::Fragment::FirstUserFragmentType);
+	frag.resize(fakeData.size());
+
+	// Individual adds
+	artdaq::Fragment f(0);
+	f.setSequenceID(1);
+	artdaq::ContainerFragmentLoader cfl(f);
+	const int chunk = LARGE_CONTAINER_BLOCK_COUNT / 10;
+	std::vector<size_t> chunk_times;
+	size_t index_moves = 0;
+	size_t index_bytes_moved = 0;
+	auto start_time = std::chrono::steady_clock::now();
+	auto chunk_start = start_time;
+	for (int ii = 0; ii < LARGE_CONTAINER_BLOCK_COUNT; ++ii)
+	{
+		frag.setFragmentID(ii);
+		*frag.dataBegin() = ii;
+		auto index_offset = cfl.metadata()->index_offset;
+		cfl.addFragment(frag);
+		if (cfl.metadata()->index_offset != index_offset)
+		{
+			++index_moves;
+			index_bytes_moved += sizeof(size_t) * (ii + 1);
+		}
+		if ((ii + 1) % chunk == 0)
+		{
+			chunk_times.push_back(artdaq::TimeUtils::GetElapsedTimeMicroseconds(chunk_start));
+			chunk_start = std::chrono::steady_clock::now();
+		}
+	}
+	auto add_time = artdaq::TimeUtils::GetElapsedTimeMicroseconds(start_time);
+
+	// The index is moved geometrically rarely, so the bytes moved stay proportional to the data added and the cost
+	// of an add does not grow with the number of blocks already in the container
+	TLOG(TLVL_INFO, "ContainerFragment_t") << "addFragment: first " << chunk << " adds took " << chunk_times.front() << " us, last " << chunk << " took " << chunk_times.back()
+	                                       << " us; index moved " << index_moves << " times (" << index_bytes_moved << " bytes)";
+	BOOST_REQUIRE_LT(index_bytes_moved, 2 * LARGE_CONTAINER_BLOCK_COUNT * frag.sizeBytes());
+	BOOST_REQUIRE_LT(index_moves, 200u);
+
+	// In-place appends
+	artdaq::Fragment f2(0);
+	f2.setSequenceID(1);
+	artdaq::ContainerFragmentLoader cfl2(f2, artdaq::Fragment::FirstUserFragmentType);
+	start_time = std::chrono::steady_clock::now();
+	for (int ii = 0; ii < LARGE_CONTAINER_BLOCK_COUNT; ++ii)
+	{
+		auto hdr = cfl2.appendFragment(fakeData.size());
+		hdr->fragment_id = ii;
+		*reinterpret_cast<artdaq::RawDataType*>(hdr + 1) = ii;  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+	}
+	auto append_time = artdaq::TimeUtils::GetElapsedTimeMicroseconds(start_time);
+
+	TLOG(TLVL_INFO, "ContainerFragment_t") << "Building a " << LARGE_CONTAINER_BLOCK_COUNT << "-block container took " << add_time << " us with addFragment, " << append_time << " us with appendFragment";
+
+	for (auto cf : {static_cast<artdaq::ContainerFragment*>(&cfl), static_cast<artdaq::ContainerFragment*>(&cfl2)})
+	{
+		BOOST_REQUIRE_EQUAL(cf->block_count(), LARGE_CONTAINER_BLOCK_COUNT);
+		BOOST_REQUIRE_EQUAL(cf->lastFragmentIndex(), LARGE_CONTAINER_BLOCK_COUNT * frag.sizeBytes());
+		for (int ii = 0; ii < LARGE_CONTAINER_BLOCK_COUNT; ii += 997)
+		{
+			auto outfrag = cf->at(ii);
+			BOOST_REQUIRE_EQUAL(outfrag->fragmentID(), ii);
+			BOOST_REQUIRE_EQUAL(*outfrag->dataBegin(), ii);
+		}
+	}
+
+	// A fresh reader over the same Fragment finds the index written by the loader
+	artdaq::ContainerFragment reader(f);
+	BOOST_REQUIRE(reader.validateIndex());
+	BOOST_REQUIRE_EQUAL(reader.block_count(), LARGE_CONTAINER_BLOCK_COUNT);
+	BOOST_REQUIRE_EQUAL(reader.fragSize(LARGE_CONTAINER_BLOCK_COUNT - 1), frag.sizeBytes());
+	BOOST_REQUIRE_EQUAL(reader.at(LARGE_CONTAINER_BLOCK_COUNT - 1)->fragmentID(), LARGE_CONTAINER_BLOCK_COUNT - 1);
+}
+
+BOOST_AUTO_TEST_CASE(IndexSlackIsZeroed)
+{
+	// Once the index is large enough to be moved with slack, the gap between the contained Fragments and the index is zeroed
+	artdaq::Fragment frag(1, 0, artdaq::Fragment::FirstUserFragmentType);
+	frag.resize(4, 0xFFFFFFFFFFFFFFFF);
+
+	artdaq::Fragment f(0);
+	f.setSequenceID(1);
+	artdaq::ContainerFragmentLoader cfl(f);
+	auto gap_is_zero = [&]() {
+		auto begin = reinterpret_cast<uint8_t const*>(cfl.dataBegin());  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+		return std::all_of(begin + cfl.lastFragmentIndex(), begin + cfl.metadata()->index_offset, [](uint8_t b) { return b == 0; });
+	};
+
+	bool had_gap = false;
+	for (int ii = 0; ii < 200; ++ii)
+	{
+		frag.setFragmentID(ii);
+		cfl.addFragment(frag);
+		had_gap = had_gap || cfl.metadata()->index_offset > cfl.lastFragmentIndex();
+		BOOST_REQUIRE(gap_is_zero());
+	}
+	BOOST_REQUIRE(had_gap);
+	BOOST_REQUIRE_GT(cfl.block_count(), 64);
+
+	// Shrinking the last Fragment leaves a large index in place, and clears what the Fragment no longer covers
+	auto index_offset = cfl.metadata()->index_offset;
+	cfl.resizeLastFragment(1);
+	BOOST_REQUIRE_EQUAL(cfl.metadata()->index_offset, index_offset);
+	BOOST_REQUIRE(gap_is_zero());
+	BOOST_REQUIRE_EQUAL(cfl.at(199)->dataSize(), 1);
+
+	artdaq::ContainerFragment reader(f);
+	BOOST_REQUIRE(reader.validateIndex());
+	BOOST_REQUIRE_EQUAL(reader.at(198)->fragmentID(), 198);
+}
+
+#define VALIDATION_BLOCK_COUNT 40000
+BOOST_AUTO_TEST_CASE(IndexValidation)
+{
+	artdaq::Fragment f(0);
+	f.setSequenceID(2);
+	{
+		artdaq::ContainerFragmentLoader cfl(f, artdaq::Fragment::FirstUserFragmentType);
+		for (int ii = 0; ii < VALIDATION_BLOCK_COUNT; ++ii)
+		{
+			auto hdr = cfl.appendFragment(ii % 3);
+			hdr->fragment_id = ii;
+		}
+	}
+
+	// Overlays only check for the index terminator; full validation (in parallel for this many blocks) is on request
+	auto start_time = std::chrono::steady_clock::now();
+	for (int ii = 0; ii < 100; ++ii)
+	{
+		artdaq::ContainerFragment cf(f);
+		BOOST_REQUIRE_EQUAL(cf.fragSize(VALIDATION_BLOCK_COUNT - 1), ((VALIDATION_BLOCK_COUNT - 1) % 3 + artdaq::detail::RawFragmentHeader::num_words()) * sizeof(artdaq::RawDataType));
+	}
+	auto overlay_time = artdaq::TimeUtils::GetElapsedTimeMicroseconds(start_time);
+	start_time = std::chrono::steady_clock::now();
+	{
+		artdaq::ContainerFragment cf(f);
+		BOOST_REQUIRE(cf.verifyIndex());
+		BOOST_REQUIRE_EQUAL(cf.at(VALIDATION_BLOCK_COUNT - 1)->fragmentID(), VALIDATION_BLOCK_COUNT - 1);
+	}
+	auto verify_time = artdaq::TimeUtils::GetElapsedTimeMicroseconds(start_time);
+	TLOG(TLVL_INFO, "ContainerFragment_t") << "100 overlays of a " << VALIDATION_BLOCK_COUNT << "-block container took " << overlay_time << " us, verifying its index took " << verify_time << " us";
+
+	// Corrupt one entry of the stored index; verifyIndex detects it and that overlay rebuilds the index from the headers.
+	// Other overlays only check the terminator, so they keep using the stored index.
+	auto md = artdaq::ContainerFragment(f).metadata();
+	auto index = reinterpret_cast<size_t*>(f.dataBeginBytes() + md->index_offset);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	auto good_entry = index[1234];                                                   // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	index[1234] += sizeof(artdaq::RawDataType);                                     // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	{
+		artdaq::ContainerFragment verified(f);
+		artdaq::ContainerFragment unverified(f);
+		BOOST_REQUIRE(!verified.validateIndex());
+		BOOST_REQUIRE(!verified.verifyIndex());
+		BOOST_REQUIRE_EQUAL(verified.fragmentIndex(1235), good_entry);
+		BOOST_REQUIRE_EQUAL(unverified.fragmentIndex(1235), good_entry + sizeof(artdaq::RawDataType));
+		for (int ii = 1230; ii < 1240; ++ii)
+		{
+			BOOST_REQUIRE_EQUAL(verified.at(ii)->fragmentID(), ii);
+			BOOST_REQUIRE_EQUAL(verified.fragSize(ii), (ii % 3 + artdaq::detail::RawFragmentHeader::num_words()) * sizeof(artdaq::RawDataType));
+		}
+	}
+	index[1234] = good_entry;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+
+	// A container without a stored index is readable
+	auto mutable_md = f.metadata<artdaq::ContainerFragment::Metadata>();
+	mutable_md->has_index = 0;
+	{
+		artdaq::ContainerFragment cf(f);
+		BOOST_REQUIRE(!cf.validateIndex());
+		BOOST_REQUIRE_EQUAL(cf.block_count(), VALIDATION_BLOCK_COUNT);
+		BOOST_REQUIRE_EQUAL(cf.at(VALIDATION_BLOCK_COUNT - 1)->fragmentID(), VALIDATION_BLOCK_COUNT - 1);
+	}
+
+	// Block sizes which run past the payload are reported rather than read
+	auto first_block = reinterpret_cast<artdaq::detail::RawFragmentHeader*>(f.dataBegin());  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+	first_block->word_count = 0;
+	{
+		artdaq::ContainerFragment cf(f);
+		BOOST_REQUIRE_EXCEPTION(cf.at(0), cet::exception, [&](cet::exception e) { return e.category() == "InvalidIndex"; });
+	}
+}
+
+#define CACHE_BLOCK_COUNT 20000
+BOOST_AUTO_TEST_CASE(IndexCache)
+{
+	artdaq::ContainerFragment::ClearIndexCache();
+
+	artdaq::Fragment f(0);
+	f.setSequenceID(3);
+	{
+		artdaq::ContainerFragmentLoader cfl(f, artdaq::Fragment::FirstUserFragmentType);
+		for (int ii = 0; ii < CACHE_BLOCK_COUNT; ++ii)
+		{
+			auto hdr = cfl.appendFragment(ii % 3);
+			hdr->fragment_id = ii;
+		}
+	}
+	f.metadata<artdaq::ContainerFragment::Metadata>()->has_index = 0;
+	auto expected_index = [](size_t block) {
+		size_t offset = 0;
+		for (size_t ii = 0; ii <= block; ++ii) offset += (ii % 3 + artdaq::detail::RawFragmentHeader::num_words()) * sizeof(artdaq::RawDataType);
+		return offset;
+	};
+
+	// The first overlay rebuilds the index from the headers, later overlays reuse it
+	auto start_time = std::chrono::steady_clock::now();
+	{
+		artdaq::ContainerFragment cf(f);
+		BOOST_REQUIRE_EQUAL(cf.at(CACHE_BLOCK_COUNT - 1)->fragmentID(), CACHE_BLOCK_COUNT - 1);
+	}
+	auto first_time = artdaq::TimeUtils::GetElapsedTimeMicroseconds(start_time);
+	start_time = std::chrono::steady_clock::now();
+	for (int ii = 0; ii < 100; ++ii)
+	{
+		artdaq::ContainerFragment cf(f);
+		BOOST_REQUIRE_EQUAL(cf.fragmentIndex(CACHE_BLOCK_COUNT), expected_index(CACHE_BLOCK_COUNT - 1));
+	}
+	auto cached_time = artdaq::TimeUtils::GetElapsedTimeMicroseconds(start_time);
+	TLOG(TLVL_INFO, "ContainerFragment_t") << "Rebuilding the index of a " << CACHE_BLOCK_COUNT << "-block container took " << first_time << " us, 100 further overlays took " << cached_time << " us";
+
+	// A header rewritten in place in the middle of the container is not noticed until the cache is cleared
+	auto is_invalid_index = [](cet::exception const& e) { return e.category() == "InvalidIndex"; };
+	auto payload = f.dataBeginBytes();
+	auto middle = reinterpret_cast<artdaq::detail::RawFragmentHeader*>(payload + expected_index(999));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	auto middle_words = middle->word_count;
+	middle->word_count = 0;
+	{
+		artdaq::ContainerFragment cf(f);
+		BOOST_REQUIRE_EQUAL(cf.fragmentIndex(1001), expected_index(1000));
+	}
+	artdaq::ContainerFragment::ClearIndexCache();
+	{
+		artdaq::ContainerFragment cf(f);
+		BOOST_REQUIRE_EXCEPTION(cf.fragmentIndex(1001), cet::exception, is_invalid_index);
+	}
+	middle->word_count = middle_words;
+	{
+		artdaq::ContainerFragment cf(f);
+		BOOST_REQUIRE_EQUAL(cf.fragmentIndex(1001), expected_index(1000));
+	}
+
+	// Changes to the Fragment's identity, size or outer headers are detected without clearing the cache
+	middle->word_count = 0;
+	f.setSequenceID(4);
+	{
+		artdaq::ContainerFragment cf(f);
+		BOOST_REQUIRE_EXCEPTION(cf.fragmentIndex(1001), cet::exception, is_invalid_index);
+	}
+	middle->word_count = middle_words;
+	{
+		artdaq::ContainerFragment cf(f);
+		BOOST_REQUIRE_EQUAL(cf.fragmentIndex(1001), expected_index(1000));
+	}
+	f.resize(f.dataSize() + 1);
+	middle->word_count = 0;
+	{
+		artdaq::ContainerFragment cf(f);
+		BOOST_REQUIRE_EXCEPTION(cf.fragmentIndex(1001), cet::exception, is_invalid_index);
+	}
+	middle->word_count = middle_words;
+	{
+		artdaq::ContainerFragment cf(f);
+		BOOST_REQUIRE_EQUAL(cf.fragmentIndex(CACHE_BLOCK_COUNT), expected_index(CACHE_BLOCK_COUNT - 1));
+	}
+	auto last = reinterpret_cast<artdaq::detail::RawFragmentHeader*>(f.dataBeginBytes() + expected_index(CACHE_BLOCK_COUNT - 2));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	last->word_count -= 1;
+	{
+		artdaq::ContainerFragment cf(f);
+		BOOST_REQUIRE_EQUAL(cf.fragmentIndex(CACHE_BLOCK_COUNT), expected_index(CACHE_BLOCK_COUNT - 1) - sizeof(artdaq::RawDataType));
+	}
+	artdaq::ContainerFragment::ClearIndexCache();
+}
+
+BOOST_AUTO_TEST_CASE(Reserve)
+{
+	const int block_count = 1000;
+	artdaq::Fragment frag(1, 0, artdaq::Fragment::FirstUserFragmentType);
+	frag.resize(4);
+	auto gap_is_zero = [](artdaq::ContainerFragment const& cf) {
+		auto begin = reinterpret_cast<uint8_t const*>(cf.dataBegin());  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+		return std::all_of(begin + cf.lastFragmentIndex(), begin + cf.metadata()->index_offset, [](uint8_t b) { return b == 0; });
+	};
+
+	artdaq::Fragment f(0);
+	f.setSequenceID(1);
+	artdaq::ContainerFragmentLoader cfl(f, artdaq::Fragment::FirstUserFragmentType, block_count * frag.sizeBytes(), block_count);
+	auto storage = f.headerAddress();
+
+	// Reserving allocates capacity only; the Fragment does not grow
+	BOOST_REQUIRE_EQUAL(f.dataSizeBytes(), sizeof(size_t));
+	BOOST_REQUIRE_EQUAL(cfl.metadata()->index_offset, 0);
+
+	auto start_time = std::chrono::steady_clock::now();
+	for (int ii = 0; ii < block_count; ++ii)
+	{
+		frag.setFragmentID(ii);
+		cfl.addFragment(frag);
+	}
+	TLOG(TLVL_INFO, "ContainerFragment_t") << "Adding " << block_count << " Fragments to a pre-sized container took " << artdaq::TimeUtils::GetElapsedTimeMicroseconds(start_time) << " us";
+
+	// No reallocation within the reservation
+	BOOST_REQUIRE_EQUAL(f.headerAddress(), storage);
+	BOOST_REQUIRE_EQUAL(cfl.block_count(), block_count);
+	BOOST_REQUIRE_EQUAL(cfl.at(block_count - 1)->fragmentID(), block_count - 1);
+	BOOST_REQUIRE_EQUAL(f.dataSizeBytes(), cfl.metadata()->index_offset + (block_count + 1) * sizeof(size_t));
+	BOOST_REQUIRE(gap_is_zero(cfl));
+
+	// Exceeding the reservation falls back to growth
+	frag.setFragmentID(block_count);
+	cfl.addFragment(frag);
+	artdaq::ContainerFragment grown(f);
+	BOOST_REQUIRE(grown.validateIndex());
+	BOOST_REQUIRE_EQUAL(cfl.block_count(), block_count + 1);
+	BOOST_REQUIRE_EQUAL(cfl.at(block_count)->fragmentID(), block_count);
+	BOOST_REQUIRE_EQUAL(cfl.at(0)->fragmentID(), 0);
+
+	// Reserving more space on a partially-filled container
+	auto size = f.sizeBytes();
+	cfl.reserve(block_count * frag.sizeBytes(), block_count);
+	BOOST_REQUIRE_EQUAL(f.sizeBytes(), size);
+	storage = f.headerAddress();
+	for (int ii = 0; ii < block_count; ++ii)
+	{
+		cfl.appendFragment(4);
+	}
+	BOOST_REQUIRE_EQUAL(f.headerAddress(), storage);
+	BOOST_REQUIRE_EQUAL(cfl.block_count(), 2 * block_count + 1);
+	BOOST_REQUIRE(artdaq::ContainerFragment(f).validateIndex());
+	BOOST_REQUIRE(gap_is_zero(cfl));
+
+	// Unused reservation is not part of the ContainerFragment
+	artdaq::Fragment over(0);
+	over.setSequenceID(1);
+	artdaq::ContainerFragmentLoader over_cfl(over, artdaq::Fragment::FirstUserFragmentType, 100 * frag.sizeBytes(), 100);
+	artdaq::Fragment plain(0);
+	plain.setSequenceID(1);
+	artdaq::ContainerFragmentLoader plain_cfl(plain, artdaq::Fragment::FirstUserFragmentType);
+	for (int ii = 0; ii < 3; ++ii)
+	{
+		over_cfl.addFragment(frag);
+		plain_cfl.addFragment(frag);
+	}
+	BOOST_REQUIRE_EQUAL(over.sizeBytes(), plain.sizeBytes());
+	BOOST_REQUIRE_EQUAL(over.dataSizeBytes(), 3 * frag.sizeBytes() + 4 * sizeof(size_t));
+	BOOST_REQUIRE_EQUAL(over_cfl.metadata()->index_offset, over_cfl.lastFragmentIndex());
+}
+
+BOOST_AUTO_TEST_CASE(View)
+{
+	std::vector<artdaq::Fragment::value_type> fakeData{1, 2, 3, 4};
+	artdaq::Fragment f(0);
+	f.setSequenceID(1);
+	artdaq::ContainerFragmentLoader cfl(f);
+	for (size_t ii = 0; ii < 3; ++ii)
+	{
+		artdaq::FragmentPtr tmpFrag(artdaq::Fragment::dataFrag(1, ii, fakeData.begin(), fakeData.begin() + ii + 1));
+		tmpFrag->setUserType(artdaq::Fragment::FirstUserFragmentType);
+		cfl.addFragment(tmpFrag);
+	}
+
+	artdaq::ContainerFragment cf(f);
+	BOOST_REQUIRE(cf.begin() != cf.end());
+	size_t ii = 0;
+	for (auto view : cf)
+	{
+		BOOST_REQUIRE_EQUAL(view.sequenceID(), 1);
+		BOOST_REQUIRE_EQUAL(view.fragmentID(), ii);
+		BOOST_REQUIRE_EQUAL(view.type(), artdaq::Fragment::FirstUserFragmentType);
+		BOOST_REQUIRE_EQUAL(view.dataSize(), ii + 1);
+		BOOST_REQUIRE_EQUAL(view.sizeBytes(), cf.fragSize(ii));
+		BOOST_REQUIRE_EQUAL(view.dataBegin()[ii], fakeData[ii]);
+		BOOST_REQUIRE_EQUAL(cf.view(ii).headerAddress(), view.headerAddress());
+		++ii;
+	}
+	BOOST_REQUIRE_EQUAL(ii, 3);
+
+	// Views point into the container's storage
+	BOOST_REQUIRE_EQUAL(static_cast<void const*>(cf.view(0).headerAddress()), cf.dataBegin());
+	BOOST_REQUIRE_EXCEPTION(cf.view(3), cet::exception, [&](cet::exception e) { return e.category() == "ArgumentOutOfRange"; });
+
+	auto copy = cf.view(2).toFragment();
+	BOOST_REQUIRE_EQUAL(copy->fragmentID(), 2);
+	BOOST_REQUIRE_EQUAL(copy->dataSize(), 3);
+
+	artdaq::Fragment empty(0);
+	artdaq::ContainerFragmentLoader emptyLoader(empty);
+	BOOST_REQUIRE(emptyLoader.begin() == emptyLoader.end());
+}
+
+BOOST_AUTO_TEST_CASE(View_V1)
+{
+	// Contained Fragments written with an older RawFragmentHeader are decoded on access
+	artdaq::detail::RawFragmentHeaderV1 hdr1;
+	hdr1.word_count = artdaq::detail::RawFragmentHeaderV1::num_words() + 2;
+	hdr1.version = 1;
+	hdr1.type = artdaq::Fragment::FirstUserFragmentType;
+	hdr1.metadata_word_count = 0;
+	hdr1.sequence_id = 5;
+	hdr1.fragment_id = 6;
+	hdr1.timestamp = 0xCAFEFECAAAAABBBB;
+	std::vector<artdaq::RawDataType> block(hdr1.word_count);
+	memcpy(block.data(), &hdr1, sizeof(hdr1));
+	block[artdaq::detail::RawFragmentHeaderV1::num_words()] = 11;
+	block[artdaq::detail::RawFragmentHeaderV1::num_words() + 1] = 12;
+
+	artdaq::FragmentView view(block.data());
+	BOOST_REQUIRE_EQUAL(view.version(), 1);
+	BOOST_REQUIRE_EQUAL(view.headerSizeWords(), artdaq::detail::RawFragmentHeaderV1::num_words());
+	BOOST_REQUIRE_EQUAL(view.sequenceID(), 5);
+	BOOST_REQUIRE_EQUAL(view.fragmentID(), 6);
+	BOOST_REQUIRE_EQUAL(view.timestamp(), 0xCAFEFECAAAAABBBB);
+	BOOST_REQUIRE_EQUAL(view.dataSize(), 2);
+	BOOST_REQUIRE_EQUAL(view.dataBegin()[0], 11);
+	BOOST_REQUIRE_EQUAL(view.header().version, (artdaq::Fragment::version_t)artdaq::detail::RawFragmentHeader::CurrentVersion);
+}
+
+BOOST_AUTO_TEST_CASE(Nested)
+{
+	// link -> crate -> detector
+	const size_t crates = 3, links = 4;
+	artdaq::Fragment detector(0);
+	detector.setSequenceID(7);
+	artdaq::ContainerFragmentLoader detectorLoader(detector, artdaq::Fragment::ContainerFragmentType);
+	for (size_t crate = 0; crate < crates; ++crate)
+	{
+		artdaq::Fragment crateFrag(0);
+		crateFrag.setSequenceID(7);
+		crateFrag.setFragmentID(crate);
+		artdaq::ContainerFragmentLoader crateLoader(crateFrag, artdaq::Fragment::FirstUserFragmentType);
+		for (size_t link = 0; link < links; ++link)
+		{
+			auto hdr = crateLoader.appendFragment(link + 1);
+			hdr->fragment_id = crate * links + link;
+			reinterpret_cast<artdaq::RawDataType*>(hdr + 1)[link] = 100 * crate + link;  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		}
+		detectorLoader.addFragment(crateFrag);
+	}
+
+	artdaq::ContainerFragment cf(detector);
+	BOOST_REQUIRE_EQUAL(cf.block_count(), crates);
+	for (size_t crate = 0; crate < crates; ++crate)
+	{
+		BOOST_REQUIRE_EQUAL(cf.view({crate}).fragmentID(), crate);
+		for (size_t link = 0; link < links; ++link)
+		{
+			auto leaf = cf.view({crate, link});
+			BOOST_REQUIRE_EQUAL(leaf.fragmentID(), crate * links + link);
+			BOOST_REQUIRE_EQUAL(leaf.dataSize(), link + 1);
+			BOOST_REQUIRE_EQUAL(leaf.dataBegin()[link], 100 * crate + link);
+			BOOST_REQUIRE_EQUAL(artdaq::ContainerFragment::NestedView(cf.view(crate), link).headerAddress(), leaf.headerAddress());
+		}
+	}
+	auto copy = cf.at({2, 3});
+	BOOST_REQUIRE_EQUAL(copy->fragmentID(), 2 * links + 3);
+	BOOST_REQUIRE_EQUAL(copy->dataBegin()[3], 203);
+
+	BOOST_REQUIRE_EXCEPTION(cf.view(std::vector<size_t>()), cet::exception, [&](cet::exception e) { return e.category() == "ArgumentOutOfRange"; });
+	BOOST_REQUIRE_EXCEPTION(cf.view({0, links}), cet::exception, [&](cet::exception e) { return e.category() == "ArgumentOutOfRange"; });
+	BOOST_REQUIRE_EXCEPTION(cf.view({0, 0, 0}), cet::exception, [&](cet::exception e) { return e.category() == "InvalidPath"; });
+
+	// Nested containers without a stored index are walked
+	auto crate1 = const_cast<artdaq::RawDataType*>(cf.view(1).metadataAddress());                  // NOLINT(cppcoreguidelines-pro-type-const-cast)
+	reinterpret_cast<artdaq::ContainerFragment::Metadata*>(crate1)->has_index = 0;                  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+	BOOST_REQUIRE_EQUAL(cf.view({1, 2}).fragmentID(), links + 2);
+	BOOST_REQUIRE_EQUAL(cf.view({1, 3}).dataBegin()[3], 103);
+}
+
+#define MANY_BLOCK_COUNT 70000
+BOOST_AUTO_TEST_CASE(ManyBlocks)
+{
+	// Version 2 containers are not limited to 65535 Fragments
+	artdaq::Fragment f(0);
+	f.setSequenceID(1);
+	artdaq::ContainerFragmentLoader cfl(f, artdaq::Fragment::FirstUserFragmentType, MANY_BLOCK_COUNT * artdaq::detail::RawFragmentHeader::num_words() * sizeof(artdaq::RawDataType), MANY_BLOCK_COUNT);
+	for (int ii = 0; ii < MANY_BLOCK_COUNT; ++ii)
+	{
+		cfl.appendFragment(0)->timestamp = ii;
+	}
+	BOOST_REQUIRE_EQUAL(cfl.metadata()->version, artdaq::ContainerFragment::CURRENT_VERSION);
+	BOOST_REQUIRE_EQUAL(cfl.metadata()->block_count_high, 1);
+
+	artdaq::ContainerFragment cf(f);
+	BOOST_REQUIRE_EQUAL(cf.block_count(), MANY_BLOCK_COUNT);
+	BOOST_REQUIRE(cf.validateIndex());
+	BOOST_REQUIRE_EQUAL(cf.view(MANY_BLOCK_COUNT - 1).timestamp(), MANY_BLOCK_COUNT - 1);
+	BOOST_REQUIRE_EQUAL(cf.lastFragmentIndex(), MANY_BLOCK_COUNT * artdaq::detail::RawFragmentHeader::num_words() * sizeof(artdaq::RawDataType));
+}
+
+BOOST_AUTO_TEST_CASE(ReadVersion1)
+{
+	// Version 1 containers did not initialize the upper bits of the block count
+	artdaq::Fragment f(0);
+	f.setSequenceID(1);
+	artdaq::ContainerFragmentLoader cfl(f, artdaq::Fragment::FirstUserFragmentType);
+	for (int ii = 0; ii < 3; ++ii)
+	{
+		cfl.appendFragment(ii)->fragment_id = ii;
+	}
+	cfl.metadata()->version = 1;
+	cfl.metadata()->block_count_high = 0xDEADBEEF;
+
+	artdaq::ContainerFragment cf(f);
+	BOOST_REQUIRE_EQUAL(cf.block_count(), 3);
+	BOOST_REQUIRE(cf.validateIndex());
+	BOOST_REQUIRE_EQUAL(cf.at(2)->fragmentID(), 2);
+	BOOST_REQUIRE_EQUAL(cf.fragSize(2), (2 + artdaq::detail::RawFragmentHeader::num_words()) * sizeof(artdaq::RawDataType));
+}
+
+BOOST_AUTO_TEST_CASE(Compressed)
+{
+	// 16-bit samples of a noisy baseline with periodic pulses, like ADC waveforms
+	const size_t blocks = 20, samples = 2048;
+	artdaq::Fragments frags;
+	for (size_t ii = 0; ii < blocks; ++ii)
+	{
+		frags.emplace_back(3, ii, artdaq::Fragment::FirstUserFragmentType);
+		frags.back().resizeBytes(samples * sizeof(uint16_t));
+		auto adc = reinterpret_cast<uint16_t*>(frags.back().dataBegin());  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+		for (size_t jj = 0; jj < samples; ++jj)
+		{
+			auto t = static_cast<double>((jj + 37 * ii) % 512);
+			adc[jj] = static_cast<uint16_t>(2048 + (jj * 7 + ii) % 3 + (t < 64 ? 800 * t / 64 * exp(-t / 16) : 0));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		}
+	}
+
+	artdaq::Fragment f(0);
+	f.setSequenceID(3);
+	artdaq::ContainerFragmentLoader cfl(f);
+	cfl.addFragments(frags);
+	auto raw_size = f.sizeBytes();
+	auto start_time = std::chrono::steady_clock::now();
+	cfl.compress();
+	TLOG(TLVL_INFO, "ContainerFragment_t") << "Compressing " << raw_size << " bytes to " << f.sizeBytes() << " bytes took " << artdaq::TimeUtils::GetElapsedTimeMicroseconds(start_time) << " us";
+	BOOST_REQUIRE(f.sizeBytes() < raw_size / 2);
+	BOOST_REQUIRE_EXCEPTION(cfl.addFragment(frags.front()), cet::exception, [&](cet::exception e) { return e.category() == "CompressedContainer"; });
+
+	artdaq::ContainerFragment cf(f);
+	BOOST_REQUIRE(cf.compressed());
+	BOOST_REQUIRE(cf.validateIndex());
+	BOOST_REQUIRE_EQUAL(cf.block_count(), blocks);
+	for (size_t ii = blocks; ii-- > 0;)
+	{
+		BOOST_REQUIRE_EQUAL(cf.fragSize(ii), frags[ii].sizeBytes());
+		auto out = cf.at(ii);
+		BOOST_REQUIRE_EQUAL(out->fragmentID(), ii);
+		BOOST_REQUIRE_EQUAL(out->sizeBytes(), frags[ii].sizeBytes());
+		BOOST_REQUIRE_EQUAL(memcmp(out->dataBeginBytes(), frags[ii].dataBeginBytes(), frags[ii].dataSizeBytes()), 0);
+	}
+	BOOST_REQUIRE_EXCEPTION(cf.view(0), cet::exception, [&](cet::exception e) { return e.category() == "CompressedContainer"; });
+	BOOST_REQUIRE_EXCEPTION(cf.begin(), cet::exception, [&](cet::exception e) { return e.category() == "CompressedContainer"; });
+
+	// Corrupt compressed data is reported
+	f.dataBeginBytes()[cf.fragmentIndex(1) + 8] ^= 0xFF;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	BOOST_REQUIRE_EXCEPTION(cf.at(1), cet::exception, [&](cet::exception e) { return e.category() == "DecompressionError"; });
+	BOOST_REQUIRE_EQUAL(cf.at(0)->fragmentID(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(BlockInfo)
+{
+	const size_t block_count = 1000;
+	artdaq::Fragment f(0);
+	f.setSequenceID(4);
+	artdaq::ContainerFragmentLoader cfl(f, artdaq::Fragment::FirstUserFragmentType);
+	for (size_t ii = 0; ii < block_count; ++ii)
+	{
+		auto hdr = cfl.appendFragment(1);
+		hdr->timestamp = 100 + 10 * ii;
+		hdr->fragment_id = ii % 7;
+		hdr->sequence_id = 4;
+	}
+	auto size_without_info = f.dataSizeBytes();
+
+	// Without stored block information, the headers are scanned
+	BOOST_REQUIRE(!cfl.has_block_info());
+	BOOST_REQUIRE_EQUAL(cfl.blockTimestamp(10), 200);
+	auto blocks = cfl.blocksInTimeRange(195, 245);
+	BOOST_REQUIRE_EQUAL(blocks.size(), 5);
+	BOOST_REQUIRE_EQUAL(blocks.front(), 10);
+
+	cfl.writeBlockInfo();
+	BOOST_REQUIRE_EQUAL(f.dataSizeBytes(), size_without_info + (1 + 2 * block_count + block_count / 4) * sizeof(artdaq::RawDataType));
+	artdaq::ContainerFragment cf(f);
+	BOOST_REQUIRE(cf.has_block_info());
+	BOOST_REQUIRE(cf.validateIndex());
+	for (size_t ii = 0; ii < block_count; ii += 37)
+	{
+		BOOST_REQUIRE_EQUAL(cf.blockTimestamp(ii), 100 + 10 * ii);
+		BOOST_REQUIRE_EQUAL(cf.blockFragmentID(ii), ii % 7);
+		BOOST_REQUIRE_EQUAL(cf.blockSequenceID(ii), 4);
+	}
+	BOOST_REQUIRE_EXCEPTION(cf.blockTimestamp(block_count), cet::exception, [&](cet::exception e) { return e.category() == "ArgumentOutOfRange"; });
+
+	blocks = cf.blocksInTimeRange(195, 245);
+	BOOST_REQUIRE_EQUAL(blocks.size(), 5);
+	for (size_t ii = 0; ii < blocks.size(); ++ii)
+	{
+		BOOST_REQUIRE_EQUAL(blocks[ii], 10 + ii);
+	}
+	BOOST_REQUIRE(cf.blocksInTimeRange(0, 99).empty());
+	BOOST_REQUIRE(cf.blocksInTimeRange(250, 195).empty());
+	BOOST_REQUIRE_EQUAL(cf.blocksInTimeRange(0, artdaq::Fragment::InvalidTimestamp).size(), block_count);
+
+	// Out-of-order timestamps are scanned
+	cfl.lastFragmentHeader()->timestamp = 0;
+	cfl.writeBlockInfo();
+	blocks = cf.blocksInTimeRange(0, 215);
+	BOOST_REQUIRE_EQUAL(blocks.size(), 13);
+	BOOST_REQUIRE_EQUAL(blocks.front(), 0);
+	BOOST_REQUIRE_EQUAL(blocks[11], 11);
+	BOOST_REQUIRE_EQUAL(blocks.back(), block_count - 1);
+
+	// Block information survives compression
+	cfl.compress();
+	BOOST_REQUIRE(cfl.has_block_info());
+	BOOST_REQUIRE_EQUAL(cfl.blockTimestamp(500), 5100);
+	BOOST_REQUIRE_EQUAL(cfl.blocksInTimeRange(5100, 5100).front(), 500);
+	BOOST_REQUIRE_EQUAL(cfl.at(500)->timestamp(), 5100);
+
+	// Modifying the container removes it
+	artdaq::Fragment f2(0);
+	artdaq::ContainerFragmentLoader cfl2(f2, artdaq::Fragment::FirstUserFragmentType);
+	cfl2.appendFragment(1)->timestamp = 5;
+	cfl2.writeBlockInfo();
+	BOOST_REQUIRE(cfl2.has_block_info());
+	cfl2.appendFragment(1)->timestamp = 6;
+	BOOST_REQUIRE(!cfl2.has_block_info());
+	BOOST_REQUIRE_EQUAL(f2.dataSizeBytes(), 2 * (artdaq::detail::RawFragmentHeader::num_words() + 1 + 1) * sizeof(artdaq::RawDataType) + sizeof(size_t));
+	BOOST_REQUIRE_EQUAL(cfl2.blocksInTimeRange(6, 6).front(), 1);
+}
+
 BOOST_AUTO_TEST_CASE(Exceptions)
 {
 	artdaq::Fragment f(0);
@@ -234,6 +868,19 @@ BOOST_AUTO_TEST_CASE(Exceptions)
 	ff1.emplace_back(new artdaq::Fragment(102, 203));
 	ff1.back()->setSystemType(artdaq::Fragment::EmptyFragmentType);
 	BOOST_REQUIRE_EXCEPTION(cfl3.addFragments(ff1), cet::exception, [&](cet::exception e) { return e.category() == "WrongFragmentType"; });
+
+	// A rejected add leaves the container unchanged, including the type of an empty container
+	artdaq::Fragment f4(0);
+	f4.setSequenceID(1);
+	artdaq::ContainerFragmentLoader cfl4(f4);
+	auto size_before = f4.dataSizeBytes();
+	artdaq::FragmentPtrs ff2;
+	ff2.emplace_back(new artdaq::Fragment(101, 202, artdaq::Fragment::FirstUserFragmentType));
+	ff2.emplace_back(new artdaq::Fragment(101, 203, artdaq::Fragment::FirstUserFragmentType + 1));
+	BOOST_REQUIRE_EXCEPTION(cfl4.addFragments(ff2), cet::exception, [&](cet::exception e) { return e.category() == "WrongFragmentType"; });
+	BOOST_REQUIRE_EQUAL(cfl4.fragment_type(), artdaq::Fragment::EmptyFragmentType);
+	BOOST_REQUIRE_EQUAL(cfl4.block_count(), 0);
+	BOOST_REQUIRE_EQUAL(f4.dataSizeBytes(), size_before);
 }
 
 BOOST_AUTO_TEST_CASE(Upgrade)
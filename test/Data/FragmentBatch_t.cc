@@ -0,0 +1,185 @@
+#include "artdaq-core/Data/FragmentBatch.hh"
+
+#define BOOST_TEST_MODULE(FragmentBatch_t)
+#include "cetlib/quiet_unit_test.hpp"
+
+#include "artdaq-core/Utilities/TimeUtils.hh"
+
+#define TRACE_NAME "FragmentBatch_t"
+#include "TRACE/tracemf.h"
+
+BOOST_AUTO_TEST_SUITE(FragmentBatch_test)
+
+BOOST_AUTO_TEST_CASE(Construct)
+{
+	artdaq::FragmentBatch batch(10, 100);
+	BOOST_REQUIRE(batch.empty());
+	BOOST_REQUIRE_EQUAL(batch.size(), 0);
+	BOOST_REQUIRE_EQUAL(batch.sizeWords(), 0);
+	BOOST_REQUIRE(batch.begin() == batch.end());
+	BOOST_REQUIRE_THROW(batch.at(0), cet::exception);
+}
+
+BOOST_AUTO_TEST_CASE(Append)
+{
+	artdaq::FragmentBatch batch;
+	for (size_t ii = 0; ii < 5; ++ii)
+	{
+		auto data = batch.append(ii, 1, ii, artdaq::Fragment::FirstUserFragmentType, 100 + ii);
+		for (size_t jj = 0; jj < ii; ++jj)
+		{
+			data[jj] = ii * 10 + jj;
+		}
+	}
+
+	// Types are validated as in the Fragment constructor, without modifying the FragmentBatch
+	BOOST_REQUIRE_THROW(batch.append(1, 1, 5, artdaq::Fragment::ContainerFragmentType), cet::exception);
+	BOOST_REQUIRE_THROW(batch.append(1, 1, 5, 0), cet::exception);
+
+	BOOST_REQUIRE_EQUAL(batch.size(), 5);
+	BOOST_REQUIRE_EQUAL(batch.sizeWords(), 5 * artdaq::detail::RawFragmentHeader::num_words() + 10);
+	BOOST_REQUIRE_EQUAL(batch.sizeBytes(), batch.sizeWords() * sizeof(artdaq::RawDataType));
+
+	size_t ii = 0;
+	for (auto view : batch)
+	{
+		BOOST_REQUIRE_EQUAL(view.sequenceID(), 1);
+		BOOST_REQUIRE_EQUAL(view.fragmentID(), ii);
+		BOOST_REQUIRE_EQUAL(view.type(), artdaq::Fragment::FirstUserFragmentType);
+		BOOST_REQUIRE_EQUAL(view.timestamp(), 100 + ii);
+		BOOST_REQUIRE_EQUAL(view.dataSize(), ii);
+		BOOST_REQUIRE(!view.hasMetadata());
+		BOOST_REQUIRE_EQUAL(view.header().version, (artdaq::Fragment::version_t)artdaq::detail::RawFragmentHeader::CurrentVersion);
+		for (size_t jj = 0; jj < ii; ++jj)
+		{
+			BOOST_REQUIRE_EQUAL(view.dataBegin()[jj], ii * 10 + jj);
+		}
+		BOOST_REQUIRE_EQUAL(batch[ii].headerAddress(), view.headerAddress());
+		++ii;
+	}
+	BOOST_REQUIRE_EQUAL(ii, 5);
+
+	batch.dataBegin(2)[1] = 42;
+	BOOST_REQUIRE_EQUAL(batch.at(2).dataBegin()[1], 42);
+
+	batch.clear();
+	BOOST_REQUIRE(batch.empty());
+	BOOST_REQUIRE_EQUAL(batch.sizeWords(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(AppendFragment)
+{
+	struct Metadata
+	{
+		uint64_t value;
+	};
+	std::vector<artdaq::Fragment::value_type> fakeData{1, 2, 3, 4};
+	artdaq::FragmentPtr frag(artdaq::Fragment::dataFrag(3, 4, fakeData.begin(), fakeData.end()));
+	frag->setUserType(artdaq::Fragment::FirstUserFragmentType);
+	frag->setTimestamp(5);
+	Metadata md{0x12345};
+	frag->setMetadata(md);
+
+	artdaq::FragmentBatch batch;
+	batch.append(*frag);
+	BOOST_REQUIRE_EQUAL(batch.size(), 1);
+	BOOST_REQUIRE_EQUAL(batch.sizeWords(), frag->size());
+
+	auto view = batch[0];
+	BOOST_REQUIRE(view.hasMetadata());
+	BOOST_REQUIRE_EQUAL(view.metadataAddress()[0], 0x12345);
+	BOOST_REQUIRE_EQUAL(view.dataSize(), 4);
+	BOOST_REQUIRE_EQUAL(view.dataBegin()[3], 4);
+
+	auto copy = view.toFragment();
+	BOOST_REQUIRE_EQUAL(copy->sequenceID(), 3);
+	BOOST_REQUIRE_EQUAL(copy->fragmentID(), 4);
+	BOOST_REQUIRE_EQUAL(copy->timestamp(), 5);
+	BOOST_REQUIRE_EQUAL(copy->metadata<Metadata>()->value, 0x12345);
+	BOOST_REQUIRE_EQUAL(copy->dataSize(), 4);
+	BOOST_REQUIRE_EQUAL(*(copy->dataBegin() + 2), 3);
+}
+
+BOOST_AUTO_TEST_CASE(ToFragments)
+{
+	artdaq::FragmentBatch batch;
+	for (size_t ii = 0; ii < 3; ++ii)
+	{
+		batch.append(2, 7, ii, artdaq::Fragment::FirstUserFragmentType)[1] = ii;
+	}
+
+	artdaq::FragmentPtrs frags;
+	batch.toFragments(frags);
+	BOOST_REQUIRE_EQUAL(frags.size(), 3);
+	size_t ii = 0;
+	for (auto& frag : frags)
+	{
+		BOOST_REQUIRE_EQUAL(frag->sequenceID(), 7);
+		BOOST_REQUIRE_EQUAL(frag->fragmentID(), ii);
+		BOOST_REQUIRE_EQUAL(frag->dataSize(), 2);
+		BOOST_REQUIRE_EQUAL(*(frag->dataBegin() + 1), ii);
+		++ii;
+	}
+}
+
+BOOST_AUTO_TEST_CASE(ToContainerFragment)
+{
+	artdaq::FragmentBatch batch;
+	for (size_t ii = 0; ii < 3; ++ii)
+	{
+		batch.append(ii + 1, 7, ii, artdaq::Fragment::FirstUserFragmentType)[0] = ii;
+	}
+
+	auto frag = batch.toContainerFragment(7, 99, 1234);
+	BOOST_REQUIRE_EQUAL(frag->type(), artdaq::Fragment::ContainerFragmentType);
+	BOOST_REQUIRE_EQUAL(frag->sequenceID(), 7);
+	BOOST_REQUIRE_EQUAL(frag->fragmentID(), 99);
+	BOOST_REQUIRE_EQUAL(frag->timestamp(), 1234);
+
+	artdaq::ContainerFragment cf(*frag);
+	BOOST_REQUIRE_EQUAL(cf.block_count(), 3);
+	BOOST_REQUIRE_EQUAL(cf.fragment_type(), artdaq::Fragment::FirstUserFragmentType);
+	BOOST_REQUIRE_EQUAL(memcmp(cf.dataBegin(), batch.data(), batch.sizeBytes()), 0);
+	for (size_t ii = 0; ii < 3; ++ii)
+	{
+		auto out = cf[ii];
+		BOOST_REQUIRE_EQUAL(out->fragmentID(), ii);
+		BOOST_REQUIRE_EQUAL(out->dataSize(), ii + 1);
+		BOOST_REQUIRE_EQUAL(*out->dataBegin(), ii);
+	}
+
+	batch.append(1, 7, 3, artdaq::Fragment::FirstUserFragmentType + 1);
+	BOOST_REQUIRE_THROW(batch.toContainerFragment(7, 99), cet::exception);
+	auto mixed = batch.toContainerFragment(7, 99, 1234, true);
+	artdaq::ContainerFragment mcf(*mixed);
+	BOOST_REQUIRE_EQUAL(mcf.block_count(), 4);
+}
+
+BOOST_AUTO_TEST_CASE(Performance)
+{
+	const size_t count = 10000;
+	const size_t payload = 4;
+
+	auto start = std::chrono::steady_clock::now();
+	artdaq::FragmentPtrs frags;
+	for (size_t ii = 0; ii < count; ++ii)
+	{
+		frags.emplace_back(new artdaq::Fragment(1, ii, artdaq::Fragment::FirstUserFragmentType));
+		frags.back()->resize(payload);
+		*frags.back()->dataBegin() = ii;
+	}
+	auto fragsTime = artdaq::TimeUtils::GetElapsedTimeMicroseconds(start);
+
+	start = std::chrono::steady_clock::now();
+	artdaq::FragmentBatch batch(count, count * (artdaq::detail::RawFragmentHeader::num_words() + payload));
+	for (size_t ii = 0; ii < count; ++ii)
+	{
+		batch.append(payload, 1, ii, artdaq::Fragment::FirstUserFragmentType)[0] = ii;
+	}
+	auto batchTime = artdaq::TimeUtils::GetElapsedTimeMicroseconds(start);
+
+	BOOST_REQUIRE_EQUAL(batch.size(), frags.size());
+	TLOG(TLVL_INFO) << "Creating " << count << " Fragments: FragmentPtrs " << fragsTime << " us, FragmentBatch " << batchTime << " us";
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -1,5 +1,6 @@
 #include "artdaq-core/Data/Fragment.hh"
 #include "artdaq-core/Data/detail/RawFragmentHeader.hh"
+#include "artdaq-core/Utilities/TimeUtils.hh"
 
 #define BOOST_TEST_MODULE(Fragment_t)
 #include <cetlib/quiet_unit_test.hpp>
@@ -141,8 +142,40 @@ BOOST_AUTO_TEST_CASE(FragmentType)
 
 	auto map = artdaq::detail::RawFragmentHeader::MakeVerboseSystemTypeMap();
 	BOOST_REQUIRE(map.size() > 0);
+	for (auto const& type : map)
+	{
+		BOOST_REQUIRE_EQUAL(artdaq::detail::RawFragmentHeader::SystemTypeName(type.first), type.second);
+	}
 	map = artdaq::detail::RawFragmentHeader::MakeSystemTypeMap();
 	BOOST_REQUIRE(map.size() > 0);
+	BOOST_REQUIRE_EQUAL(map[artdaq::Fragment::ContainerFragmentType], "Container");
+
+	static_assert(artdaq::detail::RawFragmentHeader::SystemTypeName(artdaq::Fragment::EndOfDataFragmentType)[0] == 'E', "System type names should be available at compile time");
+	BOOST_REQUIRE(artdaq::detail::RawFragmentHeader::SystemTypeName(240) == nullptr);
+	BOOST_REQUIRE_EQUAL(artdaq::detail::RawFragmentHeader::SystemTypeToString(240), "Unknown");
+}
+
+BOOST_AUTO_TEST_CASE(TypeNames)
+{
+	artdaq::Fragment frag(15);
+
+	frag.setSystemType(artdaq::Fragment::DataFragmentType);
+	BOOST_REQUIRE_EQUAL(frag.typeString(), "226 (Data)");
+	frag.setSystemType(240);
+	BOOST_REQUIRE_EQUAL(frag.typeString(), "240 (Unknown)");
+
+	frag.setUserType(42);
+	BOOST_REQUIRE_EQUAL(frag.typeString(), "42");
+	BOOST_REQUIRE(artdaq::Fragment::TypeName(42) == nullptr);
+	artdaq::Fragment::RegisterUserTypeName(42, "TestType");
+	BOOST_REQUIRE_EQUAL(artdaq::Fragment::TypeName(42), "TestType");
+	BOOST_REQUIRE_EQUAL(frag.typeString(), "42 (TestType)");
+	artdaq::Fragment::RegisterUserTypeName(42, "RenamedType");
+	BOOST_REQUIRE_EQUAL(frag.typeString(), "42 (RenamedType)");
+
+	BOOST_REQUIRE_EQUAL(artdaq::Fragment::TypeName(artdaq::Fragment::ShutdownFragmentType), "Shutdown");
+	BOOST_REQUIRE_THROW(artdaq::Fragment::RegisterUserTypeName(artdaq::Fragment::InvalidFragmentType, "Bad"), cet::exception);
+	BOOST_REQUIRE_THROW(artdaq::Fragment::RegisterUserTypeName(artdaq::Fragment::ContainerFragmentType, "Bad"), cet::exception);
 }
 
 BOOST_AUTO_TEST_CASE(SequenceID)
@@ -679,4 +712,265 @@ BOOST_AUTO_TEST_CASE(Upgrade_V1)
 	}
 }
 
+BOOST_AUTO_TEST_CASE(AccessTime)
+{
+	artdaq::Fragments frags(10);
+	for (auto& frag : frags)
+	{
+		frag.touch(timespec{0, 0});
+	}
+
+	artdaq::touchAll(frags);
+	auto first = frags.front().atime();
+	BOOST_REQUIRE_NE(first.tv_sec, 0);
+	for (auto& frag : frags)
+	{
+		BOOST_REQUIRE_EQUAL(frag.atime().tv_sec, first.tv_sec);
+		BOOST_REQUIRE_EQUAL(frag.atime().tv_nsec, first.tv_nsec);
+	}
+
+	artdaq::TimeUtils::setAccessTimeClock(artdaq::TimeUtils::AccessTimeClock::Disabled);
+	frags[0].touch(timespec{1, 2});
+	frags[0].touch();
+	BOOST_REQUIRE_EQUAL(frags[0].atime().tv_sec, 1);
+	BOOST_REQUIRE_EQUAL(frags[0].atime().tv_nsec, 2);
+	auto latency = frags[0].getLatency(true);
+	BOOST_REQUIRE_EQUAL(latency.tv_sec, 0);
+	BOOST_REQUIRE_EQUAL(latency.tv_nsec, 0);
+	BOOST_REQUIRE_EQUAL(frags[0].atime().tv_sec, 1);
+
+	artdaq::TimeUtils::setAccessTimeClock(artdaq::TimeUtils::AccessTimeClock::Coarse);
+	frags[0].touch();
+	BOOST_REQUIRE_NE(frags[0].atime().tv_sec, 1);
+	latency = frags[0].getLatency(false);
+	BOOST_REQUIRE_LT(latency.tv_sec, 1);
+
+	artdaq::TimeUtils::setAccessTimeClock(artdaq::TimeUtils::AccessTimeClock::Realtime);
+}
+
+BOOST_AUTO_TEST_CASE(UpgradeInPlace)
+{
+	artdaq::Fragment f(7);
+	artdaq::detail::RawFragmentHeaderV1 hdr1;
+
+	hdr1.word_count = artdaq::detail::RawFragmentHeader::num_words() + 7;
+	hdr1.version = 1;
+	hdr1.type = 0xFE;
+	hdr1.metadata_word_count = 0;
+
+	hdr1.sequence_id = 0xFEEDDEADBEEF;
+	hdr1.fragment_id = 0xBEE7;
+	hdr1.timestamp = 0xCAFEFECAAAAABBBB;
+
+	memcpy(f.headerBeginBytes(), &hdr1, sizeof(hdr1));
+
+	artdaq::detail::RawFragmentHeader::RawDataType counter = 0;
+	for (size_t ii = artdaq::detail::RawFragmentHeaderV1::num_words(); ii < artdaq::detail::RawFragmentHeader::num_words() + 7; ++ii)
+	{
+		memcpy(f.headerBegin() + ii, &(++counter), sizeof(counter));
+	}
+	auto payload_words = f.dataSize();
+
+	BOOST_REQUIRE_EQUAL(f.upgradeHeader(), true);
+	BOOST_REQUIRE_EQUAL(f.upgradeHeader(), false);
+
+	BOOST_REQUIRE_EQUAL(f.version(), (artdaq::Fragment::version_t)artdaq::detail::RawFragmentHeader::CurrentVersion);
+	BOOST_REQUIRE_EQUAL(f.headerSizeWords(), artdaq::detail::RawFragmentHeader::num_words());
+	BOOST_REQUIRE_EQUAL(f.size(), artdaq::detail::RawFragmentHeader::num_words() + payload_words);
+	BOOST_REQUIRE_EQUAL(f.dataSize(), payload_words);
+	BOOST_REQUIRE_EQUAL(f.type(), 0xFE);
+	BOOST_REQUIRE_EQUAL(f.sequenceID(), 0xFEEDDEADBEEF);
+	BOOST_REQUIRE_EQUAL(f.fragmentID(), 0xBEE7);
+	BOOST_REQUIRE_EQUAL(f.timestamp(), 0xCAFEFECAAAAABBBB);
+
+	for (size_t jj = 0; jj < f.dataSize(); ++jj)
+	{
+		BOOST_REQUIRE_EQUAL(*(f.dataBegin() + jj), jj + 1);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	}
+
+	// Setters on an old-version Fragment upgrade it first, so the new value lands in vals_
+	artdaq::Fragment g(3);
+	artdaq::detail::RawFragmentHeaderV0 hdr0;
+	hdr0.word_count = artdaq::detail::RawFragmentHeader::num_words() + 3;
+	hdr0.version = 0;
+	hdr0.type = 0xFE;
+	hdr0.metadata_word_count = 0;
+	hdr0.sequence_id = 0xFEEDDEADBEEF;
+	hdr0.fragment_id = 0xBEE7;
+	hdr0.timestamp = 0xCAFEFECA;
+	memcpy(g.headerBeginBytes(), &hdr0, sizeof(hdr0));
+
+	g.setSequenceID(5);
+	BOOST_REQUIRE_EQUAL(g.version(), (artdaq::Fragment::version_t)artdaq::detail::RawFragmentHeader::CurrentVersion);
+	BOOST_REQUIRE_EQUAL(g.sequenceID(), 5);
+	BOOST_REQUIRE_EQUAL(g.timestamp(), 0xCAFEFECA);
+	artdaq::Fragment h(g);
+	BOOST_REQUIRE_EQUAL(h.sequenceID(), 5);
+}
+
+BOOST_AUTO_TEST_CASE(ResizeOldVersions)
+{
+	// Resizing upgrades the header first, and the requested payload size is kept
+	auto make_old = [](int version) {
+		auto f = std::make_unique<artdaq::Fragment>(5);
+		if (version == 0)
+		{
+			artdaq::detail::RawFragmentHeaderV0 hdr0;
+			hdr0.word_count = f->size();
+			hdr0.version = 0;
+			hdr0.type = 0xFE;
+			hdr0.metadata_word_count = 0;
+			hdr0.sequence_id = 1;
+			hdr0.fragment_id = 2;
+			hdr0.timestamp = 3;
+			memcpy(f->headerBeginBytes(), &hdr0, sizeof(hdr0));
+		}
+		else
+		{
+			artdaq::detail::RawFragmentHeaderV1 hdr1;
+			hdr1.word_count = f->size();
+			hdr1.version = 1;
+			hdr1.type = 0xFE;
+			hdr1.metadata_word_count = 0;
+			hdr1.sequence_id = 1;
+			hdr1.fragment_id = 2;
+			hdr1.timestamp = 3;
+			memcpy(f->headerBeginBytes(), &hdr1, sizeof(hdr1));
+		}
+		return f;
+	};
+
+	for (int version = 0; version <= 1; ++version)
+	{
+		auto f = make_old(version);
+		f->resize(10);
+		BOOST_REQUIRE_EQUAL(f->version(), (artdaq::Fragment::version_t)artdaq::detail::RawFragmentHeader::CurrentVersion);
+		BOOST_REQUIRE_EQUAL(f->dataSize(), 10);
+		BOOST_REQUIRE_EQUAL(f->size(), artdaq::detail::RawFragmentHeader::num_words() + 10);
+
+		f = make_old(version);
+		f->resize(4, 0x1234);
+		BOOST_REQUIRE_EQUAL(f->dataSize(), 4);
+
+		f = make_old(version);
+		f->resizeBytes(80);
+		BOOST_REQUIRE_EQUAL(f->dataSizeBytes(), 80);
+		BOOST_REQUIRE_EQUAL(f->sequenceID(), 1);
+		BOOST_REQUIRE_EQUAL(f->timestamp(), 3);
+
+		f = make_old(version);
+		f->resizeBytesWithCushion(96);
+		BOOST_REQUIRE_EQUAL(f->dataSizeBytes(), 96);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(UpgradeAll)
+{
+	// Simulate a V1-format input file: many small Fragments with V1 headers
+	const size_t frag_count = 10000;
+	const size_t payload_words = 16;
+	artdaq::Fragments frags;
+	frags.reserve(frag_count);
+	for (size_t ii = 0; ii < frag_count; ++ii)
+	{
+		frags.emplace_back(payload_words);
+		artdaq::detail::RawFragmentHeaderV1 hdr1;
+		hdr1.word_count = artdaq::detail::RawFragmentHeader::num_words() + payload_words;
+		hdr1.version = 1;
+		hdr1.type = 1;
+		hdr1.metadata_word_count = 0;
+		hdr1.sequence_id = ii;
+		hdr1.fragment_id = ii % 16;
+		hdr1.timestamp = 2 * ii;
+		memcpy(frags.back().headerBeginBytes(), &hdr1, sizeof(hdr1));
+	}
+
+	auto lazy_start = std::chrono::steady_clock::now();
+	artdaq::Fragment::sequence_id_t lazy_sum = 0;
+	for (auto& frag : frags)
+	{
+		lazy_sum += frag.sequenceID() + frag.timestamp() + frag.dataSize();
+	}
+	auto lazy_time = artdaq::TimeUtils::GetElapsedTimeMicroseconds(lazy_start);
+
+	auto upgrade_start = std::chrono::steady_clock::now();
+	BOOST_REQUIRE_EQUAL(artdaq::upgradeAll(frags), frag_count);
+	auto upgrade_time = artdaq::TimeUtils::GetElapsedTimeMicroseconds(upgrade_start);
+	BOOST_REQUIRE_EQUAL(artdaq::upgradeAll(frags), 0);
+
+	auto current_start = std::chrono::steady_clock::now();
+	artdaq::Fragment::sequence_id_t current_sum = 0;
+	for (auto& frag : frags)
+	{
+		current_sum += frag.sequenceID() + frag.timestamp() + frag.dataSize();
+	}
+	auto current_time = artdaq::TimeUtils::GetElapsedTimeMicroseconds(current_start);
+
+	BOOST_REQUIRE_EQUAL(lazy_sum, current_sum);
+	BOOST_REQUIRE_EQUAL(frags.back().version(), (artdaq::Fragment::version_t)artdaq::detail::RawFragmentHeader::CurrentVersion);
+	TLOG(TLVL_INFO) << "UpgradeAll: " << frag_count << " V1 Fragments: per-access upgrade " << lazy_time
+	                << " us, upgradeAll " << upgrade_time << " us, access after upgrade " << current_time << " us";
+
+	artdaq::FragmentPtrs ptrs;
+	ptrs.emplace_back(new artdaq::Fragment(frags.front()));
+	BOOST_REQUIRE_EQUAL(artdaq::upgradeAll(ptrs), 0);
+}
+
+BOOST_AUTO_TEST_CASE(HeaderAccessTiming)
+{
+	// Compare header accessor cost for current-version Fragments and for V1 Fragments
+	// which are decoded on each access
+	const size_t frag_count = 20000;
+	artdaq::Fragments current, old;
+	current.reserve(frag_count);
+	old.reserve(frag_count);
+	for (size_t ii = 0; ii < frag_count; ++ii)
+	{
+		auto seq = (ii * 7919) % frag_count;
+		current.emplace_back(seq, ii % 16, 1, 3 * seq);
+
+		old.emplace_back(1);
+		artdaq::detail::RawFragmentHeaderV1 hdr1;
+		hdr1.word_count = artdaq::detail::RawFragmentHeader::num_words() + 1;
+		hdr1.version = 1;
+		hdr1.type = 1;
+		hdr1.metadata_word_count = 0;
+		hdr1.sequence_id = seq;
+		hdr1.fragment_id = ii % 16;
+		hdr1.timestamp = 3 * seq;
+		memcpy(old.back().headerBeginBytes(), &hdr1, sizeof(hdr1));
+	}
+
+	auto time_filter = [](artdaq::Fragments const& frags) {
+		auto start = std::chrono::steady_clock::now();
+		size_t selected = 0;
+		for (auto const& frag : frags)
+		{
+			if (frag.timestamp() >= 3000 && frag.timestamp() < 30000 && frag.type() == 1 && !frag.hasMetadata()) { ++selected; }
+		}
+		return std::make_pair(selected, artdaq::TimeUtils::GetElapsedTimeMicroseconds(start));
+	};
+	auto current_filter = time_filter(current);
+	auto old_filter = time_filter(old);
+	BOOST_REQUIRE_EQUAL(current_filter.first, old_filter.first);
+
+	auto start = std::chrono::steady_clock::now();
+	std::sort(current.begin(), current.end(), artdaq::FragmentSequenceIDLess());
+	auto current_sort = artdaq::TimeUtils::GetElapsedTimeMicroseconds(start);
+	start = std::chrono::steady_clock::now();
+	std::sort(old.begin(), old.end(), artdaq::FragmentSequenceIDLess());
+	auto old_sort = artdaq::TimeUtils::GetElapsedTimeMicroseconds(start);
+
+	for (size_t ii = 0; ii < frag_count; ++ii)
+	{
+		BOOST_REQUIRE_EQUAL(current[ii].sequenceID(), ii);
+		BOOST_REQUIRE_EQUAL(old[ii].sequenceID(), ii);
+	}
+	BOOST_REQUIRE(artdaq::fragmentSequenceIDCompare(current[0], current[1]));
+	BOOST_REQUIRE(!artdaq::fragmentSequenceIDCompare(old[1], old[0]));
+
+	TLOG(TLVL_INFO) << "HeaderAccessTiming: " << frag_count << " Fragments: filter current=" << current_filter.second << " us, V1=" << old_filter.second
+	                << " us; sort current=" << current_sort << " us, V1=" << old_sort << " us";
+}
+
 BOOST_AUTO_TEST_SUITE_END()
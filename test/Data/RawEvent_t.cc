@@ -1,5 +1,9 @@
 #include "artdaq-core/Data/Fragment.hh"
+#include "artdaq-core/Data/FragmentView.hh"
 #include "artdaq-core/Data/RawEvent.hh"
+#include "artdaq-core/Utilities/TimeUtils.hh"
+
+#include <sstream>
 
 #define BOOST_TEST_MODULE(RawEvent_t)
 #include <cetlib/quiet_unit_test.hpp>
@@ -63,4 +67,131 @@ BOOST_AUTO_TEST_CASE(InsertFragment)
 	                        [&](cet::exception e) { return e.category() == "LogicError"; });
 }
 
+BOOST_AUTO_TEST_CASE(ReleaseByType)
+{
+	artdaq::RawEvent r1(1, 2, 3, 4, 5);
+	const int types = 10, per_type = 3;
+	for (int ii = 0; ii < per_type; ++ii)
+	{
+		for (int tt = types; tt > 0; --tt)
+		{
+			std::unique_ptr<artdaq::Fragment> frag(new artdaq::Fragment(tt));
+			frag->setSequenceID(4);
+			frag->setFragmentID(ii * types + tt);
+			frag->setUserType(tt);
+			r1.insertFragment(std::move(frag));
+		}
+	}
+	BOOST_REQUIRE_EQUAL(r1.numFragments(), types * per_type);
+	size_t words = types * per_type * artdaq::detail::RawFragmentHeader::num_words();
+	for (int tt = 1; tt <= types; ++tt) words += tt * per_type;
+	BOOST_REQUIRE_EQUAL(r1.wordCount(), words);
+
+	// Types are reported in order of first appearance
+	std::vector<artdaq::Fragment::type_t> type_list{3};
+	r1.fragmentTypes(type_list);
+	BOOST_REQUIRE_EQUAL(type_list.size(), types);
+	BOOST_REQUIRE_EQUAL(type_list[0], 3);
+	BOOST_REQUIRE_EQUAL(type_list[1], types);
+	BOOST_REQUIRE_EQUAL(type_list.back(), 1);
+
+	auto product = r1.releaseProduct(5);
+	BOOST_REQUIRE_EQUAL(product->size(), per_type);
+	for (int ii = 0; ii < per_type; ++ii)
+	{
+		BOOST_REQUIRE_EQUAL((*product)[ii].type(), 5);
+		BOOST_REQUIRE_EQUAL((*product)[ii].fragmentID(), ii * types + 5);
+		BOOST_REQUIRE_EQUAL((*product)[ii].dataSize(), 5);
+	}
+	BOOST_REQUIRE_EQUAL(r1.numFragments(), (types - 1) * per_type);
+	BOOST_REQUIRE_EQUAL(r1.wordCount(), words - per_type * (5 + artdaq::detail::RawFragmentHeader::num_words()));
+	BOOST_REQUIRE(r1.releaseProduct(5)->empty());
+	BOOST_REQUIRE(r1.releaseProduct(artdaq::Fragment::FirstUserFragmentType + types)->empty());
+
+	type_list.clear();
+	r1.fragmentTypes(type_list);
+	BOOST_REQUIRE_EQUAL(type_list.size(), types - 1);
+	BOOST_REQUIRE(std::find(type_list.begin(), type_list.end(), 5) == type_list.end());
+	std::ostringstream oss;
+	oss << r1;
+	BOOST_REQUIRE(oss.str().find("FragCount " + std::to_string((types - 1) * per_type)) != std::string::npos);
+
+	// The remaining Fragments are released in insertion order
+	auto rest = r1.releaseProduct();
+	BOOST_REQUIRE_EQUAL(rest->size(), (types - 1) * per_type);
+	BOOST_REQUIRE_EQUAL(rest->front().type(), types);
+	BOOST_REQUIRE_EQUAL(rest->back().type(), 1);
+	BOOST_REQUIRE_EQUAL(rest->back().fragmentID(), (per_type - 1) * types + 1);
+	BOOST_REQUIRE_EQUAL(r1.numFragments(), 0);
+	BOOST_REQUIRE_EQUAL(r1.wordCount(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(SplitPerformance)
+{
+	const int types = 200, fragments = 20000;
+	artdaq::RawEvent r1(1, 2, 3, 4, 5);
+	r1.reserveFragments(fragments);
+	for (int ii = 0; ii < fragments; ++ii)
+	{
+		artdaq::Fragment frag(4, ii % 1000, 1 + ii % types);
+		r1.insertFragment(std::move(frag));
+	}
+
+	auto start_time = std::chrono::steady_clock::now();
+	std::vector<artdaq::Fragment::type_t> type_list;
+	r1.fragmentTypes(type_list);
+	size_t released = 0;
+	for (auto type : type_list)
+	{
+		released += r1.releaseProduct(type)->size();
+	}
+	TLOG(TLVL_INFO) << "Splitting a RawEvent with " << fragments << " Fragments into " << types << " products took " << artdaq::TimeUtils::GetElapsedTimeMicroseconds(start_time) << " us";
+	BOOST_REQUIRE_EQUAL(type_list.size(), types);
+	BOOST_REQUIRE_EQUAL(released, fragments);
+	BOOST_REQUIRE_EQUAL(r1.numFragments(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(Serialize)
+{
+	artdaq::RawEvent r1(1, 2, 3, 4, 5);
+	for (int ii = 0; ii < 6; ++ii)
+	{
+		artdaq::Fragment frag(ii + 1);
+		frag.setSequenceID(4);
+		frag.setFragmentID(ii);
+		frag.setUserType(artdaq::Fragment::FirstUserFragmentType + ii % 2);
+		std::fill(frag.dataBegin(), frag.dataEnd(), ii);
+		r1.insertFragment(std::move(frag));
+	}
+	r1.markComplete();
+	r1.releaseProduct(artdaq::Fragment::FirstUserFragmentType + 1);  // Fragments 1, 3 and 5
+
+	BOOST_REQUIRE_EQUAL(r1.serializedSize(), sizeof(artdaq::detail::RawEventHeader) + r1.wordCount() * sizeof(artdaq::RawDataType));
+	auto pieces = r1.scatterList();
+	BOOST_REQUIRE_EQUAL(pieces.size(), 4);
+	size_t piece_bytes = 0;
+	for (auto const& piece : pieces) piece_bytes += piece.iov_len;
+	BOOST_REQUIRE_EQUAL(piece_bytes, r1.serializedSize());
+
+	std::vector<artdaq::RawDataType> buffer(r1.serializedSize() / sizeof(artdaq::RawDataType));
+	BOOST_REQUIRE_EXCEPTION(r1.serializeTo(buffer.data(), r1.serializedSize() - 1), cet::exception, [](cet::exception const& e) { return e.category() == "ArgumentOutOfRange"; });
+	BOOST_REQUIRE_EQUAL(r1.serializeTo(buffer.data(), buffer.size() * sizeof(artdaq::RawDataType)), r1.serializedSize());
+
+	auto hdr = reinterpret_cast<artdaq::detail::RawEventHeader const*>(buffer.data());
+	BOOST_REQUIRE_EQUAL(hdr->run_id, 1);
+	BOOST_REQUIRE_EQUAL(hdr->sequence_id, 4);
+	BOOST_REQUIRE_EQUAL(hdr->is_complete, true);
+
+	auto it = artdaq::FragmentViewIterator(buffer.data() + sizeof(artdaq::detail::RawEventHeader) / sizeof(artdaq::RawDataType));
+	for (int ii = 0; ii < 6; ii += 2, ++it)
+	{
+		auto view = *it;
+		BOOST_REQUIRE_EQUAL(view.fragmentID(), ii);
+		BOOST_REQUIRE_EQUAL(view.type(), artdaq::Fragment::FirstUserFragmentType);
+		BOOST_REQUIRE_EQUAL(view.dataSize(), ii + 1);
+		BOOST_REQUIRE_EQUAL(*view.dataBegin(), ii);
+	}
+	BOOST_REQUIRE(it == artdaq::FragmentViewIterator(buffer.data() + buffer.size()));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
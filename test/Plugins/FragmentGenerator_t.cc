@@ -4,6 +4,8 @@
 #include "artdaq-core/Data/Fragment.hh"
 #include "artdaq-core/Plugins/FragmentGenerator.hh"
 
+#include <type_traits>
+
 namespace artdaqtest {
 class FragmentGeneratorTest;
 }
@@ -45,6 +47,42 @@ artdaqtest::FragmentGeneratorTest::
 	return {1};
 }
 
+/**
+ * \brief Tests a FragmentGenerator which only implements getNextBatch
+ */
+class FragmentBatchGeneratorTest : public artdaq::FragmentBatchGenerator
+{
+public:
+	bool getNextBatch(artdaq::FragmentBatch& output) override
+	{
+		for (artdaq::Fragment::fragment_id_t id = 0; id < 3; ++id)
+		{
+			output.append(1, ++sequence_id_, id, artdaq::Fragment::FirstUserFragmentType)[0] = id;
+		}
+		return true;
+	}
+
+	std::vector<artdaq::Fragment::fragment_id_t> fragmentIDs() override
+	{
+		return {0, 1, 2};
+	}
+
+private:
+	artdaq::Fragment::sequence_id_t sequence_id_{0};
+};
+
+/**
+ * \brief A FragmentGenerator which implements neither getNext nor getNextBatch, and so cannot be instantiated
+ */
+class IncompleteGeneratorTest : public artdaq::FragmentGenerator
+{
+public:
+	std::vector<artdaq::Fragment::fragment_id_t> fragmentIDs() override
+	{
+		return {};
+	}
+};
+
 BOOST_AUTO_TEST_SUITE(FragmentGenerator_t)
 
 BOOST_AUTO_TEST_CASE(Simple)
@@ -64,4 +102,49 @@ BOOST_AUTO_TEST_CASE(FragmentIDs)
 	BOOST_REQUIRE_EQUAL(ids.size(), 1);
 	BOOST_REQUIRE_EQUAL(ids[0], 1);
 }
+
+BOOST_AUTO_TEST_CASE(BatchAdapter)
+{
+	artdaqtest::FragmentGeneratorTest testGen;
+	artdaq::FragmentGenerator& baseGen(testGen);
+	artdaq::FragmentBatch batch;
+	BOOST_REQUIRE(baseGen.getNextBatch(batch));
+	BOOST_REQUIRE_EQUAL(batch.size(), 1u);
+	BOOST_REQUIRE_EQUAL(batch[0].type(), artdaq::Fragment::InvalidFragmentType);
+}
+
+BOOST_AUTO_TEST_CASE(FragmentPtrsAdapter)
+{
+	FragmentBatchGeneratorTest testGen;
+	artdaq::FragmentGenerator& baseGen(testGen);
+
+	artdaq::FragmentBatch batch;
+	BOOST_REQUIRE(baseGen.getNextBatch(batch));
+	BOOST_REQUIRE_EQUAL(batch.size(), 3u);
+
+	artdaq::FragmentPtrs fps;
+	BOOST_REQUIRE(baseGen.getNext(fps));
+	BOOST_REQUIRE_EQUAL(fps.size(), 3u);
+	artdaq::RawDataType id = 0;
+	for (auto& frag : fps)
+	{
+		BOOST_REQUIRE_EQUAL(frag->fragmentID(), id);
+		BOOST_REQUIRE_EQUAL(frag->dataSize(), 1u);
+		BOOST_REQUIRE_EQUAL(*frag->dataBegin(), id);
+		++id;
+	}
+
+	// The adapter's internal batch is recycled, not accumulated
+	fps.clear();
+	BOOST_REQUIRE(baseGen.getNext(fps));
+	BOOST_REQUIRE_EQUAL(fps.size(), 3u);
+}
+
+BOOST_AUTO_TEST_CASE(NoImplementation)
+{
+	static_assert(std::is_abstract<IncompleteGeneratorTest>::value, "A FragmentGenerator without getNext must not be instantiable");
+	static_assert(!std::is_abstract<artdaqtest::FragmentGeneratorTest>::value, "A FragmentGenerator with getNext must be instantiable");
+	static_assert(!std::is_abstract<FragmentBatchGeneratorTest>::value, "A FragmentBatchGenerator with getNextBatch must be instantiable");
+	BOOST_REQUIRE(true);
+}
 BOOST_AUTO_TEST_SUITE_END()
@@ -4,6 +4,22 @@
 #define BOOST_TEST_MODULE(FragmentNameHelper_t)
 #include <cetlib/quiet_unit_test.hpp>
 
+namespace {
+/// Helper which edits type_map_ directly, as derived FragmentNameHelpers may
+class RenamingNameHelper : public artdaq::FragmentNameHelper
+{
+public:
+	RenamingNameHelper()
+	    : artdaq::FragmentNameHelper("testunidentified", {}) {}
+
+	void Rename(artdaq::Fragment::type_t type_id, std::string const& type_name)
+	{
+		type_map_[type_id] = type_name;
+		UpdateNameTable_();
+	}
+};
+}  // namespace
+
 BOOST_AUTO_TEST_SUITE(FragmentNameHelper_test)
 
 BOOST_AUTO_TEST_CASE(FNH_Construct)
@@ -103,6 +119,69 @@ BOOST_AUTO_TEST_CASE(FNH_DecodeContainerFragment)
 	auto res = helper->GetInstanceNameForFragment(frag);
 	BOOST_REQUIRE_EQUAL(res.first, true);
 	BOOST_REQUIRE_EQUAL(res.second, "ContainerData");
+
+	// Contained types without a mapping only get the container name
+	artdaq::Fragment userFrag;
+	artdaq::ContainerFragmentLoader userCfl(userFrag, artdaq::Fragment::FirstUserFragmentType);
+	res = helper->GetInstanceNameForFragment(userFrag);
+	BOOST_REQUIRE_EQUAL(res.first, true);
+	BOOST_REQUIRE_EQUAL(res.second, "Container");
+
+	helper->AddExtraType(artdaq::Fragment::FirstUserFragmentType, "Test");
+	res = helper->GetInstanceNameForFragment(userFrag);
+	BOOST_REQUIRE_EQUAL(res.first, true);
+	BOOST_REQUIRE_EQUAL(res.second, "ContainerTest");
+}
+
+BOOST_AUTO_TEST_CASE(FNH_LookupInstanceName)
+{
+	auto extraType = std::make_pair(artdaq::Fragment::FirstUserFragmentType, "Test");
+	auto helper = artdaq::makeNameHelper("Artdaq", "testunidentified", {extraType});
+
+	auto res = helper->LookupInstanceName(artdaq::Fragment::FirstUserFragmentType);
+	BOOST_REQUIRE_EQUAL(res.first, true);
+	BOOST_REQUIRE_EQUAL(res.second, "Test");
+
+	res = helper->LookupInstanceName(artdaq::Fragment::FirstUserFragmentType + 1);
+	BOOST_REQUIRE_EQUAL(res.first, false);
+	BOOST_REQUIRE_EQUAL(res.second, "testunidentified");
+
+	res = helper->LookupInstanceName(artdaq::Fragment::ContainerFragmentType, artdaq::Fragment::FirstUserFragmentType);
+	BOOST_REQUIRE_EQUAL(res.first, true);
+	BOOST_REQUIRE_EQUAL(res.second, "ContainerTest");
+
+	// Every name returned by a lookup is one of the product instance names
+	auto names = helper->GetAllProductInstanceNames();
+	BOOST_REQUIRE_EQUAL(names.count("testunidentified"), 0);
+	for (int type = 0; type < 256; ++type)
+	{
+		for (int contained_type = 0; contained_type < 256; ++contained_type)
+		{
+			res = helper->LookupInstanceName(type, contained_type);
+			if (res.first) BOOST_REQUIRE_EQUAL(names.count(std::string(res.second)), 1);
+		}
+	}
+	BOOST_REQUIRE_EQUAL(names.count("Test"), 1);
+	BOOST_REQUIRE_EQUAL(names.count("ContainerTest"), 1);
+	BOOST_REQUIRE_EQUAL(names.count("ContainerContainer"), 1);
+}
+
+BOOST_AUTO_TEST_CASE(FNH_DerivedTypeMap)
+{
+	RenamingNameHelper helper;
+	helper.Rename(artdaq::Fragment::DataFragmentType, "Renamed");
+	helper.Rename(artdaq::Fragment::FirstUserFragmentType, "Test");
+
+	BOOST_REQUIRE_EQUAL(helper.GetInstanceNameForType(artdaq::Fragment::DataFragmentType), "Renamed");
+	BOOST_REQUIRE_EQUAL(helper.LookupInstanceName(artdaq::Fragment::FirstUserFragmentType).second, "Test");
+	BOOST_REQUIRE_EQUAL(helper.LookupInstanceName(artdaq::Fragment::ContainerFragmentType, artdaq::Fragment::DataFragmentType).second, "ContainerRenamed");
+
+	artdaq::Fragment frag(1, 2, artdaq::Fragment::DataFragmentType, 3);
+	BOOST_REQUIRE_EQUAL(helper.GetInstanceNameForFragment(frag).second, "Renamed");
+
+	auto names = helper.GetAllProductInstanceNames();
+	BOOST_REQUIRE_EQUAL(names.count("Renamed"), 1);
+	BOOST_REQUIRE_EQUAL(names.count("Data"), 0);
 }
 
 BOOST_AUTO_TEST_SUITE_END()
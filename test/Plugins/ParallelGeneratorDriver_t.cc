@@ -0,0 +1,157 @@
+#define BOOST_TEST_MODULE (ParallelGeneratorDriver_t)
+#include <cetlib/quiet_unit_test.hpp>
+
+#include "artdaq-core/Data/Fragment.hh"
+#include "artdaq-core/Plugins/ParallelGeneratorDriver.hh"
+
+#include <map>
+#include <set>
+
+namespace artdaqtest {
+/**
+ * \brief A FragmentGenerator with several streams, each of which produces a fixed number of Fragments
+ */
+class MultiStreamGeneratorTest : public artdaq::FragmentGenerator
+{
+public:
+	MultiStreamGeneratorTest(size_t streams, size_t fragments_per_stream, bool throw_on_last = false)
+	    : streams_(streams)
+	    , fragments_per_stream_(fragments_per_stream)
+	    , throw_on_last_(throw_on_last)
+	    , sequence_ids_(streams, 0)
+	{}
+
+	bool getNext(artdaq::FragmentPtrs& output) override
+	{
+		return getNextFromStream(0, output);
+	}
+
+	size_t numStreams() override { return streams_; }
+
+	bool getNextFromStream(size_t stream, artdaq::FragmentPtrs& output) override
+	{
+		auto& sequence_id = sequence_ids_.at(stream);
+		for (size_t ii = 0; ii < 3 && sequence_id < fragments_per_stream_; ++ii)
+		{
+			++sequence_id;
+			if (throw_on_last_ && sequence_id == fragments_per_stream_)
+			{
+				throw cet::exception("MultiStreamGeneratorTest") << "Stream " << stream << " failed";
+			}
+			output.emplace_back(new artdaq::Fragment(sequence_id, stream, artdaq::Fragment::FirstUserFragmentType));
+		}
+		return sequence_id < fragments_per_stream_;
+	}
+
+	std::vector<artdaq::Fragment::fragment_id_t> fragmentIDs() override
+	{
+		std::vector<artdaq::Fragment::fragment_id_t> output;
+		for (size_t ii = 0; ii < streams_; ++ii)
+		{
+			output.push_back(ii);
+		}
+		return output;
+	}
+
+private:
+	size_t streams_;
+	size_t fragments_per_stream_;
+	bool throw_on_last_;
+	std::vector<artdaq::Fragment::sequence_id_t> sequence_ids_;
+};
+}  // namespace artdaqtest
+
+BOOST_AUTO_TEST_SUITE(ParallelGeneratorDriver_t)
+
+BOOST_AUTO_TEST_CASE(SPSCQueue)
+{
+	artdaq::detail::SPSCQueue<int> queue(3);
+	BOOST_REQUIRE_EQUAL(queue.capacity(), 4u);
+	BOOST_REQUIRE(queue.empty());
+
+	for (int ii = 0; ii < 4; ++ii)
+	{
+		BOOST_REQUIRE(queue.push(std::move(ii)));
+	}
+	int value = 42;
+	BOOST_REQUIRE(!queue.push(std::move(value)));
+
+	for (int ii = 0; ii < 4; ++ii)
+	{
+		BOOST_REQUIRE(queue.pop(value));
+		BOOST_REQUIRE_EQUAL(value, ii);
+	}
+	BOOST_REQUIRE(!queue.pop(value));
+	BOOST_REQUIRE(queue.empty());
+}
+
+BOOST_AUTO_TEST_CASE(SingleStreamDefault)
+{
+	artdaqtest::MultiStreamGeneratorTest gen(1, 5);
+	artdaq::FragmentGenerator& baseGen(gen);
+	BOOST_REQUIRE_EQUAL(baseGen.numStreams(), 1u);
+
+	artdaq::FragmentPtrs frags;
+	BOOST_REQUIRE(baseGen.getNextFromStream(0, frags));
+	BOOST_REQUIRE_EQUAL(frags.size(), 3u);
+	BOOST_REQUIRE_THROW(baseGen.getNextFromStream(1, frags), std::exception);
+}
+
+BOOST_AUTO_TEST_CASE(MergesAllStreams)
+{
+	const size_t streams = 7;
+	const size_t per_stream = 1000;
+	artdaq::ParallelGeneratorDriver driver(std::make_unique<artdaqtest::MultiStreamGeneratorTest>(streams, per_stream), 3, 16);
+	BOOST_REQUIRE_EQUAL(driver.threadCount(), 3u);
+	BOOST_REQUIRE_EQUAL(driver.fragmentIDs().size(), streams);
+
+	std::map<artdaq::Fragment::fragment_id_t, artdaq::Fragment::sequence_id_t> last_sequence_ids;
+	size_t count = 0;
+	artdaq::FragmentPtrs frags;
+	while (driver.getNext(frags))
+	{
+		for (auto& frag : frags)
+		{
+			// Fragments from each stream arrive in order
+			auto& last = last_sequence_ids[frag->fragmentID()];
+			BOOST_REQUIRE_EQUAL(frag->sequenceID(), last + 1);
+			last = frag->sequenceID();
+			++count;
+		}
+		frags.clear();
+	}
+
+	BOOST_REQUIRE_EQUAL(count, streams * per_stream);
+	BOOST_REQUIRE_EQUAL(last_sequence_ids.size(), streams);
+	for (auto& last : last_sequence_ids)
+	{
+		BOOST_REQUIRE_EQUAL(last.second, per_stream);
+	}
+	BOOST_REQUIRE(!driver.getNext(frags));
+}
+
+BOOST_AUTO_TEST_CASE(DefaultThreadCount)
+{
+	artdaq::ParallelGeneratorDriver driver(std::make_unique<artdaqtest::MultiStreamGeneratorTest>(2, 10));
+	BOOST_REQUIRE(driver.threadCount() >= 1u);
+	BOOST_REQUIRE(driver.threadCount() <= 2u);
+}
+
+BOOST_AUTO_TEST_CASE(PropagatesExceptions)
+{
+	artdaq::ParallelGeneratorDriver driver(std::make_unique<artdaqtest::MultiStreamGeneratorTest>(2, 10, true), 2);
+	artdaq::FragmentPtrs frags;
+	BOOST_REQUIRE_THROW(while (driver.getNext(frags)) {}, cet::exception);
+}
+
+BOOST_AUTO_TEST_CASE(Stop)
+{
+	artdaq::ParallelGeneratorDriver driver(std::make_unique<artdaqtest::MultiStreamGeneratorTest>(4, 1000000), 2, 8);
+	artdaq::FragmentPtrs frags;
+	BOOST_REQUIRE(driver.getNext(frags));
+	driver.stop();
+	frags.clear();
+	BOOST_REQUIRE(!driver.getNext(frags));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
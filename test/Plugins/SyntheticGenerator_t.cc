@@ -0,0 +1,204 @@
+#define BOOST_TEST_MODULE (SyntheticGenerator_t)
+#include <cetlib/quiet_unit_test.hpp>
+
+#include "artdaq-core/Data/ContainerFragment.hh"
+#include "artdaq-core/Data/Fragment.hh"
+#include "artdaq-core/Plugins/ParallelGeneratorDriver.hh"
+#include "artdaq-core/Plugins/makeFragmentGenerator.hh"
+
+#include "fhiclcpp/ParameterSet.h"
+#include "fhiclcpp/make_ParameterSet.h"
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+
+namespace {
+std::unique_ptr<artdaq::FragmentGenerator> makeSynthetic(std::string const& config)
+{
+	return artdaq::makeFragmentGenerator("Synthetic", fhicl::ParameterSet::make(config));
+}
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(SyntheticGenerator_t)
+
+BOOST_AUTO_TEST_CASE(FixedSize)
+{
+	auto gen = makeSynthetic("fragment_id_count: 3 first_fragment_id: 10 payload_size_bytes: 100 max_events: 2");
+	BOOST_REQUIRE_EQUAL(gen->fragmentIDs().size(), 3u);
+	BOOST_REQUIRE_EQUAL(gen->fragmentIDs()[0], 10);
+
+	artdaq::FragmentPtrs frags;
+	BOOST_REQUIRE(gen->getNext(frags));
+	BOOST_REQUIRE_EQUAL(frags.size(), 3u);
+	artdaq::Fragment::fragment_id_t id = 10;
+	for (auto& frag : frags)
+	{
+		BOOST_REQUIRE_EQUAL(frag->sequenceID(), 1u);
+		BOOST_REQUIRE_EQUAL(frag->fragmentID(), id++);
+		BOOST_REQUIRE_EQUAL(frag->type(), artdaq::Fragment::FirstUserFragmentType);
+		BOOST_REQUIRE_EQUAL(frag->timestamp(), 1u);
+		BOOST_REQUIRE_EQUAL(frag->dataSizeBytes(), 104u);  // Rounded up to whole words
+
+		// Default "counter" pattern
+		BOOST_REQUIRE_EQUAL(frag->dataBegin()[0], 1u);
+		BOOST_REQUIRE_EQUAL(frag->dataBegin()[12], 13u);
+	}
+
+	frags.clear();
+	BOOST_REQUIRE(!gen->getNext(frags));
+	BOOST_REQUIRE_EQUAL(frags.size(), 3u);
+	BOOST_REQUIRE_EQUAL(frags.front()->sequenceID(), 2u);
+
+	frags.clear();
+	BOOST_REQUIRE(!gen->getNext(frags));
+	BOOST_REQUIRE_EQUAL(frags.size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(SizeDistributions)
+{
+	auto gen = makeSynthetic("size_distribution: uniform payload_size_min_bytes: 80 payload_size_max_bytes: 800 payload_pattern: random events_per_call: 1000");
+	artdaq::FragmentPtrs frags;
+	BOOST_REQUIRE(gen->getNext(frags));
+	BOOST_REQUIRE_EQUAL(frags.size(), 1000u);
+	size_t smallest = 1000, largest = 0;
+	for (auto& frag : frags)
+	{
+		smallest = std::min(smallest, frag->dataSizeBytes());
+		largest = std::max(largest, frag->dataSizeBytes());
+	}
+	BOOST_REQUIRE(smallest >= 80u);
+	BOOST_REQUIRE(largest <= 800u);
+	BOOST_REQUIRE(largest > smallest);
+
+	gen = makeSynthetic("size_distribution: exponential payload_size_bytes: 800 payload_size_max_bytes: 4000 events_per_call: 1000");
+	frags.clear();
+	BOOST_REQUIRE(gen->getNext(frags));
+	size_t total = 0;
+	for (auto& frag : frags)
+	{
+		BOOST_REQUIRE(frag->dataSizeBytes() <= 4000u);
+		total += frag->dataSizeBytes();
+	}
+	BOOST_REQUIRE(total / frags.size() > 600u);
+	BOOST_REQUIRE(total / frags.size() < 1000u);
+
+	BOOST_REQUIRE_THROW(makeSynthetic("size_distribution: gaussian"), cet::exception);
+	BOOST_REQUIRE_THROW(makeSynthetic("payload_pattern: stripes"), cet::exception);
+	BOOST_REQUIRE_THROW(makeSynthetic("fragment_type: 232"), cet::exception);
+	BOOST_REQUIRE_THROW(makeSynthetic("fragment_id_count: 2 streams: 3"), cet::exception);
+}
+
+BOOST_AUTO_TEST_CASE(Containers)
+{
+	auto gen = makeSynthetic("fragment_id_count: 2 payload_size_bytes: 64 fragments_per_container: 5 max_events: 1");
+	artdaq::FragmentBatch batch;
+	BOOST_REQUIRE(!gen->getNextBatch(batch));
+	BOOST_REQUIRE_EQUAL(batch.size(), 2u);
+
+	artdaq::FragmentPtrs frags;
+	batch.toFragments(frags);
+	for (auto& frag : frags)
+	{
+		BOOST_REQUIRE_EQUAL(frag->type(), artdaq::Fragment::ContainerFragmentType);
+		artdaq::ContainerFragment cf(*frag);
+		BOOST_REQUIRE_EQUAL(cf.block_count(), 5u);
+		BOOST_REQUIRE_EQUAL(cf.fragment_type(), artdaq::Fragment::FirstUserFragmentType);
+		auto inner = cf.at(4);
+		BOOST_REQUIRE_EQUAL(inner->fragmentID(), frag->fragmentID());
+		BOOST_REQUIRE_EQUAL(inner->sequenceID(), 1u);
+		BOOST_REQUIRE_EQUAL(inner->dataSizeBytes(), 64u);
+		BOOST_REQUIRE_EQUAL(inner->dataBegin()[7], 8u);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(BatchMatchesFragments)
+{
+	// getNext and getNextBatch generate the same Fragments from the same configuration
+	for (std::string config : {"size_distribution: uniform payload_size_min_bytes: 8 payload_size_max_bytes: 800 payload_pattern: random",
+	                           "size_distribution: exponential payload_size_bytes: 100 fragments_per_container: 3"})
+	{
+		config += " fragment_id_count: 6 streams: 3 events_per_call: 4 max_events: 10";
+		auto gen = makeSynthetic(config);
+		auto batch_gen = makeSynthetic(config);
+
+		artdaq::FragmentPtrs frags;
+		artdaq::FragmentBatch batch;
+		bool more = true;
+		while (more)
+		{
+			more = gen->getNext(frags);
+			BOOST_REQUIRE_EQUAL(batch_gen->getNextBatch(batch), more);
+		}
+		BOOST_REQUIRE_EQUAL(frags.size(), 60u);
+
+		artdaq::FragmentPtrs batch_frags;
+		batch.toFragments(batch_frags);
+		BOOST_REQUIRE_EQUAL(batch_frags.size(), frags.size());
+		auto batch_frag = batch_frags.begin();
+		for (auto& frag : frags)
+		{
+			BOOST_REQUIRE_EQUAL(frag->sequenceID(), (*batch_frag)->sequenceID());
+			BOOST_REQUIRE_EQUAL(frag->fragmentID(), (*batch_frag)->fragmentID());
+			BOOST_REQUIRE_EQUAL(frag->type(), (*batch_frag)->type());
+			BOOST_REQUIRE_EQUAL(frag->timestamp(), (*batch_frag)->timestamp());
+			BOOST_REQUIRE_EQUAL(frag->dataSizeBytes(), (*batch_frag)->dataSizeBytes());
+			if (frag->type() == artdaq::Fragment::ContainerFragmentType)
+			{
+				// Compare the contained Fragments' payloads, as their headers hold the time they were made
+				artdaq::ContainerFragment cf(*frag), batch_cf(**batch_frag);
+				BOOST_REQUIRE_EQUAL(cf.block_count(), batch_cf.block_count());
+				BOOST_REQUIRE_EQUAL(cf.metadata()->index_offset, batch_cf.metadata()->index_offset);
+				BOOST_REQUIRE(batch_cf.validateIndex());
+				for (size_t ii = 0; ii < cf.block_count(); ++ii)
+				{
+					auto inner = cf.at(ii), batch_inner = batch_cf.at(ii);
+					BOOST_REQUIRE_EQUAL(inner->dataSizeBytes(), batch_inner->dataSizeBytes());
+					BOOST_REQUIRE(std::equal(inner->dataBegin(), inner->dataEnd(), batch_inner->dataBegin()));
+				}
+			}
+			else
+			{
+				BOOST_REQUIRE(std::equal(frag->dataBegin(), frag->dataEnd(), (*batch_frag)->dataBegin()));
+			}
+			++batch_frag;
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(Streams)
+{
+	const size_t events = 200;
+	auto gen = makeSynthetic("fragment_id_count: 8 streams: 4 payload_pattern: zero max_events: " + std::to_string(events));
+	BOOST_REQUIRE_EQUAL(gen->numStreams(), 4u);
+
+	artdaq::ParallelGeneratorDriver driver(std::move(gen), 2);
+	std::map<artdaq::Fragment::fragment_id_t, size_t> counts;
+	artdaq::FragmentPtrs frags;
+	while (driver.getNext(frags))
+	{
+		for (auto& frag : frags)
+		{
+			++counts[frag->fragmentID()];
+		}
+		frags.clear();
+	}
+	BOOST_REQUIRE_EQUAL(counts.size(), 8u);
+	for (auto& count : counts)
+	{
+		BOOST_REQUIRE_EQUAL(count.second, events);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(Rate)
+{
+	auto gen = makeSynthetic("rate_hz: 1000 max_events: 50");
+	auto start = std::chrono::steady_clock::now();
+	artdaq::FragmentPtrs frags;
+	while (gen->getNext(frags)) {}
+	auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	BOOST_REQUIRE_EQUAL(frags.size(), 50u);
+	BOOST_REQUIRE(elapsed >= 0.045);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -2,6 +2,8 @@
 
 #define BOOST_TEST_MODULE TimeUtils_t
 #include <cmath>
+#include <thread>
+#include <vector>
 #include "cetlib/quiet_unit_test.hpp"
 
 #define TRACE_NAME "TimeUtils_t"
@@ -74,4 +76,82 @@ BOOST_AUTO_TEST_CASE(GetTimeOfDayUS)
 	BOOST_REQUIRE_EQUAL(now / 1000000, ts.tv_sec);
 }
 
+BOOST_AUTO_TEST_CASE(AccessTimeClock)
+{
+	using artdaq::TimeUtils::AccessTimeClock;
+
+	for (auto clock : {AccessTimeClock::Realtime, AccessTimeClock::Coarse, AccessTimeClock::TSC})
+	{
+		artdaq::TimeUtils::setAccessTimeClock(clock);
+		auto selected = artdaq::TimeUtils::getAccessTimeClock();
+		// TSC may fall back to Realtime on machines without an invariant TSC
+		BOOST_REQUIRE(selected == clock || (clock == AccessTimeClock::TSC && selected == AccessTimeClock::Realtime));
+
+		auto ref = artdaq::TimeUtils::get_realtime_clock();
+		auto ts = artdaq::TimeUtils::get_access_time();
+		auto diff = std::fabs(artdaq::TimeUtils::convertUnixTimeToSeconds(ts) - artdaq::TimeUtils::convertUnixTimeToSeconds(ref));
+		BOOST_REQUIRE_LT(diff, 0.1);
+
+		auto start = std::chrono::steady_clock::now();
+		for (int ii = 0; ii < 1000000; ++ii)
+		{
+			artdaq::TimeUtils::get_access_time();
+		}
+		auto dur = artdaq::TimeUtils::GetElapsedTime(start);
+		TLOG(TLVL_INFO) << "Time to call get_access_time 1000000 times with clock " << static_cast<int>(selected) << ": " << dur << " s ( ave: " << dur / 1000000 << " s/call ).";
+	}
+
+	artdaq::TimeUtils::setAccessTimeClock(AccessTimeClock::Disabled);
+	BOOST_REQUIRE(artdaq::TimeUtils::getAccessTimeClock() == AccessTimeClock::Disabled);
+	auto ts = artdaq::TimeUtils::get_access_time();
+	BOOST_REQUIRE_EQUAL(ts.tv_sec, 0);
+	BOOST_REQUIRE_EQUAL(ts.tv_nsec, 0);
+
+	artdaq::TimeUtils::setAccessTimeClock(AccessTimeClock::Realtime);
+}
+
+BOOST_AUTO_TEST_CASE(TSCCalibration)
+{
+	using artdaq::TimeUtils::AccessTimeClock;
+
+	// Concurrent first use calibrates once, and every thread sees the same calibration
+	std::vector<artdaq::TimeUtils::TSCCalibration const*> calibrations(4, nullptr);
+	std::vector<std::thread> threads;
+	for (size_t ii = 0; ii < calibrations.size(); ++ii)
+	{
+		threads.emplace_back([&calibrations, ii] { calibrations[ii] = artdaq::TimeUtils::calibrate_tsc(); });
+	}
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+	auto calibration = artdaq::TimeUtils::get_tsc_calibration();
+	for (auto other : calibrations)
+	{
+		BOOST_REQUIRE_EQUAL(other, calibration);
+	}
+	if (calibration == nullptr)
+	{
+		TLOG(TLVL_INFO) << "No invariant TSC on this machine, skipping TSC checks";
+		return;
+	}
+	BOOST_REQUIRE_GT(calibration->ns_per_tick, 0.0);
+
+	// Selecting TSC again reuses the existing calibration
+	artdaq::TimeUtils::setAccessTimeClock(AccessTimeClock::TSC);
+	BOOST_REQUIRE(artdaq::TimeUtils::getAccessTimeClock() == AccessTimeClock::TSC);
+	BOOST_REQUIRE_EQUAL(artdaq::TimeUtils::calibrate_tsc(), calibration);
+
+	// After the re-anchor interval, the next access time publishes a new anchor which tracks CLOCK_REALTIME
+	std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+	auto ts = artdaq::TimeUtils::get_access_time();
+	auto ref = artdaq::TimeUtils::get_realtime_clock();
+	auto reanchored = artdaq::TimeUtils::get_tsc_calibration();
+	BOOST_REQUIRE_NE(reanchored, calibration);
+	BOOST_REQUIRE_GE(reanchored->base_ticks, calibration->base_ticks);
+	BOOST_REQUIRE_LT(std::fabs(artdaq::TimeUtils::convertUnixTimeToSeconds(ts) - artdaq::TimeUtils::convertUnixTimeToSeconds(ref)), 0.001);
+
+	artdaq::TimeUtils::setAccessTimeClock(AccessTimeClock::Realtime);
+}
+
 BOOST_AUTO_TEST_SUITE_END()